@@ -0,0 +1,120 @@
+#include "bandwidth_limiter.h"
+#include "logger.h"
+#include "settings.h"
+
+#include <algorithm>
+
+namespace global { std::unique_ptr<BandwidthLimiter> bandwidth_limiter = std::make_unique<BandwidthLimiter>(); }
+
+#define LOG(message, log_level) do { if (Logger::is_enabled(log_level)) global::logger->write(message, log_level, LogSource::BandwidthLimiter); } while (0)
+#define LOG_FORMAT(log_level, ...) global::logger->write_format(log_level, LogSource::BandwidthLimiter, __VA_ARGS__)
+
+void BandwidthLimiter::set_in_combat(bool in_combat)
+{
+	if (this->in_combat.exchange(in_combat) == in_combat)
+		return;
+
+	if (GET_SETTING(bandwidth.limit_uploads))
+	{
+		const auto rate_limit = this->get_rate_limit();
+
+		if (rate_limit)
+			LOG_FORMAT(LogLevel::Debug, "{} combat, upload limit set to {} KiB/s", in_combat ? "Entered" : "Left", rate_limit / 1024);
+		else
+			LOG_FORMAT(LogLevel::Debug, "{} combat, upload limit set to unlimited", in_combat ? "Entered" : "Left");
+	}
+}
+
+void BandwidthLimiter::consume(uint64_t bytes)
+{
+	const auto rate_limit = this->get_rate_limit();
+	const auto now = Clock::now();
+
+	std::lock_guard lock(this->mutex);
+
+	if (now - this->window_start > std::chrono::seconds(2)) // idle, start a new measurement window
+	{
+		this->window_start = now;
+		this->window_bytes = 0;
+	}
+
+	this->window_bytes += bytes;
+
+	if (const auto elapsed = std::chrono::duration<double>(now - this->window_start).count(); elapsed >= 1.)
+	{
+		this->throughput = static_cast<double>(this->window_bytes) / elapsed;
+		this->last_throughput = this->throughput;
+		this->window_start = now;
+		this->window_bytes = 0;
+	}
+
+	this->refill(rate_limit, now);
+	this->tokens -= static_cast<double>(bytes);
+}
+
+auto BandwidthLimiter::get_delay() -> std::chrono::milliseconds
+{
+	const auto rate_limit = this->get_rate_limit();
+
+	std::lock_guard lock(this->mutex);
+
+	this->refill(rate_limit, Clock::now());
+
+	if (rate_limit == 0 || this->tokens >= 0.)
+		return std::chrono::milliseconds(0);
+
+	return std::chrono::ceil<std::chrono::milliseconds>(std::chrono::duration<double>(-this->tokens / static_cast<double>(rate_limit)));
+}
+
+auto BandwidthLimiter::get_rate_limit() const -> uint64_t
+{
+	const auto settings = GET_SETTING(bandwidth);
+
+	if (!settings.limit_uploads)
+		return 0;
+
+	const auto limit = this->in_combat.load() ? settings.in_combat_limit : settings.out_of_combat_limit;
+
+	return static_cast<uint64_t>((std::max)(limit, 0)) * 1024;
+}
+
+auto BandwidthLimiter::get_throughput() -> double
+{
+	std::lock_guard lock(this->mutex);
+
+	if (Clock::now() - this->window_start > std::chrono::seconds(2))
+		return 0.;
+
+	return this->throughput;
+}
+
+auto BandwidthLimiter::get_estimated_throughput() -> double
+{
+	const auto rate_limit = static_cast<double>(this->get_rate_limit());
+
+	std::lock_guard lock(this->mutex);
+
+	if (rate_limit > 0. && (this->last_throughput == 0. || this->last_throughput > rate_limit))
+		return rate_limit;
+
+	return this->last_throughput;
+}
+
+void BandwidthLimiter::refill(uint64_t rate_limit, Clock::time_point now)
+{
+	const auto elapsed = std::chrono::duration<double>(now - this->last_refill).count();
+
+	this->last_refill = now;
+
+	if (rate_limit == 0)
+	{
+		this->tokens = 0.;
+		return;
+	}
+
+	// bucket capacity allows bursts of up to one second
+	this->tokens = (std::min)(this->tokens + elapsed * static_cast<double>(rate_limit), static_cast<double>(rate_limit));
+}
+
+#undef LOG
+#undef LOG_FORMAT
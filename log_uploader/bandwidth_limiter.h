@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+// global token bucket shared by all uploaders, the rate depends on the current combat state
+class BandwidthLimiter
+{
+public:
+	BandwidthLimiter() {}
+	~BandwidthLimiter() {}
+
+	void set_in_combat(bool in_combat);
+
+	auto is_in_combat() const -> bool
+	{
+		return this->in_combat.load();
+	}
+
+	// takes sent bytes out of the bucket, the bucket may go into debt
+	void consume(uint64_t bytes);
+
+	// time until the bucket is out of debt at the current rate limit
+	auto get_delay() -> std::chrono::milliseconds;
+
+	// bytes per second, 0 = unlimited
+	auto get_rate_limit() const -> uint64_t;
+
+	// achieved upload throughput in bytes per second
+	auto get_throughput() -> double;
+
+	// last measured throughput capped by the current rate limit, 0 if nothing has been measured yet
+	auto get_estimated_throughput() -> double;
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	std::atomic<bool> in_combat = false;
+
+	std::mutex mutex;
+
+	double tokens = 0.;
+	Clock::time_point last_refill = Clock::now();
+
+	uint64_t window_bytes = 0;
+	Clock::time_point window_start = Clock::now();
+	double throughput = 0.;
+	double last_throughput = 0.;
+
+	void refill(uint64_t rate_limit, Clock::time_point now);
+};
+
+namespace global { extern std::unique_ptr<BandwidthLimiter> bandwidth_limiter; }
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// bounded lock-free queue for any number of producers and consumers (Vyukov), slots are allocated once and reused
+// values are filled and taken in place so their buffers, e.g. string capacity, stay with the ring
+template <typename T>
+class BoundedRing
+{
+public:
+	// capacity is rounded up to a power of two
+	explicit BoundedRing(size_t capacity)
+	{
+		while (this->mask + 1 < capacity)
+			this->mask = this->mask * 2 + 1;
+
+		this->slots = std::make_unique<Slot[]>(this->mask + 1);
+
+		for (size_t i = 0; i <= this->mask; i++)
+			this->slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	BoundedRing(const BoundedRing&) = delete;
+	BoundedRing& operator=(const BoundedRing&) = delete;
+
+	// fill(T&) writes the new value over a previously taken one, false when the ring is full
+	template <typename Fill>
+	auto try_push(Fill&& fill) -> bool
+	{
+		auto position = this->enqueue_position.load(std::memory_order_relaxed);
+
+		while (true)
+		{
+			auto& slot = this->slots[position & this->mask];
+			const auto sequence = slot.sequence.load(std::memory_order_acquire);
+			const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+			if (difference == 0)
+			{
+				if (this->enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					fill(slot.value);
+					slot.sequence.store(position + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (difference < 0)
+				return false;
+			else
+				position = this->enqueue_position.load(std::memory_order_relaxed);
+		}
+	}
+
+	// take(T&) reads or swaps out the oldest value, false when the ring is empty
+	template <typename Take>
+	auto try_pop(Take&& take) -> bool
+	{
+		auto position = this->dequeue_position.load(std::memory_order_relaxed);
+
+		while (true)
+		{
+			auto& slot = this->slots[position & this->mask];
+			const auto sequence = slot.sequence.load(std::memory_order_acquire);
+			const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+
+			if (difference == 0)
+			{
+				if (this->dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					take(slot.value);
+					slot.sequence.store(position + this->mask + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (difference < 0)
+				return false;
+			else
+				position = this->dequeue_position.load(std::memory_order_relaxed);
+		}
+	}
+
+	// a snapshot, only exact while no other thread pushes or pops
+	auto empty() const -> bool
+	{
+		const auto position = this->dequeue_position.load(std::memory_order_relaxed);
+		return this->slots[position & this->mask].sequence.load(std::memory_order_acquire) != position + 1;
+	}
+
+	auto capacity() const -> size_t { return this->mask + 1; }
+
+private:
+	static constexpr size_t cache_line_size = 64;
+
+	class Slot
+	{
+	public:
+		std::atomic<size_t> sequence = 0;
+		T value{};
+	};
+
+	std::unique_ptr<Slot[]> slots;
+	size_t mask = 0;
+
+	// producers and the consumer do not share a cache line
+	alignas(cache_line_size) std::atomic<size_t> enqueue_position = 0;
+	alignas(cache_line_size) std::atomic<size_t> dequeue_position = 0;
+};
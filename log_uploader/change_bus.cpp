@@ -0,0 +1,153 @@
+#include "change_bus.h"
+#include "logger.h"
+
+#include <algorithm>
+
+namespace global { std::unique_ptr<ChangeBus> change_bus = std::make_unique<ChangeBus>(); }
+
+#define LOG(message, log_level) do { if (Logger::is_enabled(log_level)) global::logger->write(message, log_level, LogSource::ChangeBus); } while (0)
+#define LOG_FORMAT(log_level, ...) global::logger->write_format(log_level, LogSource::ChangeBus, __VA_ARGS__)
+
+ChangeBus::ChangeBus()
+{
+	this->tail = new Node();
+	this->head.store(this->tail, std::memory_order_relaxed);
+}
+
+ChangeBus::~ChangeBus()
+{
+	while (this->tail)
+	{
+		auto next = this->tail->next.load(std::memory_order_relaxed);
+		delete this->tail;
+		this->tail = next;
+	}
+}
+
+void ChangeBus::initialize()
+{
+	std::lock_guard lock(this->initialization_mutex);
+
+	if (this->is_initialized())
+		return;
+
+	this->initialized = true;
+
+	this->dispatch_thread = std::thread(&ChangeBus::run, this);
+}
+
+void ChangeBus::release()
+{
+	std::lock_guard lock(this->initialization_mutex);
+
+	if (!this->initialized)
+		return;
+
+	this->initialized = false;
+
+	this->signal.fetch_add(1, std::memory_order_release);
+	this->signal.notify_one();
+
+	if (this->dispatch_thread.joinable())
+		this->dispatch_thread.join();
+}
+
+void ChangeBus::subscribe(LogChangeSubscriber subscriber)
+{
+	std::lock_guard lock(this->subscribers_mutex);
+	this->subscribers.push_back(std::move(subscriber));
+}
+
+void ChangeBus::post(std::shared_ptr<EncounterLog> encounter_log, LogChange change)
+{
+	auto node = new Node();
+
+	node->event.generation = encounter_log->generation.fetch_add(1, std::memory_order_acq_rel) + 1;
+	node->event.encounter_log = std::move(encounter_log);
+	node->event.change = change;
+
+	auto previous = this->head.exchange(node, std::memory_order_acq_rel);
+	previous->next.store(node, std::memory_order_release);
+
+	this->signal.fetch_add(1, std::memory_order_release);
+	this->signal.notify_one();
+}
+
+auto ChangeBus::pop(LogChangeEvent& event) -> bool
+{
+	auto next = this->tail->next.load(std::memory_order_acquire);
+
+	// either empty or a producer has swapped the head but not linked its node yet
+	if (!next)
+		return false;
+
+	event = std::move(next->event);
+
+	delete this->tail;
+	this->tail = next;
+
+	return true;
+}
+
+void ChangeBus::dispatch(std::vector<LogChangeEvent>& events)
+{
+	// stable sorting keeps the posting order of each log, only its last change is delivered
+	std::stable_sort(events.begin(), events.end(), [](const LogChangeEvent& a, const LogChangeEvent& b) { return a.encounter_log < b.encounter_log; });
+
+	const auto count = events.size();
+
+	auto last = events.begin();
+
+	for (auto it = events.begin(); it != events.end(); ++it)
+	{
+		if (auto next = std::next(it); next != events.end() && next->encounter_log == it->encounter_log)
+			continue;
+
+		if (last != it)
+			*last = std::move(*it);
+
+		++last;
+	}
+
+	events.erase(last, events.end());
+
+	this->dispatched_count.fetch_add(events.size(), std::memory_order_relaxed);
+	this->coalesced_count.fetch_add(count - events.size(), std::memory_order_relaxed);
+
+	std::lock_guard lock(this->subscribers_mutex);
+
+	for (const auto& subscriber : this->subscribers)
+		subscriber(events);
+}
+
+void ChangeBus::run()
+{
+	LOG("Dispatch thread started", LogLevel::Info);
+
+	std::vector<LogChangeEvent> events;
+
+	while (true)
+	{
+		const auto observed = this->signal.load(std::memory_order_acquire);
+
+		for (LogChangeEvent event; this->pop(event);)
+			events.push_back(std::move(event));
+
+		if (!events.empty())
+		{
+			this->dispatch(events);
+			events.clear();
+			continue;
+		}
+
+		if (!this->is_initialized())
+			break;
+
+		this->signal.wait(observed, std::memory_order_acquire);
+	}
+
+	LOG("Dispatch thread shutdown", LogLevel::Info);
+}
+
+#undef LOG
+#undef LOG_FORMAT
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "encounter_log.h"
+#include "module.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+enum class LogChange : uint8_t
+{
+	PARSE_STATUS,
+	DPS_REPORT_UPLOAD,
+	WINGMAN_UPLOAD,
+	TRANSFER_PROGRESS,
+	SELECTION,
+	REPORT_OPENING
+};
+
+class LogChangeEvent
+{
+public:
+	std::shared_ptr<EncounterLog> encounter_log;
+	uint64_t generation = 0; // of the log once this change was posted, lets subscribers drop changes they already hold
+	LogChange change = LogChange::PARSE_STATUS;
+};
+
+using LogChangeSubscriber = std::function<void(const std::vector<LogChangeEvent>& events)>;
+
+// delivers encounter log changes from the parser, uploader and ui threads to subscribers on a single dispatch thread
+class ChangeBus : public Module
+{
+public:
+	ChangeBus();
+	~ChangeBus();
+
+	void initialize();
+	void release() override;
+
+	// subscribers receive batches of changes, only the latest change of each log is delivered per batch
+	void subscribe(LogChangeSubscriber subscriber);
+
+	// lock free, bumps the log generation, must not be called while holding the log mutex
+	void post(std::shared_ptr<EncounterLog> encounter_log, LogChange change);
+
+	auto get_dispatched_count() const -> uint64_t { return this->dispatched_count.load(std::memory_order_relaxed); }
+	auto get_coalesced_count() const -> uint64_t { return this->coalesced_count.load(std::memory_order_relaxed); }
+
+private:
+	class Node
+	{
+	public:
+		std::atomic<Node*> next = nullptr;
+		LogChangeEvent event;
+	};
+
+	// multi producer single consumer queue, producers swap the head, the dispatch thread owns the tail
+	std::atomic<Node*> head;
+	Node* tail;
+
+	std::atomic<uint32_t> signal = 0;
+
+	std::mutex subscribers_mutex;
+	std::vector<LogChangeSubscriber> subscribers;
+
+	std::thread dispatch_thread;
+
+	std::atomic<uint64_t> dispatched_count = 0;
+	std::atomic<uint64_t> coalesced_count = 0;
+
+	auto pop(LogChangeEvent& event) -> bool;
+
+	void dispatch(std::vector<LogChangeEvent>& events);
+	void run();
+};
+
+namespace global { extern std::unique_ptr<ChangeBus> change_bus; }
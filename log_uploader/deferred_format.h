@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <format>
+#include <iterator>
+#include <new>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// strings are copied, the caller's buffer may be gone by the time the message is formatted
+template <typename T>
+using DeferredArgument = std::conditional_t<std::is_convertible_v<const std::decay_t<T>&, std::string_view>, std::string, std::decay_t<T>>;
+
+// a format string and copies of its arguments, formatted later on another thread
+// the arguments live inline so capturing them does not allocate unless a string is copied
+class DeferredFormat
+{
+public:
+	static constexpr size_t capacity = 128;
+
+	template <typename... Args>
+	static constexpr bool fits = sizeof(std::tuple<DeferredArgument<Args>...>) <= capacity && alignof(std::tuple<DeferredArgument<Args>...>) <= alignof(std::max_align_t);
+
+	DeferredFormat() {}
+	DeferredFormat(const DeferredFormat&) = delete;
+	DeferredFormat& operator=(const DeferredFormat&) = delete;
+	~DeferredFormat() { this->reset(); }
+
+	// format has to outlive the deferred format, i.e. be a string literal
+	template <typename... Args>
+	void store(std::string_view format, Args&&... args) requires fits<Args...>
+	{
+		using Arguments = std::tuple<DeferredArgument<Args>...>;
+
+		this->reset();
+
+		new (this->arguments) Arguments(std::forward<Args>(args)...);
+
+		this->format = format;
+		this->format_function = [](DeferredFormat& deferred_format, std::string* message)
+			{
+				auto& arguments = *std::launder(reinterpret_cast<Arguments*>(deferred_format.arguments));
+
+				if (message)
+					std::apply([&](auto&... values) { std::vformat_to(std::back_inserter(*message), deferred_format.format, std::make_format_args(values...)); }, arguments);
+
+				arguments.~Arguments();
+			};
+	}
+
+	auto is_pending() const -> bool { return this->format_function != nullptr; }
+
+	// appends the formatted message and releases the arguments
+	void format_to(std::string& message)
+	{
+		if (!this->is_pending())
+			return;
+
+		auto format_function = std::exchange(this->format_function, nullptr);
+		format_function(*this, &message);
+	}
+
+	// the format string identifies the call site, valid after formatting as well
+	auto get_format() const -> std::string_view { return this->format; }
+
+	// releases the arguments without formatting them
+	void reset()
+	{
+		if (auto format_function = std::exchange(this->format_function, nullptr))
+			format_function(*this, nullptr);
+	}
+
+private:
+	std::string_view format;
+	void (*format_function)(DeferredFormat& deferred_format, std::string* message) = nullptr;
+
+	alignas(std::max_align_t) std::byte arguments[capacity];
+};
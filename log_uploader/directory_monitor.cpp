@@ -1,10 +1,10 @@
+#include <algorithm>
 #include <atomic>
-#include <deque>
+#include <chrono>
 #include <filesystem>
-#include <iostream>
+#include <format>
 #include <thread>
 #include <vector>
-#include <Windows.h>
 
 #include "directory_monitor.h"
 #include "elite_insights.h"
@@ -12,17 +12,19 @@
 #include "evtc_parser.h"
 #include "log_manager.h"
 #include "logger.h"
+#include "settings.h"
 
 namespace global { std::unique_ptr<DirectoryMonitor> directory_monitor = std::make_unique<DirectoryMonitor>(); }
 
-#define LOG(message, log_level) global::logger->write(message, log_level, LogSource::DirectoryMonitor)
+#define LOG(message, log_level) do { if (Logger::is_enabled(log_level)) global::logger->write(message, log_level, LogSource::DirectoryMonitor); } while (0)
+#define LOG_FORMAT(log_level, ...) global::logger->write_format(log_level, LogSource::DirectoryMonitor, __VA_ARGS__)
 
-void DirectoryMonitor::initialize(std::filesystem::path monitor_directory)
+void DirectoryMonitor::initialize(std::vector<std::filesystem::path> monitor_directories)
 {
 	std::lock_guard lock(this->initialization_mutex);
 
-	if (monitor_directory.empty())
-		throw std::invalid_argument("monitor_directory is empty");
+	if (monitor_directories.empty())
+		throw std::invalid_argument("monitor_directories is empty");
 
 	if (this->is_initialized())
 	{
@@ -30,10 +32,73 @@ void DirectoryMonitor::initialize(std::filesystem::path monitor_directory)
 		return;
 	}
 
-	this->monitor_directory = monitor_directory;
+	// opened before the thread starts so release can always interrupt it
+	this->file_watcher = FileWatcher::create();
+
+	if (!this->file_watcher->open(static_cast<size_t>(GET_SETTING(monitor.change_buffer_size)) * 1024))
+	{
+		LOG(this->file_watcher->get_error(), LogLevel::Error);
+		this->file_watcher.reset();
+		return;
+	}
+
+	this->roots.clear();
+
+	for (const auto& monitor_directory : monitor_directories)
+	{
+		std::error_code error;
+
+		if (!std::filesystem::is_directory(monitor_directory, error))
+		{
+			LOG("Monitor directory does not exist: " + monitor_directory.string(), LogLevel::Error);
+			continue;
+		}
+
+		const auto directory = std::filesystem::weakly_canonical(monitor_directory, error);
+
+		// a file below two roots would be reported twice by the watcher
+		const auto overlaps = std::any_of(this->roots.begin(), this->roots.end(), [&directory](const MonitorRoot& root)
+			{
+				const auto is_within = [](const std::filesystem::path& path, const std::filesystem::path& base)
+					{
+						const auto relative = path.lexically_relative(base);
+						return !relative.empty() && *relative.begin() != "..";
+					};
+
+				return is_within(directory, root.directory) || is_within(root.directory, directory);
+			});
+
+		if (overlaps)
+		{
+			LOG("Monitor directory overlaps another one: " + directory.string(), LogLevel::Warning);
+			continue;
+		}
+
+		if (!this->file_watcher->add_root(directory))
+		{
+			LOG(this->file_watcher->get_error(), LogLevel::Error);
+			continue;
+		}
+
+		// logs already in the directory are not picked up, as before
+		this->roots.push_back({ directory, std::filesystem::file_time_type::clock::now() });
+	}
+
+	if (this->roots.empty())
+	{
+		this->file_watcher.reset();
+		return;
+	}
+
+	this->metrics = DetectionMetrics();
+	this->known_files.clear();
+	this->registered_logs.clear();
 
 	this->initialized.store(true);
 
+	for (size_t i = 0; i < worker_count; i++)
+		this->workers.emplace_back(&DirectoryMonitor::run_worker, this);
+
 	this->monitor_thread = std::thread(&DirectoryMonitor::run, this);
 }
 
@@ -43,151 +108,322 @@ void DirectoryMonitor::release()
 
 	this->initialized.store(false);
 
-	if (this->monitor_overlapped.hEvent != NULL)
-		SetEvent(this->monitor_overlapped.hEvent);
+	if (this->file_watcher)
+		this->file_watcher->interrupt();
 
 	if (this->monitor_thread.joinable())
 		this->monitor_thread.join();
 
-	this->monitor_overlapped = { 0 };
-	this->monitor_directory.clear();
+	{
+		std::lock_guard candidate_lock(this->candidate_mutex);
+		this->candidate_cv.notify_all();
+	}
+
+	for (auto& worker : this->workers)
+		if (worker.joinable())
+			worker.join();
+
+	this->workers.clear();
+	this->candidates.clear();
+
+	this->file_watcher.reset();
+	this->roots.clear();
+}
+
+auto DirectoryMonitor::get_root_directory(uint32_t root) -> std::filesystem::path
+{
+	std::lock_guard lock(this->initialization_mutex);
+
+	return root < this->roots.size() ? this->roots[root].directory : std::filesystem::path();
 }
 
 void DirectoryMonitor::run()
 {
-	if (!this->is_initialized())
-		return;
+	for (const auto& root : this->roots)
+		LOG("Started monitoring " + root.directory.string(), LogLevel::Info);
+
+	std::vector<FileEvent> events;
 
-	if (!std::filesystem::exists(monitor_directory))
+	while (this->is_initialized())
 	{
-		LOG("Monitor directory does not exist: " + monitor_directory.string(), LogLevel::Error);
-		return;
-	}
+		events.clear();
 
-	auto logs_directory_handle = CreateFileW(monitor_directory.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+		if (!this->file_watcher->wait(events))
+		{
+			if (this->is_initialized())
+				LOG(this->file_watcher->get_error(), LogLevel::Error);
 
-	if (logs_directory_handle == INVALID_HANDLE_VALUE)
-	{
-		LOG("Failed to open logs directory: " + monitor_directory.string(), LogLevel::Error);
-		return;
+			break;
+		}
+
+		const auto detected_time = std::chrono::steady_clock::now();
+
+		std::vector<DetectionCandidate> new_candidates;
+		std::vector<uint32_t> dropped_roots;
+
+		for (const auto& event : events)
+		{
+			if (event.type == FileEventType::EVENTS_DROPPED)
+			{
+				dropped_roots.push_back(event.root);
+				continue;
+			}
+
+			// the other directories are still monitored
+			if (event.type == FileEventType::ROOT_LOST)
+			{
+				LOG("Stopped monitoring " + this->roots[event.root].directory.string() + ", the directory can no longer be watched", LogLevel::Error);
+				std::erase(dropped_roots, event.root);
+				continue;
+			}
+
+			// arcdps renames finished logs into place, a created file is still being written
+			if (event.type != FileEventType::RENAMED_TO && event.type != FileEventType::CLOSED_AFTER_WRITE)
+				continue;
+
+			auto extension = event.path.extension().string();
+
+			if (extension == ".evtc" || extension == ".zevtc")
+				new_candidates.push_back({ event.root, this->roots[event.root].directory / event.path, detected_time, event.type });
+		}
+
+		this->enqueue(std::move(new_candidates), false);
+
+		for (const auto root : dropped_roots)
+		{
+			{
+				std::lock_guard candidate_lock(this->candidate_mutex);
+				this->metrics.dropped++;
+			}
+
+			LOG("Directory change buffer overflowed, scanning for missed logs in " + this->roots[root].directory.string(), LogLevel::Warning);
+
+			this->reconcile(root);
+		}
 	}
 
-	std::vector<BYTE> buffer(4096);
-	DWORD bytes_returned;
+	LOG("Directory monitor stopped", LogLevel::Info);
+}
 
-	this->monitor_overlapped.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+auto DirectoryMonitor::enqueue(std::vector<DetectionCandidate> new_candidates, bool recovered) -> size_t
+{
+	// a log can be reported more than once, e.g. closed and then renamed, or found by a scan as well
+	std::erase_if(new_candidates, [this](const DetectionCandidate& candidate) { return !this->known_files.insert(candidate.file_path.native()).second; });
+
+	if (new_candidates.empty())
+		return 0;
 
-	if (this->monitor_overlapped.hEvent == NULL)
+	// the next change buffer is read right away, slow files only hold up the workers
+	std::lock_guard candidate_lock(this->candidate_mutex);
+
+	for (auto& candidate : new_candidates)
 	{
-		LOG("Failed to create event for directory monitoring", LogLevel::Error);
-		CloseHandle(logs_directory_handle);
-		return;
+		global::logger->trace(TraceEvent::LOG_DETECTED, LogSource::DirectoryMonitor, hash_trace_id(candidate.file_path.native()), this->candidates.size() + 1, recovered);
+		this->candidates.push_back(std::move(candidate));
 	}
 
-	LOG("Started monitoring " + monitor_directory.string(), LogLevel::Info);
+	this->metrics.enqueued += new_candidates.size();
+	this->metrics.max_queue_depth = (std::max)(this->metrics.max_queue_depth, this->candidates.size());
 
-	while (this->is_initialized())
+	if (recovered)
+		this->metrics.recovered += new_candidates.size();
+
+	this->candidate_cv.notify_all();
+
+	return new_candidates.size();
+}
+
+void DirectoryMonitor::reconcile(uint32_t root)
+{
+	auto& monitor_root = this->roots[root];
+
+	// timestamps are not exact on every file system, a little overlap is caught by the known files
+	constexpr auto timestamp_tolerance = std::chrono::seconds(2);
+
+	const auto scan_start = std::filesystem::file_time_type::clock::now();
+	const auto threshold = monitor_root.scan_watermark - timestamp_tolerance;
+	const auto detected_time = std::chrono::steady_clock::now();
+
+	std::vector<DetectionCandidate> missed_candidates;
+	std::error_code error;
+
+	// every directory is entered, a new file only touches its immediate parent and not e.g. the encounter directory above it
+	for (auto it = std::filesystem::recursive_directory_iterator(monitor_root.directory, error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error))
 	{
-		auto result = ReadDirectoryChangesW(logs_directory_handle, buffer.data(), static_cast<DWORD>(buffer.size()), TRUE, FILE_NOTIFY_CHANGE_FILE_NAME, &bytes_returned, &this->monitor_overlapped, nullptr);
+		if (!it->is_regular_file(error))
+		{
+			error.clear();
+			continue;
+		}
+
+		const auto extension = it->path().extension().string();
+
+		if (extension != ".evtc" && extension != ".zevtc")
+			continue;
+
+		const auto last_write_time = it->last_write_time(error);
 
-		if (!result && GetLastError() != ERROR_IO_PENDING)
+		if (error)
 		{
-			LOG("Failed to read logs directory changes", LogLevel::Error);
-			break;
+			error.clear();
+			continue;
 		}
 
-		DWORD wait_result = WaitForSingleObject(this->monitor_overlapped.hEvent, INFINITE);
+		if (last_write_time >= threshold)
+			missed_candidates.push_back({ root, it->path(), detected_time });
+	}
+
+	if (error)
+		LOG("Reconciliation scan failed: " + error.message(), LogLevel::Error);
+	else
+		monitor_root.scan_watermark = scan_start;
+
+	const auto recent_count = missed_candidates.size();
+	const auto recovered_count = this->enqueue(std::move(missed_candidates), true);
 
-		if (!this->is_initialized() || this->monitor_overlapped.hEvent == NULL)
+	LOG("Reconciliation scan found " + std::to_string(recent_count) + " recent logs, " + std::to_string(recovered_count) + " of them were missed", LogLevel::Info);
+}
+
+void DirectoryMonitor::run_worker()
+{
+	std::unique_lock candidate_lock(this->candidate_mutex);
+
+	while (true)
+	{
+		this->candidate_cv.wait(candidate_lock, [this] { return !this->is_initialized() || !this->candidates.empty(); });
+
+		if (!this->is_initialized())
 			break;
 
-		if (wait_result == WAIT_OBJECT_0)
-		{
-			DWORD bytes_transferred;
+		auto candidate = std::move(this->candidates.front());
+		this->candidates.pop_front();
 
-			if (GetOverlappedResult(logs_directory_handle, &this->monitor_overlapped, &bytes_transferred, TRUE))
-			{
-				ResetEvent(this->monitor_overlapped.hEvent);
+		const auto start_time = std::chrono::steady_clock::now();
+		this->metrics.queue_wait.add(std::chrono::duration<double, std::milli>(start_time - candidate.detected_time).count());
 
-				auto* fni = reinterpret_cast<FILE_NOTIFY_INFORMATION*>(buffer.data());
+		candidate_lock.unlock();
 
-				std::deque<std::shared_ptr<EncounterLog>> new_logs;
+		const auto registered = this->process_file(candidate);
 
-				do
-				{
-					if (fni->Action == FILE_ACTION_RENAMED_NEW_NAME)
-					{
-						auto file_name = std::filesystem::path(std::wstring(fni->FileName, fni->FileNameLength / sizeof(wchar_t)));
-
-						auto extension = file_name.extension().string();
-
-						if (extension == ".evtc" || extension == ".zevtc")
-						{
-							{
-								static const auto is_file_openable = [](const std::filesystem::path& log_path)
-									{
-										std::ifstream file_stream(log_path);
-										return file_stream.is_open();
-									};
-
-								auto file_path = monitor_directory / file_name;
-
-								auto log_available = is_file_openable(file_path);
-
-								int cooldown = 0;
-
-								while (!log_available && cooldown++ < 100)
-								{
-									std::this_thread::sleep_for(std::chrono::milliseconds(100));
-									log_available = is_file_openable(file_path);
-								}
-
-								if (log_available)
-								{
-									LOG("New evtc file detected: " + file_path.string(), LogLevel::Debug);
-
-									EVTCData evtc_data;
-
-									try
-									{
-										evtc_data = global::evtc_parser->parse(file_path);
-
-										if (evtc_data.trigger_id != TriggerID::Invalid)
-											global::log_manager->add_encounter_log(evtc_data);
-									}
-									catch (const std::exception& e)
-									{
-										LOG("Evtc parsing failed. File: \"" + file_name.string() + "\" Exception: " + e.what(), LogLevel::Warning);
-									}
-								}
-								else
-									LOG("Evtc file unavailable: " + file_path.string(), LogLevel::Warning);
-							}
-						}
-					}
-
-					fni = (fni->NextEntryOffset != 0) ? reinterpret_cast<FILE_NOTIFY_INFORMATION*>(reinterpret_cast<BYTE*>(fni) + fni->NextEntryOffset) : nullptr;
-
-				} while (fni != nullptr && this->is_initialized());
-			}
-		}
-		else if (wait_result == WAIT_FAILED)
+		candidate_lock.lock();
+
+		this->metrics.processing.add(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count());
+
+		if (registered)
+			this->metrics.registered++;
+		else
+			this->metrics.failed++;
+	}
+}
+
+void DirectoryMonitor::dump_metrics()
+{
+	std::lock_guard candidate_lock(this->candidate_mutex);
+
+	LOG("Detection | enqueued: " + std::to_string(this->metrics.enqueued) + " registered: " + std::to_string(this->metrics.registered) + " failed: " + std::to_string(this->metrics.failed), LogLevel::Info);
+	LOG("Detection | dropped change buffers: " + std::to_string(this->metrics.dropped) + " recovered logs: " + std::to_string(this->metrics.recovered) + " duplicates: " + std::to_string(this->metrics.duplicates), LogLevel::Info);
+	LOG("Detection | queue depth: " + std::to_string(this->candidates.size()) + " max: " + std::to_string(this->metrics.max_queue_depth), LogLevel::Info);
+	LOG("Detection | queue wait: " + this->metrics.queue_wait.to_string(), LogLevel::Info);
+	LOG("Detection | readiness: " + this->metrics.readiness.to_string() + std::format(" median={:.0f}ms", this->metrics.median_readiness.get()), LogLevel::Info);
+	LOG("Detection | processing: " + this->metrics.processing.to_string(), LogLevel::Info);
+}
+
+auto DirectoryMonitor::wait_until_released(const std::filesystem::path& file_path) -> bool
+{
+	constexpr auto initial_backoff = std::chrono::milliseconds(5);
+	constexpr auto max_backoff = std::chrono::milliseconds(500);
+	constexpr auto timeout = std::chrono::seconds(10);
+
+	const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+	auto backoff = std::chrono::milliseconds(initial_backoff);
+
+	std::error_code error;
+	auto last_size = std::filesystem::file_size(file_path, error);
+
+	while (!FileWatcher::is_released(file_path))
+	{
+		if (!this->is_initialized() || std::chrono::steady_clock::now() + backoff > deadline)
+			return false;
+
+		std::this_thread::sleep_for(backoff);
+
+		// a growing file is still being written, it is probed again shortly after the writes stop
+		const auto size = std::filesystem::file_size(file_path, error);
+
+		backoff = size != last_size ? initial_backoff : (std::min)(backoff * 2, max_backoff);
+		last_size = size;
+	}
+
+	return true;
+}
+
+auto DirectoryMonitor::process_file(const DetectionCandidate& candidate) -> bool
+{
+	const auto& file_path = candidate.file_path;
+
+	// inotify reports the final close, renamed files may still be held open by arcdps
+	if (candidate.event_type != FileEventType::CLOSED_AFTER_WRITE && !this->wait_until_released(file_path))
+	{
+		LOG("Evtc file unavailable: " + file_path.string(), LogLevel::Warning);
+		return false;
+	}
+
+	const auto readiness = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - candidate.detected_time).count();
+
+	{
+		std::lock_guard candidate_lock(this->candidate_mutex);
+
+		this->metrics.readiness.add(readiness);
+		this->metrics.median_readiness.add(readiness);
+	}
+
+	LOG_FORMAT(LogLevel::Debug, "New evtc file detected: {} (ready after {:.0f}ms)", file_path.string(), readiness);
+
+	// a log copied into a second root, e.g. an archive share, keeps its name and size
+	std::error_code error;
+	const auto file_size = std::filesystem::file_size(file_path, error);
+	const auto log_key = file_path.filename().native() + std::filesystem::path(std::to_string(file_size)).native();
+
+	global::logger->trace(TraceEvent::LOG_READY, LogSource::DirectoryMonitor, hash_trace_id(file_path.native()), static_cast<int64_t>(readiness), error ? -1 : static_cast<int64_t>(file_size));
+
+	{
+		std::lock_guard candidate_lock(this->candidate_mutex);
+
+		if (!this->registered_logs.insert(log_key).second)
 		{
-			LOG("Logs directory monitor WaitForSingleObject failed", LogLevel::Error);
-			break;
+			global::logger->trace(TraceEvent::LOG_DUPLICATE, LogSource::DirectoryMonitor, hash_trace_id(file_path.native()));
+			this->metrics.duplicates++;
+			LOG_FORMAT(LogLevel::Debug, "Evtc file already registered from another directory: {}", file_path.string());
+			return false;
 		}
 	}
 
-	if (monitor_overlapped.hEvent != NULL)
+	EVTCData evtc_data;
+
+	try
 	{
-		CloseHandle(monitor_overlapped.hEvent);
-		this->monitor_overlapped.hEvent = NULL;
+		evtc_data = global::evtc_parser->parse(file_path);
+
+		if (evtc_data.trigger_id != TriggerID::Invalid)
+		{
+			evtc_data.root = candidate.root;
+
+			global::log_manager->add_encounter_log(evtc_data);
+			return true;
+		}
+	}
+	catch (const std::exception& e)
+	{
+		LOG("Evtc parsing failed. File: \"" + file_path.filename().string() + "\" Exception: " + e.what(), LogLevel::Warning);
 	}
 
-	if (logs_directory_handle != INVALID_HANDLE_VALUE)
-		CloseHandle(logs_directory_handle);
+	// a later copy of the log may still be readable
+	std::lock_guard candidate_lock(this->candidate_mutex);
+	this->registered_logs.erase(log_key);
 
-	LOG("Directory monitor stopped", LogLevel::Info);
+	return false;
 }
 
-#undef LOG
\ No newline at end of file
+#undef LOG
+#undef LOG_FORMAT
@@ -1,27 +1,104 @@
 #pragma once
 
+#include "file_watcher.h"
+#include "http_metrics.h"
 #include "module.h"
+#include "streaming_quantile.h"
 
 #include <atomic>
-#include <thread>
-#include <Windows.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+class MonitorRoot
+{
+public:
+	std::filesystem::path directory;
+	std::filesystem::file_time_type scan_watermark{}; // every change before it was seen
+};
+
+class DetectionCandidate
+{
+public:
+	uint32_t root = 0;
+	std::filesystem::path file_path;
+	std::chrono::steady_clock::time_point detected_time{};
+
+	FileEventType event_type = FileEventType::RENAMED_TO; // a closed file is ready without probing
+};
+
+class DetectionMetrics
+{
+public:
+	uint64_t enqueued = 0;
+	uint64_t registered = 0;
+	uint64_t failed = 0; // unavailable, unparsable or without a known trigger
+
+	uint64_t dropped = 0; // change buffers lost to an overflow
+	uint64_t recovered = 0; // logs only found by the reconciliation scan after an overflow
+	uint64_t duplicates = 0; // logs already registered from another root
+
+	size_t max_queue_depth = 0;
+
+	LatencyHistogram queue_wait; // detection until a worker picked the file up
+	LatencyHistogram readiness; // detection until arcdps released the file
+	LatencyHistogram processing; // readiness, header parsing and registration
 
+	StreamingQuantile median_readiness;
+};
+
+// the watcher thread only collects candidate files, workers wait for them to be readable, parse their header and add them
+// any number of log directories are watched by the one watcher thread, e.g. of multiboxed clients or an archive share
 class DirectoryMonitor : public Module
 {
 public:
 	DirectoryMonitor() {}
 	~DirectoryMonitor() {}
 
-	void initialize(std::filesystem::path monitor_directory);
+	static constexpr size_t worker_count = 2;
+
+	// directories that are missing or overlap an earlier one are skipped
+	void initialize(std::vector<std::filesystem::path> monitor_directories);
 	void release() override;
 
+	// the directory a log was found in, see EVTCData::root
+	auto get_root_directory(uint32_t root) -> std::filesystem::path;
+
+	// writes the queue depth and stage latencies to the log
+	void dump_metrics();
+
 private:
 	std::thread monitor_thread;
-	OVERLAPPED monitor_overlapped = { 0 };
-	std::filesystem::path monitor_directory;
+	std::unique_ptr<FileWatcher> file_watcher;
+	std::vector<MonitorRoot> roots; // indexed like the watcher roots, fixed while initialized
+
+	std::mutex candidate_mutex;
+	std::condition_variable candidate_cv;
+	std::deque<DetectionCandidate> candidates;
+	std::vector<std::thread> workers;
+
+	DetectionMetrics metrics; // guarded by candidate_mutex
+
+	// file name and size of every log handed to the log manager, the same log in two roots is only added once, guarded by candidate_mutex
+	std::unordered_set<std::filesystem::path::string_type> registered_logs;
+
+	// only used by the monitor thread
+	std::unordered_set<std::filesystem::path::string_type> known_files;
 
 	void run();
+	// skips files that were queued before, returns the number of queued files
+	auto enqueue(std::vector<DetectionCandidate> new_candidates, bool recovered) -> size_t;
+	void reconcile(uint32_t root);
+	void run_worker();
+	auto process_file(const DetectionCandidate& candidate) -> bool;
+	auto wait_until_released(const std::filesystem::path& file_path) -> bool;
 };
 
-namespace global { extern std::unique_ptr<DirectoryMonitor> directory_monitor; }
\ No newline at end of file
+namespace global { extern std::unique_ptr<DirectoryMonitor> directory_monitor; }
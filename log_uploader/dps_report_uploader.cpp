@@ -1,5 +1,8 @@
+#include "change_bus.h"
 #include "dps_report_uploader.h"
+#include "evtc_compressor.h"
 #include "logger.h"
+#include "multipart_stream.h"
 
 #include <string>
 
@@ -9,9 +12,10 @@
 
 namespace global { std::unique_ptr<DpsReportUploader> dps_report_uploader = std::make_unique<DpsReportUploader>(); }
 
-#define LOG(message, log_level) global::logger->write(message, log_level, LogSource::DpsReportUploader)
+#define LOG(message, log_level) do { if (Logger::is_enabled(log_level)) global::logger->write(message, log_level, LogSource::DpsReportUploader); } while (0)
+#define LOG_FORMAT(log_level, ...) global::logger->write_format(log_level, LogSource::DpsReportUploader, __VA_ARGS__)
 
-void DpsReportUploader::queue_upload(std::shared_ptr<EncounterLog> encounter_log, bool is_auto_upload)
+void DpsReportUploader::queue_uploads(const std::vector<std::shared_ptr<EncounterLog>>& encounter_logs, bool is_auto_upload)
 {
 	if (!this->is_initialized())
 	{
@@ -19,24 +23,41 @@ void DpsReportUploader::queue_upload(std::shared_ptr<EncounterLog> encounter_log
 		return;
 	}
 
-	std::unique_lock log_lock(encounter_log->mutex);
+	std::vector<std::shared_ptr<EncounterLog>> queued_logs;
 
-	if (encounter_log->dps_report_upload.status != DpsReportUploadStatus::AVAILABLE && encounter_log->dps_report_upload.status != DpsReportUploadStatus::FAILED)
+	for (const auto& encounter_log : encounter_logs)
 	{
-		LOG("Log is not available for upload", LogLevel::Warning);
-		return;
-	}
+		std::unique_lock log_lock(encounter_log->mutex);
+
+		if (encounter_log->dps_report_upload.status != DpsReportUploadStatus::AVAILABLE && encounter_log->dps_report_upload.status != DpsReportUploadStatus::FAILED)
+		{
+			LOG("Log is not available for upload", LogLevel::Warning);
+			continue;
+		}
+
+		encounter_log->dps_report_upload.is_auto_upload = is_auto_upload;
+		encounter_log->dps_report_upload.status = DpsReportUploadStatus::QUEUED;
 
-	encounter_log->dps_report_upload.is_auto_upload = is_auto_upload;
-	encounter_log->dps_report_upload.status = DpsReportUploadStatus::QUEUED;
+		LOG_FORMAT(LogLevel::Info, "Queued encounter log for upload: {}", encounter_log->id);
 
-	LOG("Queued encounter log for upload: " + encounter_log->id, LogLevel::Info);
+		log_lock.unlock();
+
+		global::change_bus->post(encounter_log, LogChange::DPS_REPORT_UPLOAD);
 
-	log_lock.unlock();
+		global::logger->trace(TraceEvent::UPLOAD_QUEUED, LogSource::DpsReportUploader, hash_trace_id(encounter_log->id));
+
+		queued_logs.push_back(encounter_log);
+	}
+
+	if (queued_logs.empty())
+		return;
 
 	{
 		std::unique_lock upload_queue_lock(this->upload_queue_mutex);
-		this->upload_queue.push(encounter_log);
+
+		for (auto& encounter_log : queued_logs)
+			this->upload_queue.push(std::move(encounter_log));
+
 		this->upload_cv.notify_one();
 	}
 }
@@ -90,15 +111,17 @@ void DpsReportUploader::run()
 
 		log->dps_report_upload.status = DpsReportUploadStatus::UPLOADING;
 
-		LOG("Uploading encounter log: " + log->id, LogLevel::Info);
+		LOG_FORMAT(LogLevel::Info, "Uploading encounter log: {}", log->id);
 
 		DpsReportUpload upload = log->dps_report_upload;
+		upload.error_message.reset();
 
 		log_lock.unlock();
 
+		global::change_bus->post(log, LogChange::DPS_REPORT_UPLOAD);
+
 		cpr::Url url("https://dps.report/uploadContent");
 		cpr::Parameters parameters{};
-		cpr::Multipart multipart{ { "file", cpr::File(log->evtc_data.evtc_file_path.string(), log->evtc_data.evtc_file_path.filename().string())}, { "json", "1" } };
 
 		auto settings = GET_SETTING(dps_report);
 
@@ -111,11 +134,37 @@ void DpsReportUploader::run()
 		if (settings.detailed_wvw)
 			parameters.Add({ "detailedwvw", "true" });
 
-		auto response = cpr::Post(url, parameters, multipart, cpr::Timeout{ settings.request_timeout });
+		cpr::Response response;
+		std::optional<std::string> stream_error;
+
+		const auto log_id_hash = hash_trace_id(log->id);
+		const auto upload_start_time = std::chrono::steady_clock::now();
+
+		try
+		{
+			const auto upload_file = global::evtc_compressor->prepare_upload(log);
+
+			std::error_code error;
+			global::logger->trace(TraceEvent::UPLOAD_STARTED, LogSource::DpsReportUploader, log_id_hash, static_cast<int64_t>(std::filesystem::file_size(upload_file.file_path, error)));
+
+			MultipartStream multipart;
+			multipart.add_file("file", upload_file.file_path, upload_file.file_name);
+			multipart.add_field("json", "1");
+
+			const auto [connect_timeout, stall_timeout] = create_upload_timeouts(settings.request_timeout);
+
+			response = this->post("dps.report/uploadContent", url, parameters, multipart.create_header(), multipart.create_read_callback(), connect_timeout, stall_timeout, this->create_progress_callback(log, &EncounterLogView::dps_report_progress));
+		}
+		catch (const std::exception& e)
+		{
+			stream_error = e.what();
+		}
 
 		upload.status = DpsReportUploadStatus::FAILED;
 
-		if (response.status_code == 200)
+		if (stream_error.has_value())
+			upload.error_message = "Failed to read log: " + stream_error.value();
+		else if (response.status_code == 200)
 		{
 			try
 			{
@@ -162,12 +211,14 @@ void DpsReportUploader::run()
 		else
 			upload.error_message = "Server error: " + std::to_string(response.status_code);
 
+		global::logger->trace(TraceEvent::UPLOAD_FINISHED, LogSource::DpsReportUploader, log_id_hash, response.status_code, upload.status == DpsReportUploadStatus::UPLOADED, std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - upload_start_time).count());
+
 		log_lock.lock();
 
 		log->dps_report_upload = upload;
 
 		if (log->dps_report_upload.status == DpsReportUploadStatus::UPLOADED)
-			LOG("Encounter log uploaded: " + log->id, LogLevel::Info);
+			LOG_FORMAT(LogLevel::Info, "Encounter log uploaded: {}", log->id);
 		else
 		{
 			if (upload.error_message.has_value())
@@ -178,6 +229,8 @@ void DpsReportUploader::run()
 
 		log_lock.unlock();
 
+		global::change_bus->post(log, LogChange::DPS_REPORT_UPLOAD);
+
 		if (GET_SETTING(dps_report.copy_to_clipboard) && upload.status == DpsReportUploadStatus::UPLOADED)
 		{
 			std::string clipboard_text = upload.url;
@@ -202,4 +255,5 @@ void DpsReportUploader::run()
 	LOG("Uploader shutdown", LogLevel::Info);
 }
 
-#undef LOG
\ No newline at end of file
+#undef LOG
+#undef LOG_FORMAT
\ No newline at end of file
@@ -22,8 +22,11 @@ public:
 		this->upload_thread = std::thread(&DpsReportUploader::run, this);
 	};
 
-	void queue_upload(std::shared_ptr<EncounterLog> encounter_log) override { this->queue_upload(std::move(encounter_log), false); };
-	void queue_upload(std::shared_ptr<EncounterLog> encounter_log, bool is_auto_upload);
+	void queue_upload(std::shared_ptr<EncounterLog> encounter_log) override { this->queue_uploads({ std::move(encounter_log) }, false); };
+	void queue_upload(std::shared_ptr<EncounterLog> encounter_log, bool is_auto_upload) { this->queue_uploads({ std::move(encounter_log) }, is_auto_upload); }
+
+	void queue_uploads(const std::vector<std::shared_ptr<EncounterLog>>& encounter_logs) override { this->queue_uploads(encounter_logs, false); }
+	void queue_uploads(const std::vector<std::shared_ptr<EncounterLog>>& encounter_logs, bool is_auto_upload);
 
 	void process_auto_upload(std::shared_ptr<EncounterLog> encounter_log) override;
 
@@ -1,5 +1,8 @@
+#include "change_bus.h"
 #include "elite_insights.h"
+#include "encounter_statistics.h"
 #include "logger.h"
+#include "report_store.h"
 #include "settings.h"
 #include "wingman_uploader.h"
 
@@ -8,7 +11,8 @@
 
 namespace global { std::unique_ptr<EliteInsights> elite_insights = std::make_unique<EliteInsights>(); }
 
-#define LOG(message, log_level) global::logger->write(message, log_level, LogSource::EliteInsights)
+#define LOG(message, log_level) do { if (Logger::is_enabled(log_level)) global::logger->write(message, log_level, LogSource::EliteInsights); } while (0)
+#define LOG_FORMAT(log_level, ...) global::logger->write_format(log_level, LogSource::EliteInsights, __VA_ARGS__)
 
 bool EliteInsights::initialize(std::filesystem::path installation_directory, std::filesystem::path output_directory)
 {
@@ -26,6 +30,8 @@ bool EliteInsights::initialize(std::filesystem::path installation_directory, std
 	this->installation_directory = installation_directory;
 	this->output_directory = output_directory;
 
+	ReportData::output_directory = output_directory;
+
 	this->executable_file = this->installation_directory / "GuildWars2EliteInsights-CLI.exe";
 	this->settings_file = this->installation_directory / "Settings" / "settings.conf";
 	this->version_file = this->installation_directory / ".version";
@@ -82,7 +88,21 @@ void EliteInsights::release()
 		this->parser_thread.join();
 }
 
-void EliteInsights::queue_encounter_log(std::shared_ptr<EncounterLog> encounter_log)
+void EliteInsights::queue_reparse(std::shared_ptr<EncounterLog> encounter_log)
+{
+	{
+		std::unique_lock log_lock(encounter_log->mutex);
+
+		if (encounter_log->parse_status != ParseStatus::PARSED)
+			return;
+
+		encounter_log->parse_status = ParseStatus::UNPARSED;
+	}
+
+	this->queue_encounter_log(encounter_log);
+}
+
+void EliteInsights::queue_encounter_logs(const std::vector<std::shared_ptr<EncounterLog>>& encounter_logs)
 {
 	if (!this->is_initialized())
 	{
@@ -90,23 +110,40 @@ void EliteInsights::queue_encounter_log(std::shared_ptr<EncounterLog> encounter_
 		return;
 	}
 
-	std::unique_lock log_lock(encounter_log->mutex);
+	std::vector<std::shared_ptr<EncounterLog>> queued_logs;
 
-	if (encounter_log->parse_status != ParseStatus::UNPARSED)
+	for (const auto& encounter_log : encounter_logs)
 	{
-		LOG("Encounter log has invalid parse state", LogLevel::Warning);
-		return;
-	}
+		std::unique_lock log_lock(encounter_log->mutex);
 
-	encounter_log->parse_status = ParseStatus::QUEUED;
+		if (encounter_log->parse_status != ParseStatus::UNPARSED)
+		{
+			LOG("Encounter log has invalid parse state", LogLevel::Warning);
+			continue;
+		}
+
+		encounter_log->parse_status = ParseStatus::QUEUED;
+
+		LOG_FORMAT(LogLevel::Info, "Queued encounter log for parsing: {}", encounter_log->id);
+
+		log_lock.unlock();
 
-	LOG("Queued encounter log for parsing: " + encounter_log->id, LogLevel::Info);
+		global::change_bus->post(encounter_log, LogChange::PARSE_STATUS);
 
-	log_lock.unlock();
+		global::logger->trace(TraceEvent::PARSE_QUEUED, LogSource::EliteInsights, hash_trace_id(encounter_log->id));
+
+		queued_logs.push_back(encounter_log);
+	}
+
+	if (queued_logs.empty())
+		return;
 
 	{
 		std::unique_lock parser_queue_lock(this->parser_queue_mutex);
-		this->parser_queue.push(encounter_log);
+
+		for (auto& encounter_log : queued_logs)
+			this->parser_queue.push(std::move(encounter_log));
+
 		this->parser_cv.notify_one();
 	}
 }
@@ -493,14 +530,25 @@ void EliteInsights::run_parser()
 		log->parse_status = ParseStatus::PARSING;
 
 		auto evtc_file_path = log->evtc_data.evtc_file_path;
+		const auto log_id_hash = hash_trace_id(log->id);
 
 		log_lock.unlock();
 
+		global::change_bus->post(log, LogChange::PARSE_STATUS);
+
 		EncounterData encounter_data;
 		ReportData report_data;
 
+		global::logger->trace(TraceEvent::PARSE_STARTED, LogSource::EliteInsights, log_id_hash);
+		const auto parse_start_time = std::chrono::steady_clock::now();
+
 		const auto parse_status = this->parse(evtc_file_path, encounter_data, report_data);
 
+		global::logger->trace(TraceEvent::PARSE_FINISHED, LogSource::EliteInsights, log_id_hash, static_cast<int64_t>(parse_status), std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - parse_start_time).count());
+
+		if (parse_status == ParseStatus::PARSED)
+			global::report_store->add(report_data);
+
 		log_lock.lock();
 
 		log->parse_status = parse_status;
@@ -509,10 +557,18 @@ void EliteInsights::run_parser()
 		log->update_view();
 
 		if (log->parse_status == ParseStatus::PARSED)
-			LOG("Successfully parsed: " + log->id, LogLevel::Info);
+			LOG_FORMAT(LogLevel::Info, "Successfully parsed: {}", log->id);
+
+		const auto record_statistics = parse_status == ParseStatus::PARSED && !std::exchange(log->statistics_recorded, true);
+		const auto trigger_id = log->evtc_data.trigger_id;
 
 		log_lock.unlock();
 
+		if (record_statistics)
+			global::encounter_statistics->record(encounter_data, trigger_id);
+
+		global::change_bus->post(log, LogChange::PARSE_STATUS);
+
 		if (parse_status == ParseStatus::PARSED)
 			global::wingman_uploader->process_auto_upload(log);
 	}
@@ -606,22 +662,28 @@ ParseStatus EliteInsights::parse(std::filesystem::path evtc_file_path, Encounter
 
 	std::regex json_regex(R"(Generated:\s*(.+\.json)\s*)");
 
+	// reports are only referenced by their shared file stem, the paths are derived from the output directory
 	if (std::regex_search(output, matches, json_regex) && matches.size() > 1)
-		report_data.json_file_path = std::filesystem::path(matches[1].str());
+		report_data.report_key = std::filesystem::path(matches[1].str()).stem().string();
 
 	std::regex html_regex(R"(Generated:\s*(.+\.html)\s*)");
 
-	if (std::regex_search(output, matches, html_regex) && matches.size() > 1)
-		report_data.html_file_path = std::filesystem::path(matches[1].str());
+	if (std::regex_search(output, matches, html_regex) && matches.size() > 1 && std::filesystem::path(matches[1].str()).stem().string() != report_data.report_key)
+	{
+		_LOG("Elite Insights generated reports with different names", LogLevel::Warning);
+		report_data.report_key.clear();
+	}
 
 	std::regex success_regex(R"(Parsing Successful)");
 	std::regex failure_regex(R"(Parsing Failure)");
 
 	auto valid_output = std::regex_search(output, success_regex) && !std::regex_search(output, failure_regex);
 
-	if (valid_output && std::filesystem::exists(report_data.json_file_path) && std::filesystem::exists(report_data.html_file_path))
+	const auto json_file_path = report_data.get_json_file_path();
+
+	if (valid_output && std::filesystem::exists(json_file_path) && std::filesystem::exists(report_data.get_html_file_path()))
 	{
-		std::ifstream json_file(report_data.json_file_path);
+		std::ifstream json_file(json_file_path);
 
 		if (json_file.is_open())
 		{
@@ -698,7 +760,7 @@ ParseStatus EliteInsights::parse(std::filesystem::path evtc_file_path, Encounter
 			}
 			catch (const nlohmann::json::exception& e)
 			{
-				_LOG("Failed to parse json file: " + report_data.json_file_path.string() + " (" + std::string(e.what()) + ")", LogLevel::Warning);
+				_LOG("Failed to parse json file: " + json_file_path.string() + " (" + std::string(e.what()) + ")", LogLevel::Warning);
 				return ParseStatus::FAILED;
 			}
 
@@ -708,7 +770,7 @@ ParseStatus EliteInsights::parse(std::filesystem::path evtc_file_path, Encounter
 		}
 		else
 		{
-			_LOG("Failed to open json file: " + report_data.json_file_path.string(), LogLevel::Warning);
+			_LOG("Failed to open json file: " + json_file_path.string(), LogLevel::Warning);
 			return ParseStatus::FAILED;
 		}
 	}
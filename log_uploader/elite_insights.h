@@ -11,6 +11,7 @@
 #include <thread>
 #include <condition_variable>
 #include <queue>
+#include <vector>
 
 #include <cpr/cpr.h>
 
@@ -88,7 +89,14 @@ public:
 	bool initialize(std::filesystem::path installation_directory, std::filesystem::path output_directory);
 	void release() override;
 
-	void queue_encounter_log(std::shared_ptr<EncounterLog> encounter_log);
+	void queue_encounter_log(std::shared_ptr<EncounterLog> encounter_log) { this->queue_encounter_logs({ std::move(encounter_log) }); }
+
+	// queues the logs as a single job, the parser queue is locked and the parser thread woken once
+	void queue_encounter_logs(const std::vector<std::shared_ptr<EncounterLog>>& encounter_logs);
+
+	// parses a log again whose reports were removed to stay within the disk budget
+	void queue_reparse(std::shared_ptr<EncounterLog> encounter_log);
+
 	void process_auto_parse(std::shared_ptr<EncounterLog> encounter_log);
 private:
 
@@ -1,8 +1,12 @@
 #include "encounter_log.h"
 #include "evtc.h"
+#include "file_reclaimer.h"
+#include "report_store.h"
 
 #include <algorithm>
 #include <map>
+#include <type_traits>
+#include <utility>
 
 namespace global
 {
@@ -109,6 +113,39 @@ namespace global
 		{TriggerID::DregShark, "Dreg Shark"},
 		{TriggerID::HeartsAndMinds, "Hearts and Minds"},
 	};
+
+	const TriggerCategories categorized_triggers =
+	{
+		{"Raids", {
+			{"Spirit Vale", {TriggerID::ValeGuardian, TriggerID::SpiritRace, TriggerID::Gorseval, TriggerID::SabethaTheSaboteur}},
+			{"Salvation Pass", {TriggerID::Slothasor, TriggerID::BanditTrio, TriggerID::MatthiasGabrel}},
+			{"Stronghold of the Faithful", {TriggerID::SiegeTheStronghold, TriggerID::KeepConstruct, TriggerID::TwistedCastle, TriggerID::Xera}},
+			{"Bastion of the Penitent", {TriggerID::CairnTheIndomitable, TriggerID::MursaatOverseer, TriggerID::Samarog, TriggerID::Deimos}},
+			{"Hall of Chains", {TriggerID::SoullessHorror, TriggerID::RiverOfSouls, TriggerID::StatueOfIce, TriggerID::StatueOfDarkness, TriggerID::StatueOfDeath, TriggerID::Dhuum}},
+			{"Mythwright Gambit", {TriggerID::ConjuredAmalgamate, TriggerID::TwinLargos, TriggerID::Qadim}},
+			{"The Key of Ahdashim", {TriggerID::CardinalAdina, TriggerID::CardinalSabir, TriggerID::QadimThePeerless}},
+			{"Mount Balrior", {TriggerID::DecimaTheStormsinger, TriggerID::GreerTheBlightbringer, TriggerID::UraTheSteamshrieker}},
+		}},
+		{"Fractals", {
+			{"Nightmare", {TriggerID::MAMA, TriggerID::SiaxTheCorrupted, TriggerID::EnsolyssOfTheEndlessTorment}},
+			{"Shattered Observatory", {TriggerID::SkorvaldTheShattered, TriggerID::Artsariiv, TriggerID::Arkk}},
+			{"Sunqua Peak", {TriggerID::AiKeeperOfThePeak}},
+			{"Silent Surf", {TriggerID::Kanaxai, TriggerID::KanaxaiChallengeMode}},
+			{"Lonely Tower", {TriggerID::Eparch}},
+		}},
+		{"Strike Missions", {
+			{"Core", {TriggerID::OldLionsCourt, TriggerID::OldLionsCourtChallengeMode}},
+			{"The Icebrood Saga", {TriggerID::IcebroodConstruct, TriggerID::SuperKodanBrothers, TriggerID::FraenirOfJormag, TriggerID::Boneskinner, TriggerID::WhisperOfJormag}},
+			{"End of Dragons", {TriggerID::AetherbladeHideout, TriggerID::XunlaiJadeJunkyard, TriggerID::KainengOverlook, TriggerID::KainengOverlookChallengeMode, TriggerID::HarvestTemple}},
+			{"Secrets of the Obscure", {TriggerID::CosmicObservatory, TriggerID::TempleOfFebe}},
+		}},
+		{"Other", {
+			{"Convergences", {TriggerID::DemonKnight, TriggerID::Sorrow, TriggerID::Dreadwing, TriggerID::HellSister, TriggerID::Umbriel}},
+			{"Special Forces Training Area", {TriggerID::StandardKittyGolem, TriggerID::MediumKittyGolem, TriggerID::LargeKittyGolem}},
+			{"World vs World", {TriggerID::WorldVsWorld}},
+			{"Uncategorized", {TriggerID::Freezie, TriggerID::DregShark, TriggerID::HeartsAndMinds}},
+		}},
+	};
 }
 
 EncounterLog::EncounterLog(EVTCData evtc_data)
@@ -135,13 +172,25 @@ EncounterLog::EncounterLog(EVTCData evtc_data)
 	this->update_view();
 }
 
+EncounterLog::EncounterLog(EncounterLogData encounter_log_data) : EncounterLogData(std::move(encounter_log_data))
+{
+	// rebuild the view in the same order it was built originally
+	const auto parse_status = std::exchange(this->parse_status, ParseStatus::UNPARSED);
+	this->update_view();
+
+	this->parse_status = parse_status;
+	this->update_view();
+}
+
 EncounterLog::~EncounterLog()
 {
-	if (std::filesystem::exists(this->report_data.html_file_path))
-		std::filesystem::remove(this->report_data.html_file_path);
+	// the last reference can be dropped on the render thread, deletions are left to the reclaimer
+	global::file_reclaimer->reclaim(this->evtc_data.compressed_file_path);
 
-	if (std::filesystem::exists(this->report_data.json_file_path))
-		std::filesystem::remove(this->report_data.json_file_path);
+	if (this->retain_files)
+		return;
+
+	global::report_store->remove(this->report_data);
 }
 
 void EncounterLogData::update_view()
@@ -192,4 +241,36 @@ void EncounterLogData::update_view()
 
 		update_duration();
 	}
+}
+
+auto EncounterLogData::get_memory_usage() const -> size_t
+{
+	const auto string_usage = [](const auto& string) -> size_t
+		{
+			using string_type = std::remove_cvref_t<decltype(string)>;
+
+			// only strings exceeding the small string buffer allocate
+			return string.capacity() > string_type().capacity() ? (string.capacity() + 1) * sizeof(typename string_type::value_type) : 0;
+		};
+
+	const auto optional_usage = [&string_usage](const std::optional<std::string>& string) -> size_t
+		{
+			return string.has_value() ? string_usage(string.value()) : 0;
+		};
+
+	size_t bytes = sizeof(EncounterLogData);
+
+	bytes += string_usage(this->id);
+	bytes += string_usage(this->evtc_data.evtc_file_path.native());
+	bytes += string_usage(this->evtc_data.compressed_file_path.native());
+	bytes += string_usage(this->report_data.report_key);
+	bytes += optional_usage(this->report_data.error_message);
+	bytes += string_usage(this->dps_report_upload.url);
+	bytes += string_usage(this->dps_report_upload.id);
+	bytes += string_usage(this->dps_report_upload.user_token);
+	bytes += optional_usage(this->dps_report_upload.error_message);
+	bytes += string_usage(this->wingman_upload.url);
+	bytes += optional_usage(this->wingman_upload.error_message);
+
+	return bytes;
 }
\ No newline at end of file
@@ -1,14 +1,19 @@
 #pragma once
 
 #include "evtc_parser.h"
+#include "string_interner.h"
 
 #include <filesystem>
 #include <shared_mutex>
 #include <string>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <mutex>
 #include <optional>
 #include <map>
+#include <utility>
+#include <vector>
 
 enum EncounterType
 {
@@ -88,9 +93,9 @@ public:
 class EncounterData
 {
 public:
-	std::string encounter_name = "";
+	InternedString encounter_name;
 
-	std::string account_name = "";
+	InternedString account_name;
 
 	int duration_ms = 0;
 
@@ -109,10 +114,40 @@ public:
 class ReportData
 {
 public:
-	std::filesystem::path html_file_path;
-	std::filesystem::path json_file_path;
+	// set once by the parser, all reports are stored below it
+	static inline std::filesystem::path output_directory;
+
+	// shared file stem of the generated .html and .json report
+	std::string report_key;
 
 	std::optional<std::string> error_message;
+
+	auto get_html_file_path() const -> std::filesystem::path { return this->get_file_path(".html"); }
+	auto get_json_file_path() const -> std::filesystem::path { return this->get_file_path(".json"); }
+
+private:
+	auto get_file_path(const char* extension) const -> std::filesystem::path
+	{
+		if (this->report_key.empty())
+			return {};
+
+		return output_directory / std::filesystem::path(this->report_key + extension);
+	}
+};
+
+class TransferProgress
+{
+public:
+	uint64_t bytes_sent = 0;
+	uint64_t bytes_total = 0;
+
+	double rate = 0.; // bytes per second
+	std::chrono::seconds eta{};
+
+	auto get_fraction() const -> float
+	{
+		return this->bytes_total ? static_cast<float>(static_cast<double>(this->bytes_sent) / static_cast<double>(this->bytes_total)) : 0.f;
+	}
 };
 
 class EncounterLogView
@@ -120,10 +155,15 @@ class EncounterLogView
 public:
 	bool selected = false;
 
-	std::string name = "";
-	std::string time = "";
-	std::string result = "";
-	std::string duration = "";
+	InternedString name;
+	FixedString<8> time;
+	FixedString<15> result;
+	FixedString<23> duration;
+
+	TransferProgress dps_report_progress;
+	TransferProgress wingman_progress;
+
+	bool opening_report = false; // the report store restores and opens the report on its thread
 };
 
 using EncounterLogID = std::string;
@@ -132,6 +172,9 @@ class EncounterLogData
 {
 public:
 	EncounterLogID id = "";
+	uint32_t sequence = 0; // position in the order logs were added during this session
+	uint32_t session_id = 0; // see SessionTracker, 0 until the log is added
+	bool statistics_recorded = false; // set with the first successful parse, reparsing does not count the log again
 
 	EVTCData evtc_data = EVTCData();
 	ParseStatus parse_status = ParseStatus::UNPARSED;
@@ -142,12 +185,16 @@ public:
 	WingmanUpload wingman_upload = WingmanUpload();
 
 	void update_view();
+
+	// approximate bytes held by this record including its heap allocations, interned strings are accounted for by the interner
+	auto get_memory_usage() const -> size_t;
 };
 
 class EncounterLog : public EncounterLogData
 {
 public:
 	EncounterLog(EVTCData evtc_data);
+	EncounterLog(EncounterLogData encounter_log_data); // restored from the log catalog
 	~EncounterLog();
 
 	auto get_data() -> EncounterLogData
@@ -162,9 +209,22 @@ public:
 	}
 
 	mutable std::shared_mutex mutex;
+
+	// bumped on every change posted to the change bus
+	std::atomic<uint64_t> generation = 0;
+
+	// generation the published row was copied at, guarded by the log manager publish mutex
+	uint64_t published_generation = 0;
+
+	// set when the log is evicted to the catalog, its files are still referenced there
+	std::atomic<bool> retain_files = false;
 };
 
+// main category, e.g. raids, with its sub categories, e.g. raid wings, in display order
+using TriggerCategories = std::vector<std::pair<std::string, std::vector<std::pair<std::string, std::vector<TriggerID>>>>>;
+
 namespace global
 {
 	extern const std::map<TriggerID, std::string> trigger_id_encounter_name_map;
+	extern const TriggerCategories categorized_triggers;
 }
\ No newline at end of file
@@ -0,0 +1,212 @@
+#include "encounter_statistics.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <fstream>
+#include <unordered_map>
+
+namespace global { std::unique_ptr<EncounterStatistics> encounter_statistics = std::make_unique<EncounterStatistics>(); }
+
+#define LOG(message, log_level) do { if (Logger::is_enabled(log_level)) global::logger->write(message, log_level, LogSource::EncounterStatistics); } while (0)
+#define LOG_FORMAT(log_level, ...) global::logger->write_format(log_level, LogSource::EncounterStatistics, __VA_ARGS__)
+
+void EncounterStatistics::initialize(std::filesystem::path statistics_file_path)
+{
+	std::lock_guard initialization_lock(this->initialization_mutex);
+
+	if (this->is_initialized())
+		return;
+
+	std::lock_guard lock(this->mutex);
+
+	this->statistics_file_path = std::move(statistics_file_path);
+
+	if (std::filesystem::exists(this->statistics_file_path) && !this->load())
+		LOG("Starting with empty statistics", LogLevel::Warning);
+
+	this->snapshot.reset();
+
+	this->initialized = true;
+}
+
+void EncounterStatistics::release()
+{
+	std::lock_guard initialization_lock(this->initialization_mutex);
+
+	if (!this->initialized)
+		return;
+
+	this->initialized = false;
+
+	std::lock_guard lock(this->mutex);
+
+	this->statistics.clear();
+	this->snapshot.reset();
+}
+
+void EncounterStatistics::record(const EncounterData& encounter_data, TriggerID trigger_id)
+{
+	if (!this->is_initialized())
+		return;
+
+	if (trigger_id == TriggerID::Invalid)
+		return;
+
+	std::unique_lock lock(this->mutex);
+
+	auto& statistic = this->statistics[{ trigger_id, encounter_data.difficulty }];
+
+	if (!encounter_data.encounter_name.empty())
+		statistic.encounter_name = encounter_data.encounter_name.str();
+
+	statistic.attempts++;
+
+	if (encounter_data.success)
+	{
+		statistic.kills++;
+
+		if (statistic.best_kill_ms == 0 || encounter_data.duration_ms < statistic.best_kill_ms)
+			statistic.best_kill_ms = encounter_data.duration_ms;
+
+		statistic.median_kill_ms.add(static_cast<double>(encounter_data.duration_ms));
+	}
+
+	this->snapshot.reset();
+
+	// a few hundred entries at most, written right away so a crash does not lose any kills
+	const auto content = this->serialize();
+	const auto content_version = ++this->version;
+
+	// the render thread takes the mutex for every snapshot, the file is written without it
+	lock.unlock();
+
+	if (!this->save(content, content_version))
+		LOG("Failed to save statistics to: " + this->statistics_file_path.string(), LogLevel::Error);
+}
+
+auto EncounterStatistics::get_snapshot() -> std::shared_ptr<const std::vector<EncounterStatisticRow>>
+{
+	static const auto category_ranks = []()
+		{
+			std::unordered_map<TriggerID, size_t> ranks;
+
+			for (const auto& [category, sub_categories] : global::categorized_triggers)
+				for (const auto& [sub_category, trigger_ids] : sub_categories)
+					for (const auto trigger_id : trigger_ids)
+						ranks.emplace(trigger_id, ranks.size());
+
+			return ranks;
+		}();
+
+	std::lock_guard lock(this->mutex);
+
+	if (this->snapshot)
+		return this->snapshot;
+
+	auto rows = std::make_shared<std::vector<EncounterStatisticRow>>(this->statistics.begin(), this->statistics.end());
+
+	auto get_rank = [](TriggerID trigger_id)
+		{
+			auto it = category_ranks.find(trigger_id);
+			return it != category_ranks.end() ? it->second : category_ranks.size();
+		};
+
+	std::stable_sort(rows->begin(), rows->end(), [&get_rank](const EncounterStatisticRow& a, const EncounterStatisticRow& b)
+		{
+			return get_rank(a.first.first) < get_rank(b.first.first);
+		});
+
+	this->snapshot = std::move(rows);
+
+	return this->snapshot;
+}
+
+bool EncounterStatistics::load()
+{
+	std::ifstream file(this->statistics_file_path);
+
+	if (!file.is_open())
+	{
+		LOG("Failed to open statistics file for reading: " + this->statistics_file_path.string(), LogLevel::Error);
+		return false;
+	}
+
+	try
+	{
+		nlohmann::json json;
+		file >> json;
+
+		std::map<EncounterStatisticKey, EncounterStatistic> statistics;
+
+		for (const auto& entry : json.at("encounters"))
+		{
+			const auto trigger_id = static_cast<TriggerID>(entry.at("trigger_id").get<int>());
+			const auto difficulty = static_cast<EncounterDifficulty>(entry.at("difficulty").get<int>());
+
+			statistics[{ trigger_id, difficulty }] = entry.at("statistic").get<EncounterStatistic>();
+		}
+
+		this->statistics = std::move(statistics);
+
+		LOG("Statistics loaded for " + std::to_string(this->statistics.size()) + " encounters", LogLevel::Info);
+
+		return true;
+	}
+	catch (const std::exception& e)
+	{
+		LOG("Failed to load statistics from file: \"" + this->statistics_file_path.string() + "\" Exception: " + std::string(e.what()), LogLevel::Error);
+	}
+
+	return false;
+}
+
+auto EncounterStatistics::serialize() const -> std::string
+{
+	nlohmann::json encounters = nlohmann::json::array();
+
+	for (const auto& [key, statistic] : this->statistics)
+		encounters.push_back({ { "trigger_id", static_cast<int>(key.first) }, { "difficulty", static_cast<int>(key.second) }, { "statistic", statistic } });
+
+	return nlohmann::json{ { "encounters", encounters } }.dump();
+}
+
+bool EncounterStatistics::save(const std::string& content, uint64_t content_version)
+{
+	if (this->statistics_file_path.empty())
+		return false;
+
+	std::lock_guard save_lock(this->save_mutex);
+
+	// logs parsed at the same time can arrive here out of order, a newer state is already on disk
+	if (content_version <= this->saved_version)
+		return true;
+
+	auto temporary_file_path = this->statistics_file_path;
+	temporary_file_path += ".tmp";
+
+	{
+		std::ofstream file(temporary_file_path, std::ios::trunc);
+
+		if (!file.is_open())
+			return false;
+
+		file << content;
+
+		if (!file)
+			return false;
+	}
+
+	// replaced in one step, a crash while writing leaves the previous file intact
+	std::error_code error;
+	std::filesystem::rename(temporary_file_path, this->statistics_file_path, error);
+
+	if (error)
+		return false;
+
+	this->saved_version = content_version;
+
+	return true;
+}
+
+#undef LOG
+#undef LOG_FORMAT
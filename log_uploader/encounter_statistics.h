@@ -0,0 +1,71 @@
+#pragma once
+
+#include "encounter_log.h"
+#include "module.h"
+#include "streaming_quantile.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+class EncounterStatistic
+{
+public:
+	std::string encounter_name; // latest name reported by Elite Insights
+
+	uint32_t attempts = 0;
+	uint32_t kills = 0;
+
+	int best_kill_ms = 0; // 0 until the first kill
+	StreamingQuantile median_kill_ms = StreamingQuantile(0.5);
+
+	auto get_success_rate() const -> float { return this->attempts ? static_cast<float>(this->kills) / static_cast<float>(this->attempts) : 0.f; }
+
+	NLOHMANN_DEFINE_TYPE_INTRUSIVE(EncounterStatistic, encounter_name, attempts, kills, best_kill_ms, median_kill_ms)
+};
+
+using EncounterStatisticKey = std::pair<TriggerID, EncounterDifficulty>;
+using EncounterStatisticRow = std::pair<EncounterStatisticKey, EncounterStatistic>;
+
+// running statistics per encounter and difficulty, every parsed log is recorded once and history is never rescanned
+class EncounterStatistics : public Module
+{
+public:
+	EncounterStatistics() {}
+	~EncounterStatistics() {}
+
+	void initialize(std::filesystem::path statistics_file_path);
+	void release() override;
+
+	// called once per log when its first parse succeeded
+	void record(const EncounterData& encounter_data, TriggerID trigger_id);
+
+	// ordered by category like the encounter selection, rebuilt only after a change
+	auto get_snapshot() -> std::shared_ptr<const std::vector<EncounterStatisticRow>>;
+
+private:
+	std::mutex mutex;
+
+	std::filesystem::path statistics_file_path;
+
+	std::map<EncounterStatisticKey, EncounterStatistic> statistics;
+	std::shared_ptr<const std::vector<EncounterStatisticRow>> snapshot;
+	uint64_t version = 0; // bumped on every recorded log
+
+	// serializes the file writes, never taken by the render thread
+	std::mutex save_mutex;
+	uint64_t saved_version = 0;
+
+	bool load();
+	auto serialize() const -> std::string;
+	bool save(const std::string& content, uint64_t content_version);
+};
+
+namespace global { extern std::unique_ptr<EncounterStatistics> encounter_statistics; }
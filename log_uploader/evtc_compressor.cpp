@@ -0,0 +1,173 @@
+#include "bandwidth_limiter.h"
+#include "evtc_compressor.h"
+#include "logger.h"
+#include "settings.h"
+
+#include <chrono>
+#include <format>
+#include <functional>
+
+#include <miniz/miniz.h>
+
+namespace global { std::unique_ptr<EVTCCompressor> evtc_compressor = std::make_unique<EVTCCompressor>(); }
+
+#define LOG(message, log_level) do { if (Logger::is_enabled(log_level)) global::logger->write(message, log_level, LogSource::EVTCCompressor); } while (0)
+#define LOG_FORMAT(log_level, ...) global::logger->write_format(log_level, LogSource::EVTCCompressor, __VA_ARGS__)
+
+void EVTCCompressor::initialize(std::filesystem::path output_directory)
+{
+	if (output_directory.empty())
+		throw std::invalid_argument("output_directory is empty");
+
+	std::lock_guard lock(this->mutex);
+
+	this->output_directory = std::move(output_directory);
+}
+
+auto EVTCCompressor::prepare_upload(std::shared_ptr<EncounterLog> encounter_log) -> UploadFile
+{
+	std::unique_lock log_lock(encounter_log->mutex);
+
+	const auto evtc_file_path = encounter_log->evtc_data.evtc_file_path;
+	const auto id = encounter_log->id;
+
+	auto upload_file = UploadFile{ evtc_file_path, evtc_file_path.filename().string() };
+
+	if (evtc_file_path.extension() != ".evtc" || !GET_SETTING(bandwidth.compress_evtc))
+		return upload_file;
+
+	const auto compressed_upload_file = UploadFile{ encounter_log->evtc_data.compressed_file_path, evtc_file_path.stem().string() + ".zevtc" };
+
+	log_lock.unlock();
+
+	std::unique_lock lock(this->mutex);
+
+	// the same log is prepared by the check and the upload stage, the second one waits for the first compression
+	this->cv.wait(lock, [this, &id] { return !this->compressing_logs.contains(id); });
+
+	// read again, the stage that was waited for may have compressed the log
+	log_lock.lock();
+	const auto compressed_file_path = encounter_log->evtc_data.compressed_file_path;
+	log_lock.unlock();
+
+	if (!compressed_file_path.empty() && std::filesystem::exists(compressed_file_path))
+		return UploadFile{ compressed_file_path, compressed_upload_file.file_name };
+
+	if (this->output_directory.empty())
+		return upload_file;
+
+	const auto output_directory = this->output_directory;
+
+	std::error_code error_code;
+
+	const auto file_size = std::filesystem::file_size(evtc_file_path, error_code);
+
+	if (error_code)
+		return upload_file;
+
+	const auto link_throughput = global::bandwidth_limiter->get_estimated_throughput();
+
+	if (!this->should_compress(file_size, link_throughput))
+	{
+		LOG_FORMAT(LogLevel::Debug, "Skipping compression of {}, estimated transfer time savings are below the compression time", id);
+		return upload_file;
+	}
+
+	this->compressing_logs.insert(id);
+
+	lock.unlock();
+
+	const auto output_file_path = [&]() -> std::filesystem::path
+		{
+			if (!std::filesystem::exists(output_directory, error_code))
+				std::filesystem::create_directories(output_directory, error_code);
+
+			// unique on disk, the upload keeps the original file name
+			auto output_file_path = output_directory / std::format("{}_{:016x}.zevtc", evtc_file_path.stem().string(), std::hash<std::string>{}(id));
+
+			const auto start_time = std::chrono::steady_clock::now();
+
+			if (!this->compress(evtc_file_path, output_file_path))
+			{
+				std::filesystem::remove(output_file_path, error_code);
+				LOG("Failed to compress " + id + ", uploading raw evtc file", LogLevel::Warning);
+				return {};
+			}
+
+			const auto compression_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+			const auto compressed_size = std::filesystem::file_size(output_file_path, error_code);
+
+			if (error_code || file_size == 0)
+				return {};
+
+			const auto speed = static_cast<double>(file_size) / (std::max)(compression_time, 0.001);
+			const auto ratio = static_cast<double>(compressed_size) / static_cast<double>(file_size);
+
+			{
+				std::lock_guard estimate_lock(this->mutex);
+
+				const auto smoothing = this->compression_speed == 0. ? 1. : .3;
+
+				this->compression_speed += smoothing * (speed - this->compression_speed);
+				this->compression_ratio += smoothing * (ratio - this->compression_ratio);
+			}
+
+			if (link_throughput > 0.)
+			{
+				const auto transfer_time_saved = static_cast<double>(file_size - (std::min)(compressed_size, file_size)) / link_throughput;
+
+				LOG(std::format("Compressed {} ({:.2f} MiB -> {:.2f} MiB) in {:.0f} ms, saves an estimated {:.0f} ms of transfer time at {:.0f} KiB/s", id, file_size / 1048576., compressed_size / 1048576., compression_time * 1000., transfer_time_saved * 1000., link_throughput / 1024.), LogLevel::Info);
+			}
+			else
+				LOG(std::format("Compressed {} ({:.2f} MiB -> {:.2f} MiB) in {:.0f} ms", id, file_size / 1048576., compressed_size / 1048576., compression_time * 1000.), LogLevel::Info);
+
+			log_lock.lock();
+			encounter_log->evtc_data.compressed_file_path = output_file_path;
+			log_lock.unlock();
+
+			return output_file_path;
+		}();
+
+	lock.lock();
+	this->compressing_logs.erase(id);
+	lock.unlock();
+
+	this->cv.notify_all();
+
+	if (output_file_path.empty())
+		return upload_file;
+
+	return UploadFile{ output_file_path, compressed_upload_file.file_name };
+}
+
+bool EVTCCompressor::should_compress(uint64_t file_size, double link_throughput)
+{
+	// nothing measured yet, compression is the safe default for evtc files
+	if (this->compression_speed <= 0. || link_throughput <= 0.)
+		return true;
+
+	const auto compression_time = static_cast<double>(file_size) / this->compression_speed;
+	const auto transfer_time_saved = static_cast<double>(file_size) * (1. - this->compression_ratio) / link_throughput;
+
+	return compression_time < transfer_time_saved;
+}
+
+bool EVTCCompressor::compress(const std::filesystem::path& evtc_file_path, const std::filesystem::path& output_file_path)
+{
+	mz_zip_archive zip_archive{};
+
+	mz_zip_zero_struct(&zip_archive);
+
+	if (!mz_zip_writer_init_file(&zip_archive, output_file_path.string().c_str(), 0))
+		return false;
+
+	// evtc data compresses well even at the fastest level, the time is better spent on the transfer
+	auto result = mz_zip_writer_add_file(&zip_archive, evtc_file_path.stem().string().c_str(), evtc_file_path.string().c_str(), nullptr, 0, MZ_BEST_SPEED) &&
+		mz_zip_writer_finalize_archive(&zip_archive);
+
+	return mz_zip_writer_end(&zip_archive) && result;
+}
+
+#undef LOG
+#undef LOG_FORMAT
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "encounter_log.h"
+
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+class UploadFile
+{
+public:
+	std::filesystem::path file_path;
+	std::string file_name; // name reported to the upload endpoint
+};
+
+// packs raw .evtc logs into .zevtc before they are uploaded
+class EVTCCompressor
+{
+public:
+	EVTCCompressor() {}
+	~EVTCCompressor() {}
+
+	void initialize(std::filesystem::path output_directory);
+
+	// returns the file that should be uploaded for the log, compresses raw .evtc files on first use
+	auto prepare_upload(std::shared_ptr<EncounterLog> encounter_log) -> UploadFile;
+
+private:
+	std::mutex mutex;
+	std::condition_variable cv;
+
+	std::filesystem::path output_directory;
+
+	// ids of the logs being compressed, other logs are compressed at the same time
+	std::unordered_set<std::string> compressing_logs;
+
+	// running averages of previous compressions, used to estimate whether compressing pays off
+	double compression_speed = 0.; // bytes per second
+	double compression_ratio = 0.; // compressed / raw size
+
+	bool should_compress(uint64_t file_size, double link_throughput);
+	bool compress(const std::filesystem::path& evtc_file_path, const std::filesystem::path& output_file_path);
+};
+
+namespace global { extern std::unique_ptr<EVTCCompressor> evtc_compressor; }
@@ -1,12 +1,101 @@
 #include "evtc_parser.h"
 
 #include <miniz/miniz.h>
+#include <cstring>
 #include <fstream>
 
 namespace global { std::unique_ptr<EVTCParser> evtc_parser = std::make_unique<EVTCParser>(); }
 
 //#define LOG(message, log_level) global::logger->write(message, log_level, LogSource::EVTCParser)
 
+namespace
+{
+	constexpr size_t header_size = 16;
+	constexpr size_t revision_offset = 12;
+
+	constexpr size_t agent_size = 96;
+	constexpr size_t agent_name_offset = 28;
+	constexpr size_t agent_name_size = 64;
+	constexpr size_t skill_size = 68;
+
+	constexpr size_t event_size = 64;
+	constexpr size_t event_src_agent_offset = 8;
+	constexpr size_t event_statechange_offset = 56;
+	constexpr uint8_t statechange_pov = 13;
+
+	template <typename T>
+	auto read_value(const std::vector<uint8_t>& data, size_t offset) -> T
+	{
+		T value;
+		std::memcpy(&value, data.data() + offset, sizeof(T));
+		return value;
+	}
+
+	// the account of the agent named by the pov state change, events of revision 0 logs use a different layout
+	auto read_pov_account_name(const std::vector<uint8_t>& data) -> std::string
+	{
+		if (data[revision_offset] != 1 || data.size() < header_size + sizeof(uint32_t))
+			return {};
+
+		auto index = header_size;
+
+		const auto agent_count = read_value<uint32_t>(data, index);
+		index += sizeof(uint32_t);
+
+		const auto agents_offset = index;
+
+		if ((data.size() - index) / agent_size < agent_count)
+			return {};
+
+		index += agent_count * agent_size;
+
+		if (data.size() - index < sizeof(uint32_t))
+			return {};
+
+		const auto skill_count = read_value<uint32_t>(data, index);
+		index += sizeof(uint32_t);
+
+		if ((data.size() - index) / skill_size < skill_count)
+			return {};
+
+		index += skill_count * skill_size;
+
+		// arcdps records the pov right after the log starts, the scan rarely goes past the first events
+		for (; data.size() - index >= event_size; index += event_size)
+		{
+			if (data[index + event_statechange_offset] != statechange_pov)
+				continue;
+
+			const auto address = read_value<uint64_t>(data, index + event_src_agent_offset);
+
+			for (size_t agent = agents_offset; agent < agents_offset + agent_count * agent_size; agent += agent_size)
+			{
+				if (read_value<uint64_t>(data, agent) != address)
+					continue;
+
+				// player names hold the character, the account and the subgroup separated by null characters
+				const auto name = reinterpret_cast<const char*>(data.data() + agent + agent_name_offset);
+				const auto character_length = strnlen(name, agent_name_size);
+
+				if (character_length + 1 >= agent_name_size)
+					return {};
+
+				const auto account = name + character_length + 1;
+				std::string account_name(account, strnlen(account, agent_name_size - character_length - 1));
+
+				if (!account_name.empty() && account_name.front() == ':')
+					account_name.erase(0, 1);
+
+				return account_name;
+			}
+
+			return {};
+		}
+
+		return {};
+	}
+}
+
 EVTCData EVTCParser::parse(const std::filesystem::path& evtc_file_path)
 {
 	EVTCData evtc_data;
@@ -84,6 +173,8 @@ EVTCData EVTCParser::parse(const std::filesystem::path& evtc_file_path)
 	evtc_data.trigger_id = *reinterpret_cast<TriggerID*>(file_data.data() + index);
 	index += sizeof(TriggerID);
 
+	evtc_data.account_name = read_pov_account_name(file_data);
+
 	return evtc_data;
 }
 
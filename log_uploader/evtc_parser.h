@@ -1,6 +1,7 @@
 #pragma once
 
 #include "evtc.h"
+#include "string_interner.h"
 
 #include <filesystem>
 #include <chrono>
@@ -10,8 +11,11 @@ class EVTCData
 {
 public:
 	std::filesystem::path evtc_file_path;
+	std::filesystem::path compressed_file_path; // .zevtc created for uploading raw .evtc files
 	std::chrono::system_clock::time_point time;
 	TriggerID trigger_id = TriggerID::Invalid;
+	uint32_t root = 0; // index of the monitored directory the log was found in
+	InternedString account_name; // of the player that recorded the log, empty when the log names no pov
 };
 
 class EVTCParser
@@ -0,0 +1,152 @@
+#include "file_reclaimer.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+
+namespace global { std::unique_ptr<FileReclaimer> file_reclaimer = std::make_unique<FileReclaimer>(); }
+
+#define LOG(message, log_level) do { if (Logger::is_enabled(log_level)) global::logger->write(message, log_level, LogSource::FileReclaimer); } while (0)
+#define LOG_FORMAT(log_level, ...) global::logger->write_format(log_level, LogSource::FileReclaimer, __VA_ARGS__)
+
+void FileReclaimer::initialize(std::filesystem::path data_directory)
+{
+	std::lock_guard initialization_lock(this->initialization_mutex);
+
+	if (this->is_initialized())
+		return;
+
+	this->data_directory = std::move(data_directory);
+
+	this->collect_orphans();
+
+	this->initialized = true;
+
+	this->reclaim_thread = std::thread(&FileReclaimer::run, this);
+}
+
+void FileReclaimer::release()
+{
+	std::lock_guard initialization_lock(this->initialization_mutex);
+
+	if (!this->initialized)
+		return;
+
+	{
+		std::lock_guard lock(this->mutex);
+		this->initialized = false;
+	}
+
+	this->cv.notify_all();
+
+	if (this->reclaim_thread.joinable())
+		this->reclaim_thread.join();
+
+	// the thread drains the queue before it exits, anything queued since is handled in place
+	std::vector<std::filesystem::path> remaining;
+
+	{
+		std::lock_guard lock(this->mutex);
+		remaining.swap(this->pending);
+	}
+
+	this->remove(remaining);
+}
+
+void FileReclaimer::reclaim(std::filesystem::path file_path)
+{
+	if (file_path.empty())
+		return;
+
+	{
+		std::lock_guard lock(this->mutex);
+
+		if (this->initialized)
+		{
+			this->pending.push_back(std::move(file_path));
+			this->cv.notify_one();
+			return;
+		}
+	}
+
+	this->remove({ file_path });
+}
+
+void FileReclaimer::collect_orphans()
+{
+	// logs are not restored across sessions, every report or compressed log still around was left by a crash or an evicted log
+	static const std::array<std::filesystem::path, 5> extensions = { ".html", ".json", ".zevtc", ".gz", ".tmp" };
+
+	// another game client can share the data directory, only files it has not written to recently are taken
+	constexpr auto orphan_age = std::chrono::hours(24);
+	const auto cutoff = std::filesystem::file_time_type::clock::now() - orphan_age;
+
+	std::error_code error;
+	std::vector<std::filesystem::path> orphans;
+
+	for (auto it = std::filesystem::directory_iterator(this->data_directory, error); !error && it != std::filesystem::directory_iterator(); it.increment(error))
+	{
+		if (!it->is_regular_file(error))
+			continue;
+
+		if (std::find(extensions.begin(), extensions.end(), it->path().extension()) == extensions.end())
+			continue;
+
+		std::error_code time_error;
+		const auto last_write_time = it->last_write_time(time_error);
+
+		if (!time_error && last_write_time < cutoff)
+			orphans.push_back(it->path());
+	}
+
+	if (orphans.empty())
+		return;
+
+	this->remove(orphans);
+
+	LOG("Removed " + std::to_string(orphans.size()) + " orphaned files from " + this->data_directory.string(), LogLevel::Info);
+}
+
+void FileReclaimer::remove(const std::vector<std::filesystem::path>& file_paths)
+{
+	for (const auto& file_path : file_paths)
+	{
+		std::error_code error;
+
+		// remove reports a missing file as false without an error
+		if (!std::filesystem::remove(file_path, error) && error)
+			LOG("Failed to remove " + file_path.string() + ": " + error.message(), LogLevel::Warning);
+	}
+}
+
+void FileReclaimer::run()
+{
+	std::vector<std::filesystem::path> batch;
+
+	while (true)
+	{
+		{
+			std::unique_lock lock(this->mutex);
+
+			this->cv.wait(lock, [this] { return !this->initialized || !this->pending.empty(); });
+
+			// logs tend to be released together, give the rest of them a moment to arrive
+			this->cv.wait_for(lock, std::chrono::milliseconds(250), [this] { return !this->initialized.load(); });
+
+			batch.swap(this->pending);
+
+			if (batch.empty() && !this->initialized)
+				break;
+		}
+
+		this->remove(batch);
+
+		LOG_FORMAT(LogLevel::Debug, "Reclaimed {} files", batch.size());
+
+		batch.clear();
+	}
+}
+
+#undef LOG
+#undef LOG_FORMAT
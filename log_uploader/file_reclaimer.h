@@ -0,0 +1,40 @@
+#pragma once
+
+#include "module.h"
+
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// deletes files that are no longer referenced on a background thread, dropping the last reference to a log must not block on disk io
+class FileReclaimer : public Module
+{
+public:
+	FileReclaimer() {}
+	~FileReclaimer() {}
+
+	// removes files left in the data directory by a previous session, must run before the first log is added
+	void initialize(std::filesystem::path data_directory);
+	void release() override;
+
+	// queues the file for deletion, deletes it in place when the reclaimer is not running
+	void reclaim(std::filesystem::path file_path);
+
+private:
+	std::filesystem::path data_directory;
+
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::vector<std::filesystem::path> pending;
+
+	std::thread reclaim_thread;
+
+	void collect_orphans();
+	void remove(const std::vector<std::filesystem::path>& file_paths);
+	void run();
+};
+
+namespace global { extern std::unique_ptr<FileReclaimer> file_reclaimer; }
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class FileEventType
+{
+	CREATED,
+	RENAMED_TO,
+	CLOSED_AFTER_WRITE, // only reported by backends that see file handles being closed
+	EVENTS_DROPPED, // events were dropped, the directory has to be scanned to catch up, the event has no path
+	ROOT_LOST // the directory can no longer be watched, e.g. its network share disconnected, no further events follow for it, the event has no path
+};
+
+class FileEvent
+{
+public:
+	FileEventType type = FileEventType::CREATED;
+	uint32_t root = 0; // index of the watched directory in the order they were added
+	std::filesystem::path path; // relative to the watched directory
+};
+
+// recursive watcher for file name changes below any number of directories, all of them are waited on by one thread
+// backends report the same normalized events and are free of game and logger dependencies so the detection pipeline can run outside the game
+class FileWatcher
+{
+public:
+	virtual ~FileWatcher() {}
+
+	// ReadDirectoryChangesW on windows, inotify on linux
+	static auto create() -> std::unique_ptr<FileWatcher>;
+
+	// true once no other process holds the file open for writing, a single non-blocking probe
+	static auto is_released(const std::filesystem::path& file_path) -> bool;
+
+	// buffer_size is the number of bytes of pending changes read at once per directory
+	virtual auto open(size_t buffer_size) -> bool = 0;
+
+	// directories must not overlap, a failed directory does not take up a root index
+	virtual auto add_root(const std::filesystem::path& directory) -> bool = 0;
+
+	// blocks until events arrive, returns false once interrupted or when the watcher itself failed, a failing directory only ends its own events
+	virtual auto wait(std::vector<FileEvent>& events) -> bool = 0;
+
+	// wakes a blocked wait from another thread, all later waits return false right away
+	virtual void interrupt() = 0;
+
+	auto get_error() const -> const std::string& { return this->error; }
+
+protected:
+	std::string error;
+};
@@ -0,0 +1,247 @@
+#ifdef __linux__
+
+#include "file_watcher.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+class InotifyFileWatcher : public FileWatcher
+{
+public:
+	InotifyFileWatcher() {}
+
+	~InotifyFileWatcher()
+	{
+		if (this->inotify_fd != -1)
+			close(this->inotify_fd);
+
+		if (this->interrupt_fd != -1)
+			close(this->interrupt_fd);
+	}
+
+	auto open(size_t buffer_size) -> bool override
+	{
+		// a single read needs room for at least one event with the longest name
+		this->buffer.resize(std::max(buffer_size, sizeof(inotify_event) + NAME_MAX + 1));
+
+		// one inotify instance covers every root, it is polled together with the interrupt
+		this->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		this->interrupt_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+		if (this->inotify_fd == -1 || this->interrupt_fd == -1)
+		{
+			this->error = "Failed to create inotify instance: " + std::string(std::strerror(errno));
+			return false;
+		}
+
+		return true;
+	}
+
+	auto add_root(const std::filesystem::path& directory) -> bool override
+	{
+		this->roots.push_back(directory);
+
+		// inotify is not recursive, every directory below the root needs its own watch
+		std::vector<FileEvent> existing_files;
+
+		if (!this->add_watches(static_cast<uint32_t>(this->roots.size() - 1), {}, existing_files))
+		{
+			this->roots.pop_back();
+			return false;
+		}
+
+		return true;
+	}
+
+	auto wait(std::vector<FileEvent>& events) -> bool override
+	{
+		pollfd fds[] = { { this->inotify_fd, POLLIN, 0 }, { this->interrupt_fd, POLLIN, 0 } };
+
+		while (true)
+		{
+			if (poll(fds, 2, -1) == -1)
+			{
+				if (errno == EINTR)
+					continue;
+
+				this->error = "poll failed: " + std::string(std::strerror(errno));
+				return false;
+			}
+
+			if (fds[1].revents & POLLIN)
+				return false;
+
+			if (fds[0].revents & POLLIN)
+				break;
+		}
+
+		while (true)
+		{
+			const auto length = read(this->inotify_fd, this->buffer.data(), this->buffer.size());
+
+			if (length <= 0)
+				break;
+
+			for (auto offset = ssize_t(0); offset < length;)
+			{
+				const auto* event = reinterpret_cast<const inotify_event*>(this->buffer.data() + offset);
+				offset += sizeof(inotify_event) + event->len;
+
+				this->translate(*event, events);
+			}
+		}
+
+		return true;
+	}
+
+	void interrupt() override
+	{
+		if (this->interrupt_fd == -1)
+			return;
+
+		const uint64_t value = 1;
+		[[maybe_unused]] auto written = write(this->interrupt_fd, &value, sizeof(value));
+	}
+
+private:
+	static constexpr uint32_t watch_mask = IN_CREATE | IN_MOVED_TO | IN_CLOSE_WRITE | IN_DELETE_SELF | IN_ONLYDIR;
+
+	class Watch
+	{
+	public:
+		uint32_t root = 0;
+		std::filesystem::path directory; // relative to the root
+	};
+
+	std::vector<std::filesystem::path> roots;
+
+	int inotify_fd = -1;
+	int interrupt_fd = -1;
+
+	std::unordered_map<int, Watch> watches; // by watch descriptor
+
+	std::vector<char> buffer; // heap allocations are aligned for inotify_event
+
+	auto add_watches(uint32_t root, const std::filesystem::path& relative_directory, std::vector<FileEvent>& existing_files) -> bool
+	{
+		const auto& root_directory = this->roots[root];
+
+		const auto watch_directory = [this, root, &root_directory](const std::filesystem::path& relative_directory) -> bool
+			{
+				const auto descriptor = inotify_add_watch(this->inotify_fd, (root_directory / relative_directory).c_str(), watch_mask);
+
+				if (descriptor == -1)
+				{
+					this->error = "Failed to watch " + (root_directory / relative_directory).string() + ": " + std::strerror(errno);
+					return false;
+				}
+
+				this->watches[descriptor] = { root, relative_directory };
+				return true;
+			};
+
+		if (!watch_directory(relative_directory))
+			return false;
+
+		std::error_code error;
+
+		for (auto it = std::filesystem::recursive_directory_iterator(root_directory / relative_directory, error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+		{
+			const auto relative_path = std::filesystem::relative(it->path(), root_directory, error);
+
+			if (it->is_directory(error))
+				watch_directory(relative_path);
+			else
+				existing_files.push_back({ FileEventType::RENAMED_TO, root, relative_path });
+		}
+
+		return true;
+	}
+
+	void translate(const inotify_event& event, std::vector<FileEvent>& events)
+	{
+		// the kernel queue is bounded by max_queued_events and shared by all roots, anything beyond it is lost
+		if (event.mask & IN_Q_OVERFLOW)
+		{
+			for (uint32_t root = 0; root < this->roots.size(); root++)
+				events.push_back({ FileEventType::EVENTS_DROPPED, root, {} });
+
+			return;
+		}
+
+		if (event.mask & IN_IGNORED)
+		{
+			auto it = this->watches.find(event.wd);
+
+			// the watched directory itself was removed or unmounted
+			if (it != this->watches.end() && it->second.directory.empty())
+				events.push_back({ FileEventType::ROOT_LOST, it->second.root, {} });
+
+			this->watches.erase(event.wd);
+			return;
+		}
+
+		auto it = this->watches.find(event.wd);
+
+		if (it == this->watches.end() || event.len == 0)
+			return;
+
+		const auto root = it->second.root;
+		auto path = it->second.directory / event.name;
+
+		if (event.mask & IN_ISDIR)
+		{
+			// files written before the watch was added were missed, they are reported as if renamed into place
+			if (event.mask & (IN_CREATE | IN_MOVED_TO))
+				this->add_watches(root, path, events);
+
+			return;
+		}
+
+		if (event.mask & IN_CREATE)
+			events.push_back({ FileEventType::CREATED, root, std::move(path) });
+		else if (event.mask & IN_MOVED_TO)
+			events.push_back({ FileEventType::RENAMED_TO, root, std::move(path) });
+		else if (event.mask & IN_CLOSE_WRITE)
+			events.push_back({ FileEventType::CLOSED_AFTER_WRITE, root, std::move(path) });
+	}
+};
+
+auto FileWatcher::create() -> std::unique_ptr<FileWatcher>
+{
+	return std::make_unique<InotifyFileWatcher>();
+}
+
+auto FileWatcher::is_released(const std::filesystem::path& file_path) -> bool
+{
+	const auto fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+
+	if (fd == -1)
+		return false;
+
+	auto released = true;
+
+	// a read lease is refused while any process has the file open for writing
+	if (fcntl(fd, F_SETLEASE, F_RDLCK) == 0)
+		fcntl(fd, F_SETLEASE, F_UNLCK);
+	else if (errno == EAGAIN)
+		released = false;
+
+	// leases need ownership of the file, without one only the open is checked
+
+	close(fd);
+
+	return released;
+}
+
+#endif // __linux__
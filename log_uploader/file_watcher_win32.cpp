@@ -0,0 +1,212 @@
+#ifdef _WIN32
+
+#include "file_watcher.h"
+
+#include <Windows.h>
+
+#include <algorithm>
+
+class Win32FileWatcher : public FileWatcher
+{
+public:
+	Win32FileWatcher() {}
+
+	~Win32FileWatcher()
+	{
+		for (auto& root : this->roots)
+		{
+			if (root->directory_handle == INVALID_HANDLE_VALUE)
+				continue;
+
+			// the pending read still writes into the buffer until it is cancelled
+			if (root->read_pending)
+			{
+				CancelIoEx(root->directory_handle, &root->overlapped);
+
+				DWORD bytes_transferred;
+				GetOverlappedResult(root->directory_handle, &root->overlapped, &bytes_transferred, TRUE);
+			}
+
+			CloseHandle(root->directory_handle);
+		}
+
+		if (this->completion_port != NULL)
+			CloseHandle(this->completion_port);
+	}
+
+	auto open(size_t buffer_size) -> bool override
+	{
+		this->buffer_size = buffer_size;
+
+		// every directory completes on this port, the completion key is its root index
+		this->completion_port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 1);
+
+		if (this->completion_port == NULL)
+		{
+			this->error = "Failed to create completion port for directory monitoring";
+			return false;
+		}
+
+		return true;
+	}
+
+	auto add_root(const std::filesystem::path& directory) -> bool override
+	{
+		auto root = std::make_unique<Root>();
+
+		root->directory_handle = CreateFileW(directory.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+
+		if (root->directory_handle == INVALID_HANDLE_VALUE)
+		{
+			this->error = "Failed to open directory: " + directory.string();
+			return false;
+		}
+
+		const auto index = static_cast<ULONG_PTR>(this->roots.size());
+
+		if (CreateIoCompletionPort(root->directory_handle, this->completion_port, index, 0) == NULL)
+		{
+			this->error = "Failed to watch directory: " + directory.string();
+			CloseHandle(root->directory_handle);
+			return false;
+		}
+
+		// ReadDirectoryChangesW fails on network shares with buffers above 64 KiB
+		auto buffer_size = this->buffer_size;
+
+		if (GetDriveTypeW(directory.root_path().c_str()) == DRIVE_REMOTE)
+			buffer_size = (std::min)(buffer_size, size_t(64 * 1024));
+
+		// FILE_NOTIFY_INFORMATION entries are DWORD aligned
+		root->buffer.resize((buffer_size + sizeof(DWORD) - 1) / sizeof(DWORD));
+
+		if (!this->read(*root))
+		{
+			this->error = "Failed to read directory changes: " + directory.string();
+			CloseHandle(root->directory_handle);
+			return false;
+		}
+
+		this->roots.push_back(std::move(root));
+
+		return true;
+	}
+
+	auto wait(std::vector<FileEvent>& events) -> bool override
+	{
+		DWORD bytes_transferred = 0;
+		ULONG_PTR key = 0;
+		OVERLAPPED* overlapped = nullptr;
+
+		const auto result = GetQueuedCompletionStatus(this->completion_port, &bytes_transferred, &key, &overlapped, INFINITE);
+
+		// posted by interrupt, it has no overlapped
+		if (overlapped == nullptr)
+		{
+			if (!result)
+				this->error = "GetQueuedCompletionStatus failed";
+
+			return false;
+		}
+
+		const auto index = static_cast<uint32_t>(key);
+		auto& root = *this->roots[index];
+
+		root.read_pending = false;
+
+		// e.g. the network share of the directory disconnected, the other directories are still watched
+		if (!result && GetLastError() != ERROR_NOTIFY_ENUM_DIR)
+		{
+			this->drop_root(root, index, events);
+			return true;
+		}
+
+		// more changes than fit the buffer complete with no data or ERROR_NOTIFY_ENUM_DIR, all of them are lost
+		if (!result || bytes_transferred == 0)
+			events.push_back({ FileEventType::EVENTS_DROPPED, index, {} });
+		else
+		{
+			auto* fni = reinterpret_cast<FILE_NOTIFY_INFORMATION*>(root.buffer.data());
+
+			while (fni != nullptr)
+			{
+				auto path = std::filesystem::path(std::wstring(fni->FileName, fni->FileNameLength / sizeof(wchar_t)));
+
+				if (fni->Action == FILE_ACTION_ADDED)
+					events.push_back({ FileEventType::CREATED, index, std::move(path) });
+				else if (fni->Action == FILE_ACTION_RENAMED_NEW_NAME)
+					events.push_back({ FileEventType::RENAMED_TO, index, std::move(path) });
+
+				fni = (fni->NextEntryOffset != 0) ? reinterpret_cast<FILE_NOTIFY_INFORMATION*>(reinterpret_cast<BYTE*>(fni) + fni->NextEntryOffset) : nullptr;
+			}
+		}
+
+		// the buffer was consumed, the next changes of this directory are queued right away
+		if (!this->read(root))
+			this->drop_root(root, index, events);
+
+		return true;
+	}
+
+	void interrupt() override
+	{
+		if (this->completion_port != NULL)
+			PostQueuedCompletionStatus(this->completion_port, 0, 0, nullptr);
+	}
+
+private:
+	class Root
+	{
+	public:
+		HANDLE directory_handle = INVALID_HANDLE_VALUE;
+		OVERLAPPED overlapped = { 0 };
+		bool read_pending = false;
+
+		std::vector<DWORD> buffer;
+	};
+
+	HANDLE completion_port = NULL;
+	size_t buffer_size = 0;
+
+	std::vector<std::unique_ptr<Root>> roots; // the overlapped of a root must not move while a read is pending
+
+	auto read(Root& root) -> bool
+	{
+		root.overlapped = { 0 };
+
+		if (!ReadDirectoryChangesW(root.directory_handle, root.buffer.data(), static_cast<DWORD>(root.buffer.size() * sizeof(DWORD)), TRUE, FILE_NOTIFY_CHANGE_FILE_NAME, nullptr, &root.overlapped, nullptr))
+			return false;
+
+		root.read_pending = true;
+
+		return true;
+	}
+
+	void drop_root(Root& root, uint32_t index, std::vector<FileEvent>& events)
+	{
+		CloseHandle(root.directory_handle);
+		root.directory_handle = INVALID_HANDLE_VALUE;
+
+		events.push_back({ FileEventType::ROOT_LOST, index, {} });
+	}
+};
+
+auto FileWatcher::create() -> std::unique_ptr<FileWatcher>
+{
+	return std::make_unique<Win32FileWatcher>();
+}
+
+auto FileWatcher::is_released(const std::filesystem::path& file_path) -> bool
+{
+	// denies write sharing, the open fails with a sharing violation while arcdps still writes the file
+	auto handle = CreateFileW(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (handle == INVALID_HANDLE_VALUE)
+		return false;
+
+	CloseHandle(handle);
+
+	return true;
+}
+
+#endif // _WIN32
@@ -0,0 +1,89 @@
+#include "http_metrics.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <format>
+
+namespace global { std::unique_ptr<HttpMetrics> http_metrics = std::make_unique<HttpMetrics>(); }
+
+#define LOG(message, log_level) do { if (Logger::is_enabled(log_level)) global::logger->write(message, log_level, LogSource::HttpMetrics); } while (0)
+#define LOG_FORMAT(log_level, ...) global::logger->write_format(log_level, LogSource::HttpMetrics, __VA_ARGS__)
+
+void LatencyHistogram::add(double milliseconds)
+{
+	const auto bucket = std::lower_bound(bounds.begin(), bounds.end(), milliseconds) - bounds.begin();
+
+	this->buckets[bucket]++;
+	this->count++;
+	this->sum += milliseconds;
+	this->max = (std::max)(this->max, milliseconds);
+}
+
+auto LatencyHistogram::to_string() const -> std::string
+{
+	if (this->count == 0)
+		return "no samples";
+
+	auto result = std::format("n={} avg={:.0f}ms max={:.0f}ms [", this->count, this->sum / static_cast<double>(this->count), this->max);
+
+	for (size_t i = 0; i < this->buckets.size(); i++)
+	{
+		if (i > 0)
+			result += " ";
+
+		if (i < bounds.size())
+			result += std::format("<{:.0f}ms:{}", bounds[i], this->buckets[i]);
+		else
+			result += std::format(">={:.0f}ms:{}", bounds.back(), this->buckets[i]);
+	}
+
+	return result + "]";
+}
+
+void HttpMetrics::record(const std::string& endpoint, cpr::Session& session, const cpr::Response& response)
+{
+	curl_off_t connect_time = 0, start_transfer_time = 0, total_time = 0;
+
+	auto handle = session.GetCurlHolder()->handle;
+
+	// microseconds since the start of the request
+	curl_easy_getinfo(handle, CURLINFO_CONNECT_TIME_T, &connect_time);
+	curl_easy_getinfo(handle, CURLINFO_STARTTRANSFER_TIME_T, &start_transfer_time);
+	curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME_T, &total_time);
+
+	std::lock_guard lock(this->mutex);
+
+	auto& metrics = this->endpoints[endpoint];
+
+	if (response.error || response.status_code == 0)
+	{
+		metrics.errors++;
+		return;
+	}
+
+	metrics.connect.add(static_cast<double>(connect_time) / 1000.);
+	metrics.ttfb.add(static_cast<double>(start_transfer_time) / 1000.);
+	metrics.total.add(static_cast<double>(total_time) / 1000.);
+}
+
+void HttpMetrics::dump()
+{
+	std::lock_guard lock(this->mutex);
+
+	if (this->endpoints.empty())
+	{
+		LOG("No requests recorded", LogLevel::Info);
+		return;
+	}
+
+	for (const auto& [endpoint, metrics] : this->endpoints)
+	{
+		LOG(endpoint + " | errors: " + std::to_string(metrics.errors), LogLevel::Info);
+		LOG(endpoint + " | connect: " + metrics.connect.to_string(), LogLevel::Info);
+		LOG(endpoint + " | ttfb: " + metrics.ttfb.to_string(), LogLevel::Info);
+		LOG(endpoint + " | total: " + metrics.total.to_string(), LogLevel::Info);
+	}
+}
+
+#undef LOG
+#undef LOG_FORMAT
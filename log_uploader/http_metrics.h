@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <cpr/cpr.h>
+
+class LatencyHistogram
+{
+public:
+	// upper bucket bounds in milliseconds, the last bucket takes everything above
+	static constexpr std::array<double, 11> bounds = { 25., 50., 100., 250., 500., 1000., 2500., 5000., 10000., 30000., 60000. };
+
+	std::array<uint64_t, bounds.size() + 1> buckets = {};
+
+	uint64_t count = 0;
+	double sum = 0.;
+	double max = 0.;
+
+	void add(double milliseconds);
+	auto to_string() const -> std::string;
+};
+
+class EndpointMetrics
+{
+public:
+	LatencyHistogram connect;
+	LatencyHistogram ttfb;
+	LatencyHistogram total;
+
+	uint64_t errors = 0;
+};
+
+// per endpoint latency histograms of all requests made by the uploaders
+class HttpMetrics
+{
+public:
+	HttpMetrics() {}
+	~HttpMetrics() {}
+
+	void record(const std::string& endpoint, cpr::Session& session, const cpr::Response& response);
+
+	// writes all histograms to the log
+	void dump();
+
+private:
+	std::mutex mutex;
+	std::map<std::string, EndpointMetrics> endpoints;
+};
+
+namespace global { extern std::unique_ptr<HttpMetrics> http_metrics; }
@@ -2,6 +2,7 @@
 
 #include "../imgui/imgui_internal.h"
 
+#include <format>
 #include <unordered_map>
 #include <Windows.h>
 
@@ -50,7 +51,7 @@ bool ImGui::ButtonDisabled(const char* label, bool disabled)
 	return result;
 }
 
-bool ImGui::ButtonParser(ParseStatus status)
+bool ImGui::ButtonParser(ParseStatus status, bool opening_report)
 {
 	ID id("Parser Button");
 
@@ -67,6 +68,10 @@ bool ImGui::ButtonParser(ParseStatus status)
 			}
 		};
 
+	// the report is restored on the report store thread meanwhile
+	if (opening_report)
+		return ButtonDisabled("Opening", true);
+
 	auto available = status == ParseStatus::PARSED || status == ParseStatus::UNPARSED;
 
 	return ButtonDisabled(get_text(status), !available);
@@ -229,7 +234,23 @@ void ImGui::Indicator(ImVec4 color)
 	ImGui::GetWindowDrawList()->AddCircleFilled(center, radius, ImGui::ColorConvertFloat4ToU32(color));
 }
 
-bool ImGui::ButtonDpsReport(DpsReportUploadStatus status)
+void ImGui::UploadProgress(const char* label, const TransferProgress& progress)
+{
+	if (progress.bytes_total == 0)
+	{
+		ButtonDisabled(label, true);
+		return;
+	}
+
+	const auto fraction = progress.get_fraction();
+
+	ImGui::ProgressBar(fraction, ImVec2(ImGui::GetColumnWidth(), 0.f), std::format("{:.0f}%", fraction * 100.f).c_str());
+
+	ImGui::DelayedTooltipText(std::format("{:.2f} / {:.2f} MiB at {:.1f} KiB/s, {}s remaining",
+		static_cast<double>(progress.bytes_sent) / (1024. * 1024.), static_cast<double>(progress.bytes_total) / (1024. * 1024.), progress.rate / 1024., progress.eta.count()), 0.);
+}
+
+bool ImGui::ButtonDpsReport(DpsReportUploadStatus status, const TransferProgress& progress)
 {
 	ID id("Dps Report Button");
 
@@ -246,12 +267,18 @@ bool ImGui::ButtonDpsReport(DpsReportUploadStatus status)
 			}
 		};
 
+	if (status == DpsReportUploadStatus::UPLOADING)
+	{
+		UploadProgress(get_text(status), progress);
+		return false;
+	}
+
 	auto available = status == DpsReportUploadStatus::AVAILABLE || status == DpsReportUploadStatus::UPLOADED || status == DpsReportUploadStatus::FAILED;
 
 	return ButtonDisabled(get_text(status), !available);
 }
 
-bool ImGui::ButtonWingman(WingmanUploadStatus status, ParseStatus parse_status)
+bool ImGui::ButtonWingman(WingmanUploadStatus status, ParseStatus parse_status, const TransferProgress& progress)
 {
 	ID id("Wingman Button");
 
@@ -270,6 +297,12 @@ bool ImGui::ButtonWingman(WingmanUploadStatus status, ParseStatus parse_status)
 			}
 		};
 
+	if (status == WingmanUploadStatus::UPLOADING)
+	{
+		UploadProgress(get_text(status), progress);
+		return false;
+	}
+
 	auto available = parse_status == ParseStatus::PARSED && (status == WingmanUploadStatus::AVAILABLE || status == WingmanUploadStatus::FAILED);
 
 	return ButtonDisabled(get_text(status), !available);
@@ -283,38 +316,6 @@ void ImGui::CenterNextItemHorizontally(const char* text)
 	ImGui::SetCursorPosX(ImGui::GetCursorPosX() + offset);
 }
 
-std::vector<std::pair<std::string, std::vector<std::pair<std::string, std::vector<TriggerID>>>>> categorized_triggers = {
-	{"Raids", {
-		{"Spirit Vale", {TriggerID::ValeGuardian, TriggerID::SpiritRace, TriggerID::Gorseval, TriggerID::SabethaTheSaboteur}},
-		{"Salvation Pass", {TriggerID::Slothasor, TriggerID::BanditTrio, TriggerID::MatthiasGabrel}},
-		{"Stronghold of the Faithful", {TriggerID::SiegeTheStronghold, TriggerID::KeepConstruct, TriggerID::TwistedCastle, TriggerID::Xera}},
-		{"Bastion of the Penitent", {TriggerID::CairnTheIndomitable, TriggerID::MursaatOverseer, TriggerID::Samarog, TriggerID::Deimos}},
-		{"Hall of Chains", {TriggerID::SoullessHorror, TriggerID::RiverOfSouls, TriggerID::StatueOfIce, TriggerID::StatueOfDarkness, TriggerID::StatueOfDeath, TriggerID::Dhuum}},
-		{"Mythwright Gambit", {TriggerID::ConjuredAmalgamate, TriggerID::TwinLargos, TriggerID::Qadim}},
-		{"The Key of Ahdashim", {TriggerID::CardinalAdina, TriggerID::CardinalSabir, TriggerID::QadimThePeerless}},
-		{"Mount Balrior", {TriggerID::DecimaTheStormsinger, TriggerID::GreerTheBlightbringer, TriggerID::UraTheSteamshrieker}},
-	}},
-	{"Fractals", {
-		{"Nightmare", {TriggerID::MAMA, TriggerID::SiaxTheCorrupted, TriggerID::EnsolyssOfTheEndlessTorment}},
-		{"Shattered Observatory", {TriggerID::SkorvaldTheShattered, TriggerID::Artsariiv, TriggerID::Arkk}},
-		{"Sunqua Peak", {TriggerID::AiKeeperOfThePeak}},
-		{"Silent Surf", {TriggerID::Kanaxai, TriggerID::KanaxaiChallengeMode}},
-		{"Lonely Tower", {TriggerID::Eparch}},
-	}},
-	{"Strike Missions", {
-		{"Core", {TriggerID::OldLionsCourt, TriggerID::OldLionsCourtChallengeMode}},
-		{"The Icebrood Saga", {TriggerID::IcebroodConstruct, TriggerID::SuperKodanBrothers, TriggerID::FraenirOfJormag, TriggerID::Boneskinner, TriggerID::WhisperOfJormag}},
-		{"End of Dragons", {TriggerID::AetherbladeHideout, TriggerID::XunlaiJadeJunkyard, TriggerID::KainengOverlook, TriggerID::KainengOverlookChallengeMode, TriggerID::HarvestTemple}},
-		{"Secrets of the Obscure", {TriggerID::CosmicObservatory, TriggerID::TempleOfFebe}},
-	}},
-	{"Other", {
-		{"Convergences", {TriggerID::DemonKnight, TriggerID::Sorrow, TriggerID::Dreadwing, TriggerID::HellSister, TriggerID::Umbriel}},
-		{"Special Forces Training Area", {TriggerID::StandardKittyGolem, TriggerID::MediumKittyGolem, TriggerID::LargeKittyGolem}},
-		{"World vs World", {TriggerID::WorldVsWorld}},
-		{"Uncategorized", {TriggerID::Freezie, TriggerID::DregShark, TriggerID::HeartsAndMinds}},
-	}},
-};
-
 bool ImGui::EncounterSelector(const char* label, EncounterSelection* value)
 {
 	ID id("Encounter Selector");
@@ -348,7 +349,7 @@ bool ImGui::EncounterSelector(const char* label, EncounterSelection* value)
 	ImGui::Spacing();
 	if (ImGui::Button("Select All"))
 	{
-		for (const auto& [main_category, sub_categories] : categorized_triggers)
+		for (const auto& [main_category, sub_categories] : global::categorized_triggers)
 		{
 			for (const auto& [sub_category, triggers] : sub_categories)
 			{
@@ -378,7 +379,7 @@ bool ImGui::EncounterSelector(const char* label, EncounterSelection* value)
 	ImGui::SameLine();
 	if (ImGui::Button("Deselect All"))
 	{
-		for (const auto& [main_category, sub_categories] : categorized_triggers)
+		for (const auto& [main_category, sub_categories] : global::categorized_triggers)
 		{
 			for (const auto& [sub_category, triggers] : sub_categories)
 			{
@@ -419,7 +420,7 @@ bool ImGui::EncounterSelector(const char* label, EncounterSelection* value)
 
 	ImGui::Spacing();
 
-	for (const auto& [main_category, sub_categories] : categorized_triggers)
+	for (const auto& [main_category, sub_categories] : global::categorized_triggers)
 	{
 		bool main_category_matches = false;
 
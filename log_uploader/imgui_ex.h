@@ -18,12 +18,13 @@ namespace ImGui
 	void ClipWindowToScreen();
 	bool SmallCheckbox(const char* label, bool* v);
 	bool ButtonDisabled(const char* label, bool disabled);
-	bool ButtonParser(ParseStatus status);
+	bool ButtonParser(ParseStatus status, bool opening_report = false);
 	void DelayedTooltipText(const std::string& text, double delay = .85);
 	bool KeySelector(const char* label, Hotkey* v);
 	void Indicator(ImVec4 color);
-	bool ButtonDpsReport(DpsReportUploadStatus status);
-	bool ButtonWingman(WingmanUploadStatus status, ParseStatus parse_status);
+	void UploadProgress(const char* label, const TransferProgress& progress);
+	bool ButtonDpsReport(DpsReportUploadStatus status, const TransferProgress& progress);
+	bool ButtonWingman(WingmanUploadStatus status, ParseStatus parse_status, const TransferProgress& progress);
 	void CenterNextItemHorizontally(const char* text);
 	inline void SmallSpacing() { ImGui::Dummy(ImVec2(0.f, 5.f)); }
 	bool EncounterSelector(const char* label, EncounterSelection* value);
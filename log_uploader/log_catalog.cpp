@@ -0,0 +1,273 @@
+#include "log_catalog.h"
+#include "logger.h"
+
+#include <algorithm>
+
+#include <nlohmann/json.hpp>
+
+namespace global { std::unique_ptr<LogCatalog> log_catalog = std::make_unique<LogCatalog>(); }
+
+#define LOG(message, log_level) do { if (Logger::is_enabled(log_level)) global::logger->write(message, log_level, LogSource::LogCatalog); } while (0)
+#define LOG_FORMAT(log_level, ...) global::logger->write_format(log_level, LogSource::LogCatalog, __VA_ARGS__)
+
+namespace
+{
+	auto to_milliseconds(std::chrono::system_clock::time_point time) -> int64_t
+	{
+		return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+	}
+
+	auto from_milliseconds(int64_t milliseconds) -> std::chrono::system_clock::time_point
+	{
+		return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::milliseconds(milliseconds)));
+	}
+
+	auto to_json(const EncounterLogData& data) -> nlohmann::json
+	{
+		nlohmann::json json;
+
+		json["id"] = data.id;
+		json["sequence"] = data.sequence;
+		json["session_id"] = data.session_id;
+		json["statistics_recorded"] = data.statistics_recorded;
+
+		const auto evtc_file_path = data.evtc_data.evtc_file_path.u8string();
+		json["evtc_file_path"] = std::string(evtc_file_path.begin(), evtc_file_path.end());
+		json["evtc_time"] = to_milliseconds(data.evtc_data.time);
+		json["trigger_id"] = static_cast<int>(data.evtc_data.trigger_id);
+		json["root"] = data.evtc_data.root;
+
+		json["parse_status"] = static_cast<int>(data.parse_status);
+
+		json["encounter_name"] = data.encounter_data.encounter_name.str();
+		json["account_name"] = data.encounter_data.account_name.str();
+		json["duration_ms"] = data.encounter_data.duration_ms;
+		json["success"] = data.encounter_data.success;
+		json["valid_boss"] = data.encounter_data.valid_boss;
+		json["health_percent_burned"] = data.encounter_data.health_percent_burned;
+		json["difficulty"] = static_cast<int>(data.encounter_data.difficulty);
+		json["start_time"] = to_milliseconds(data.encounter_data.start_time);
+		json["end_time"] = to_milliseconds(data.encounter_data.end_time);
+
+		json["report_key"] = data.report_data.report_key;
+
+		if (data.report_data.error_message.has_value())
+			json["report_error"] = data.report_data.error_message.value();
+
+		json["dps_report_status"] = static_cast<int>(data.dps_report_upload.status);
+		json["dps_report_url"] = data.dps_report_upload.url;
+		json["dps_report_id"] = data.dps_report_upload.id;
+		json["dps_report_user_token"] = data.dps_report_upload.user_token;
+
+		if (data.dps_report_upload.error_message.has_value())
+			json["dps_report_error"] = data.dps_report_upload.error_message.value();
+
+		json["wingman_status"] = static_cast<int>(data.wingman_upload.status);
+
+		if (data.wingman_upload.error_message.has_value())
+			json["wingman_error"] = data.wingman_upload.error_message.value();
+
+		return json;
+	}
+
+	auto from_json(const nlohmann::json& json) -> EncounterLogData
+	{
+		EncounterLogData data;
+
+		const auto optional_string = [&json](const char* key) -> std::optional<std::string>
+			{
+				if (json.contains(key))
+					return json.at(key).get<std::string>();
+
+				return std::nullopt;
+			};
+
+		data.id = json.at("id").get<std::string>();
+		data.sequence = json.at("sequence").get<uint32_t>();
+		data.session_id = json.at("session_id").get<uint32_t>();
+		data.statistics_recorded = json.at("statistics_recorded").get<bool>();
+
+		const auto evtc_file_path = json.at("evtc_file_path").get<std::string>();
+		data.evtc_data.evtc_file_path = std::filesystem::path(std::u8string(evtc_file_path.begin(), evtc_file_path.end()));
+		data.evtc_data.time = from_milliseconds(json.at("evtc_time").get<int64_t>());
+		data.evtc_data.trigger_id = static_cast<TriggerID>(json.at("trigger_id").get<int>());
+		data.evtc_data.root = json.at("root").get<uint32_t>();
+
+		data.parse_status = static_cast<ParseStatus>(json.at("parse_status").get<int>());
+
+		data.encounter_data.encounter_name = json.at("encounter_name").get<std::string>();
+		data.encounter_data.account_name = json.at("account_name").get<std::string>();
+		data.encounter_data.duration_ms = json.at("duration_ms").get<int>();
+		data.encounter_data.success = json.at("success").get<bool>();
+		data.encounter_data.valid_boss = json.at("valid_boss").get<bool>();
+		data.encounter_data.health_percent_burned = json.at("health_percent_burned").get<float>();
+		data.encounter_data.difficulty = static_cast<EncounterDifficulty>(json.at("difficulty").get<int>());
+		data.encounter_data.start_time = from_milliseconds(json.at("start_time").get<int64_t>());
+		data.encounter_data.end_time = from_milliseconds(json.at("end_time").get<int64_t>());
+
+		data.report_data.report_key = json.at("report_key").get<std::string>();
+		data.report_data.error_message = optional_string("report_error");
+
+		data.dps_report_upload.status = static_cast<DpsReportUploadStatus>(json.at("dps_report_status").get<int>());
+		data.dps_report_upload.url = json.at("dps_report_url").get<std::string>();
+		data.dps_report_upload.id = json.at("dps_report_id").get<std::string>();
+		data.dps_report_upload.user_token = json.at("dps_report_user_token").get<std::string>();
+		data.dps_report_upload.error_message = optional_string("dps_report_error");
+
+		data.wingman_upload.status = static_cast<WingmanUploadStatus>(json.at("wingman_status").get<int>());
+		data.wingman_upload.error_message = optional_string("wingman_error");
+
+		return data;
+	}
+}
+
+void LogCatalog::initialize(std::filesystem::path catalog_file_path)
+{
+	std::lock_guard initialization_lock(this->initialization_mutex);
+
+	if (this->is_initialized())
+		return;
+
+	std::lock_guard lock(this->mutex);
+
+	this->catalog_file_path = std::move(catalog_file_path);
+
+	std::error_code error;
+	std::filesystem::create_directories(this->catalog_file_path.parent_path(), error);
+
+	// encounter logs are not restored across sessions, neither is the catalog
+	this->catalog_file.open(this->catalog_file_path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+
+	if (!this->catalog_file.is_open())
+	{
+		LOG("Failed to open catalog file: " + this->catalog_file_path.string(), LogLevel::Error);
+		return;
+	}
+
+	this->entries.clear();
+
+	this->initialized = true;
+}
+
+void LogCatalog::release()
+{
+	std::lock_guard initialization_lock(this->initialization_mutex);
+
+	if (!this->initialized)
+		return;
+
+	this->initialized = false;
+
+	std::lock_guard lock(this->mutex);
+
+	this->catalog_file.close();
+	this->entries.clear();
+
+	std::error_code error;
+	std::filesystem::remove(this->catalog_file_path, error);
+}
+
+void LogCatalog::store(const EncounterLogData& encounter_log_data)
+{
+	if (!this->is_initialized())
+		return;
+
+	const auto line = to_json(encounter_log_data).dump() + "\n";
+
+	std::lock_guard lock(this->mutex);
+
+	this->catalog_file.clear();
+	this->catalog_file.seekp(0, std::ios::end);
+
+	CatalogEntry entry;
+	entry.offset = static_cast<uint64_t>(this->catalog_file.tellp());
+	entry.size = static_cast<uint32_t>(line.size());
+	entry.sequence = encounter_log_data.sequence;
+	entry.trigger_id = encounter_log_data.evtc_data.trigger_id;
+	entry.time = encounter_log_data.evtc_data.time;
+
+	this->catalog_file.write(line.data(), line.size());
+	this->catalog_file.flush();
+
+	if (!this->catalog_file)
+	{
+		LOG("Failed to write catalog entry: " + encounter_log_data.id, LogLevel::Error);
+		return;
+	}
+
+	this->entries.push_back(entry);
+}
+
+auto LogCatalog::load(size_t count) -> std::vector<EncounterLogData>
+{
+	std::vector<EncounterLogData> result;
+
+	if (!this->is_initialized())
+		return result;
+
+	std::lock_guard lock(this->mutex);
+
+	while (count-- > 0 && !this->entries.empty())
+	{
+		this->read_entry(this->entries.back(), result);
+		this->entries.pop_back();
+	}
+
+	this->reset_if_empty();
+
+	return result;
+}
+
+auto LogCatalog::load_sequences(const std::vector<uint32_t>& sequences) -> std::vector<EncounterLogData>
+{
+	std::vector<EncounterLogData> result;
+
+	if (!this->is_initialized())
+		return result;
+
+	std::lock_guard lock(this->mutex);
+
+	std::erase_if(this->entries, [this, &sequences, &result](const CatalogEntry& entry)
+		{
+			if (std::find(sequences.begin(), sequences.end(), entry.sequence) == sequences.end())
+				return false;
+
+			this->read_entry(entry, result);
+			return true;
+		});
+
+	this->reset_if_empty();
+
+	return result;
+}
+
+void LogCatalog::read_entry(const CatalogEntry& entry, std::vector<EncounterLogData>& result)
+{
+	std::string line(entry.size, '\0');
+
+	this->catalog_file.clear();
+	this->catalog_file.seekg(static_cast<std::streamoff>(entry.offset));
+	this->catalog_file.read(line.data(), entry.size);
+
+	try
+	{
+		result.push_back(from_json(nlohmann::json::parse(line)));
+	}
+	catch (const std::exception& e)
+	{
+		LOG("Failed to read catalog entry: " + std::string(e.what()), LogLevel::Error);
+	}
+}
+
+void LogCatalog::reset_if_empty()
+{
+	// no entry references the file anymore, start over instead of growing it
+	if (!this->entries.empty())
+		return;
+
+	this->catalog_file.close();
+	this->catalog_file.open(this->catalog_file_path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+}
+
+#undef LOG
+#undef LOG_FORMAT
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "encounter_log.h"
+#include "module.h"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class CatalogEntry
+{
+public:
+	uint64_t offset = 0;
+	uint32_t size = 0;
+
+	uint32_t sequence = 0;
+
+	TriggerID trigger_id = TriggerID::Invalid;
+	std::chrono::system_clock::time_point time{};
+};
+
+// on-disk cold store for encounter logs evicted from the working set, only lives for the current session
+class LogCatalog : public Module
+{
+public:
+	LogCatalog() {}
+	~LogCatalog() {}
+
+	void initialize(std::filesystem::path catalog_file_path);
+	void release() override;
+
+	void store(const EncounterLogData& encounter_log_data);
+
+	// removes and returns up to count of the most recently evicted logs
+	auto load(size_t count) -> std::vector<EncounterLogData>;
+
+	// removes and returns the logs with the given sequence numbers
+	auto load_sequences(const std::vector<uint32_t>& sequences) -> std::vector<EncounterLogData>;
+
+	auto get_count() -> size_t
+	{
+		std::lock_guard lock(this->mutex);
+		return this->entries.size();
+	}
+
+private:
+	std::mutex mutex;
+
+	std::filesystem::path catalog_file_path;
+	std::fstream catalog_file;
+
+	std::vector<CatalogEntry> entries;
+
+	void read_entry(const CatalogEntry& entry, std::vector<EncounterLogData>& result);
+	void reset_if_empty();
+};
+
+namespace global { extern std::unique_ptr<LogCatalog> log_catalog; }
@@ -0,0 +1,386 @@
+#include "log_index.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <charconv>
+#include <sstream>
+
+namespace
+{
+	auto to_lower(std::string_view text) -> std::string
+	{
+		std::string result(text);
+		std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		return result;
+	}
+
+	auto contains_lower(const std::string& text, const std::string& lower_pattern) -> bool
+	{
+		return std::search(text.begin(), text.end(), lower_pattern.begin(), lower_pattern.end(), [](char a, char b)
+			{
+				return std::tolower(static_cast<unsigned char>(a)) == b;
+			}) != text.end();
+	}
+
+	auto split(std::string_view text, char separator) -> std::vector<std::string_view>
+	{
+		std::vector<std::string_view> parts;
+
+		while (!text.empty())
+		{
+			const auto position = text.find(separator);
+			const auto part = text.substr(0, position);
+
+			if (!part.empty())
+				parts.push_back(part);
+
+			if (position == std::string_view::npos)
+				break;
+
+			text.remove_prefix(position + 1);
+		}
+
+		return parts;
+	}
+
+	auto get_result(const EncounterLogData& data) -> EncounterResult
+	{
+		if (data.parse_status != ParseStatus::PARSED)
+			return EncounterResult::UNKNOWN;
+
+		return data.encounter_data.success ? EncounterResult::SUCCESS : EncounterResult::FAILURE;
+	}
+
+	// the difficulty is only known once the log is parsed, it defaults to normal mode until then
+	constexpr uint64_t unknown_difficulty = UINT64_MAX;
+
+	auto get_difficulty(const EncounterLogData& data) -> uint64_t
+	{
+		if (data.parse_status != ParseStatus::PARSED)
+			return unknown_difficulty;
+
+		return static_cast<uint64_t>(data.encounter_data.difficulty);
+	}
+
+	auto get_time(const EncounterLogData& data) -> int64_t
+	{
+		const auto time = data.parse_status == ParseStatus::PARSED ? data.encounter_data.end_time : data.evtc_data.time;
+		return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+	}
+
+	auto get_key(const InternedString& value) -> uint64_t
+	{
+		// interned strings are never released, their address identifies them
+		return reinterpret_cast<uint64_t>(&value.str());
+	}
+
+	auto intersect(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) -> std::vector<uint32_t>
+	{
+		std::vector<uint32_t> result;
+		result.reserve((std::min)(a.size(), b.size()));
+		std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+		return result;
+	}
+}
+
+auto LogFilter::parse(std::string_view text) -> LogFilter
+{
+	static const std::unordered_map<std::string_view, std::unordered_map<std::string_view, uint64_t>> enum_values =
+	{
+		{ "result", {
+			{ "success", static_cast<uint64_t>(EncounterResult::SUCCESS) }, { "kill", static_cast<uint64_t>(EncounterResult::SUCCESS) },
+			{ "failure", static_cast<uint64_t>(EncounterResult::FAILURE) }, { "fail", static_cast<uint64_t>(EncounterResult::FAILURE) }, { "wipe", static_cast<uint64_t>(EncounterResult::FAILURE) },
+			{ "unknown", static_cast<uint64_t>(EncounterResult::UNKNOWN) } } },
+		{ "mode", {
+			{ "nm", static_cast<uint64_t>(EncounterDifficulty::NORMAL_MODE) },
+			{ "cm", static_cast<uint64_t>(EncounterDifficulty::CHALLENGE_MODE) },
+			{ "lcm", static_cast<uint64_t>(EncounterDifficulty::LEGENDARY_CHALLENGE_MODE) },
+			{ "unknown", unknown_difficulty } } },
+		{ "parse", {
+			{ "unparsed", static_cast<uint64_t>(ParseStatus::UNPARSED) }, { "queued", static_cast<uint64_t>(ParseStatus::QUEUED) },
+			{ "parsing", static_cast<uint64_t>(ParseStatus::PARSING) }, { "parsed", static_cast<uint64_t>(ParseStatus::PARSED) },
+			{ "failed", static_cast<uint64_t>(ParseStatus::FAILED) } } },
+		{ "dps", {
+			{ "available", static_cast<uint64_t>(DpsReportUploadStatus::AVAILABLE) }, { "queued", static_cast<uint64_t>(DpsReportUploadStatus::QUEUED) },
+			{ "uploading", static_cast<uint64_t>(DpsReportUploadStatus::UPLOADING) }, { "uploaded", static_cast<uint64_t>(DpsReportUploadStatus::UPLOADED) },
+			{ "failed", static_cast<uint64_t>(DpsReportUploadStatus::FAILED) } } },
+		{ "wingman", {
+			{ "unavailable", static_cast<uint64_t>(WingmanUploadStatus::UNAVAILABLE) }, { "available", static_cast<uint64_t>(WingmanUploadStatus::AVAILABLE) },
+			{ "queued", static_cast<uint64_t>(WingmanUploadStatus::QUEUED) }, { "uploading", static_cast<uint64_t>(WingmanUploadStatus::UPLOADING) },
+			{ "uploaded", static_cast<uint64_t>(WingmanUploadStatus::UPLOADED) }, { "skipped", static_cast<uint64_t>(WingmanUploadStatus::SKIPPED) },
+			{ "failed", static_cast<uint64_t>(WingmanUploadStatus::FAILED) } } },
+	};
+
+	static const std::unordered_map<std::string_view, IndexDimension> dimensions =
+	{
+		{ "boss", IndexDimension::NAME }, { "name", IndexDimension::NAME }, { "account", IndexDimension::ACCOUNT },
+		{ "trigger", IndexDimension::TRIGGER }, { "result", IndexDimension::RESULT }, { "mode", IndexDimension::DIFFICULTY },
+		{ "parse", IndexDimension::PARSE_STATUS }, { "dps", IndexDimension::DPS_REPORT_STATUS }, { "wingman", IndexDimension::WINGMAN_STATUS },
+	};
+
+	const auto parse_date = [](std::string_view value) -> std::optional<int64_t>
+		{
+			std::istringstream stream{ std::string(value) };
+			std::chrono::local_days date;
+
+			if (!(stream >> std::chrono::parse("%F", date)))
+				return std::nullopt;
+
+			const auto time = std::chrono::current_zone()->to_sys(date, std::chrono::choose::earliest);
+			return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+		};
+
+	const auto parse_age = [](std::string_view value) -> std::optional<int64_t>
+		{
+			int64_t amount = 0;
+			auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), amount);
+
+			if (error != std::errc() || end == value.data() || end + 1 != value.data() + value.size() || amount < 0)
+				return std::nullopt;
+
+			switch (*end)
+			{
+			case 'm': return amount * 60;
+			case 'h': return amount * 60 * 60;
+			case 'd': return amount * 60 * 60 * 24;
+			case 'w': return amount * 60 * 60 * 24 * 7;
+			default: return std::nullopt;
+			}
+		};
+
+	LogFilter filter;
+
+	const auto lower_text = to_lower(text);
+
+	for (const auto token : split(lower_text, ' '))
+	{
+		const auto separator = token.find(':');
+
+		// bare words match the encounter name
+		if (separator == std::string_view::npos)
+		{
+			filter.terms.push_back({ IndexDimension::NAME, {}, { std::string(token) } });
+			continue;
+		}
+
+		const auto key = token.substr(0, separator);
+		const auto values = split(token.substr(separator + 1), ',');
+
+		if (values.empty())
+		{
+			filter.error_message = "Missing value for '" + std::string(key) + "'";
+			continue;
+		}
+
+		if (key == "since" || key == "after" || key == "before")
+		{
+			const auto seconds = key == "since" ? parse_age(values.front()) : parse_date(values.front());
+
+			if (!seconds.has_value())
+			{
+				filter.error_message = "Invalid " + std::string(key) + " value '" + std::string(values.front()) + "'";
+				continue;
+			}
+
+			if (key == "since")
+				filter.after = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count() - seconds.value();
+			else if (key == "after")
+				filter.after = seconds;
+			else
+				filter.before = seconds;
+
+			continue;
+		}
+
+		const auto dimension = dimensions.find(key);
+
+		if (dimension == dimensions.end())
+		{
+			filter.error_message = "Unknown filter '" + std::string(key) + "'";
+			continue;
+		}
+
+		LogFilterTerm term{ dimension->second };
+
+		for (const auto value : values)
+		{
+			if (term.dimension == IndexDimension::NAME || term.dimension == IndexDimension::ACCOUNT)
+				term.patterns.emplace_back(value);
+			else if (term.dimension == IndexDimension::TRIGGER)
+			{
+				uint64_t trigger_id = 0;
+
+				if (auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), trigger_id); error == std::errc() && end == value.data() + value.size())
+					term.keys.push_back(trigger_id);
+				else
+					filter.error_message = "Invalid trigger id '" + std::string(value) + "'";
+			}
+			else
+			{
+				const auto& values_by_name = enum_values.at(key);
+
+				if (auto it = values_by_name.find(value); it != values_by_name.end())
+					term.keys.push_back(it->second);
+				else
+					filter.error_message = "Invalid " + std::string(key) + " value '" + std::string(value) + "'";
+			}
+		}
+
+		if (!term.keys.empty() || !term.patterns.empty())
+			filter.terms.push_back(std::move(term));
+	}
+
+	return filter;
+}
+
+void LogIndex::update(const EncounterLogData& encounter_log_data, bool cold)
+{
+	const auto sequence = encounter_log_data.sequence;
+
+	if (sequence >= this->records.size())
+		this->records.resize(static_cast<size_t>(sequence) + 1);
+
+	auto& record = this->records[sequence];
+
+	decltype(record.keys) keys{};
+	keys[static_cast<size_t>(IndexDimension::TRIGGER)] = static_cast<uint64_t>(encounter_log_data.evtc_data.trigger_id);
+	keys[static_cast<size_t>(IndexDimension::NAME)] = get_key(encounter_log_data.view.name);
+	keys[static_cast<size_t>(IndexDimension::ACCOUNT)] = get_key(encounter_log_data.encounter_data.account_name);
+	keys[static_cast<size_t>(IndexDimension::RESULT)] = static_cast<uint64_t>(get_result(encounter_log_data));
+	keys[static_cast<size_t>(IndexDimension::DIFFICULTY)] = get_difficulty(encounter_log_data);
+	keys[static_cast<size_t>(IndexDimension::PARSE_STATUS)] = static_cast<uint64_t>(encounter_log_data.parse_status);
+	keys[static_cast<size_t>(IndexDimension::DPS_REPORT_STATUS)] = static_cast<uint64_t>(encounter_log_data.dps_report_upload.status);
+	keys[static_cast<size_t>(IndexDimension::WINGMAN_STATUS)] = static_cast<uint64_t>(encounter_log_data.wingman_upload.status);
+
+	for (size_t dimension = 0; dimension < keys.size(); dimension++)
+	{
+		if (record.indexed && record.keys[dimension] == keys[dimension])
+			continue;
+
+		auto& postings = this->postings[dimension];
+
+		if (record.indexed)
+		{
+			auto it = postings.find(record.keys[dimension]);
+
+			if (it != postings.end())
+			{
+				auto& list = it->second;
+				list.erase(std::lower_bound(list.begin(), list.end(), sequence));
+
+				if (list.empty())
+					postings.erase(it);
+			}
+		}
+
+		// sequences mostly grow, the insertion is usually an append
+		auto& list = postings[keys[dimension]];
+		list.insert(std::lower_bound(list.begin(), list.end(), sequence), sequence);
+	}
+
+	record.indexed = true;
+	record.cold = cold;
+	record.time = get_time(encounter_log_data);
+	record.keys = keys;
+}
+
+void LogIndex::clear()
+{
+	this->records.clear();
+
+	for (auto& postings : this->postings)
+		postings.clear();
+}
+
+auto LogIndex::get_postings(const LogFilterTerm& term) const -> std::vector<uint32_t>
+{
+	const auto& postings = this->postings[static_cast<size_t>(term.dimension)];
+
+	std::vector<const std::vector<uint32_t>*> lists;
+
+	if (term.is_text())
+	{
+		// only the distinct names are matched, not every log
+		for (const auto& [key, list] : postings)
+		{
+			const auto& text = *reinterpret_cast<const std::string*>(key);
+
+			if (std::any_of(term.patterns.begin(), term.patterns.end(), [&text](const std::string& pattern) { return contains_lower(text, pattern); }))
+				lists.push_back(&list);
+		}
+	}
+	else
+	{
+		for (const auto key : term.keys)
+			if (auto it = postings.find(key); it != postings.end())
+				lists.push_back(&it->second);
+	}
+
+	if (lists.size() == 1)
+		return *lists.front();
+
+	std::vector<uint32_t> result;
+
+	for (const auto list : lists)
+	{
+		std::vector<uint32_t> merged;
+		merged.reserve(result.size() + list->size());
+		std::merge(result.begin(), result.end(), list->begin(), list->end(), std::back_inserter(merged));
+		result = std::move(merged);
+	}
+
+	return result;
+}
+
+auto LogIndex::query(const LogFilter& filter) const -> LogQueryResult
+{
+	std::vector<std::vector<uint32_t>> term_postings;
+	term_postings.reserve(filter.terms.size());
+
+	for (const auto& term : filter.terms)
+	{
+		term_postings.push_back(this->get_postings(term));
+
+		if (term_postings.back().empty())
+			return {};
+	}
+
+	// intersect the most selective terms first
+	std::sort(term_postings.begin(), term_postings.end(), [](const auto& a, const auto& b) { return a.size() < b.size(); });
+
+	std::vector<uint32_t> candidates;
+
+	if (!term_postings.empty())
+	{
+		candidates = std::move(term_postings.front());
+
+		for (size_t i = 1; i < term_postings.size() && !candidates.empty(); i++)
+			candidates = intersect(candidates, term_postings[i]);
+	}
+	else
+	{
+		candidates.reserve(this->records.size());
+
+		for (uint32_t sequence = 0; sequence < this->records.size(); sequence++)
+			if (this->records[sequence].indexed)
+				candidates.push_back(sequence);
+	}
+
+	LogQueryResult result;
+
+	for (auto it = candidates.rbegin(); it != candidates.rend(); ++it)
+	{
+		const auto& record = this->records[*it];
+
+		if (filter.after.has_value() && record.time < filter.after.value())
+			continue;
+
+		if (filter.before.has_value() && record.time >= filter.before.value())
+			continue;
+
+		(record.cold ? result.cold_sequences : result.sequences).push_back(*it);
+	}
+
+	return result;
+}
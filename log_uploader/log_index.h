@@ -0,0 +1,106 @@
+#pragma once
+
+#include "encounter_log.h"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+enum class IndexDimension : size_t
+{
+	TRIGGER,
+	NAME,
+	ACCOUNT,
+	RESULT,
+	DIFFICULTY,
+	PARSE_STATUS,
+	DPS_REPORT_STATUS,
+	WINGMAN_STATUS,
+	_COUNT
+};
+
+enum class EncounterResult : uint64_t
+{
+	UNKNOWN,
+	SUCCESS,
+	FAILURE
+};
+
+class LogFilterTerm
+{
+public:
+	IndexDimension dimension = IndexDimension::TRIGGER;
+
+	std::vector<uint64_t> keys;		  // exact keys, or
+	std::vector<std::string> patterns; // lower case substrings matched against the interned names
+
+	auto is_text() const -> bool { return !this->patterns.empty(); }
+};
+
+/*
+Whitespace separated terms are combined with AND, comma separated values inside a term with OR.
+	boss:dhuum,sabetha  name:...    encounter name contains
+	account:name.1234               recording account contains
+	trigger:19450                   arcdps trigger id
+	result:success|failure|unknown
+	mode:nm|cm|lcm|unknown
+	parse:unparsed|queued|parsing|parsed|failed
+	dps:available|queued|uploading|uploaded|failed
+	wingman:unavailable|available|queued|uploading|uploaded|skipped|failed
+	since:30m|12h|7d|2w  after:2024-05-01  before:2024-05-31
+Bare words match the encounter name.
+*/
+class LogFilter
+{
+public:
+	static auto parse(std::string_view text) -> LogFilter;
+
+	std::vector<LogFilterTerm> terms;
+
+	std::optional<int64_t> after;  // seconds since epoch, inclusive
+	std::optional<int64_t> before; // seconds since epoch, exclusive
+
+	std::optional<std::string> error_message;
+
+	auto empty() const -> bool { return this->terms.empty() && !this->after.has_value() && !this->before.has_value(); }
+};
+
+class LogQueryResult
+{
+public:
+	std::vector<uint32_t> sequences;	  // loaded logs, newest first
+	std::vector<uint32_t> cold_sequences; // logs in the catalog, newest first
+};
+
+// secondary indexes over all logs of the session keyed by their sequence number
+class LogIndex
+{
+public:
+	void update(const EncounterLogData& encounter_log_data, bool cold = false);
+	void clear();
+
+	auto query(const LogFilter& filter) const -> LogQueryResult;
+
+private:
+	class Record
+	{
+	public:
+		bool indexed = false;
+		bool cold = false;
+
+		int64_t time = 0;
+
+		std::array<uint64_t, static_cast<size_t>(IndexDimension::_COUNT)> keys{};
+	};
+
+	std::vector<Record> records; // indexed by sequence
+
+	// sorted sequence lists per key
+	std::array<std::unordered_map<uint64_t, std::vector<uint32_t>>, static_cast<size_t>(IndexDimension::_COUNT)> postings;
+
+	auto get_postings(const LogFilterTerm& term) const -> std::vector<uint32_t>;
+};
@@ -1,27 +1,271 @@
 #include "dps_report_uploader.h"
 #include "elite_insights.h"
+#include "log_catalog.h"
 #include "log_manager.h"
 #include "logger.h"
+#include "settings.h"
+#include "wingman_uploader.h"
+
+#include <algorithm>
+#include <format>
 
 namespace global { std::unique_ptr<LogManager> log_manager = std::make_unique<LogManager>(); }
 
-#define LOG(message, log_level) global::logger->write(message, log_level, LogSource::LogManager)
+#define LOG(message, log_level) do { if (Logger::is_enabled(log_level)) global::logger->write(message, log_level, LogSource::LogManager); } while (0)
+#define LOG_FORMAT(log_level, ...) global::logger->write_format(log_level, LogSource::LogManager, __VA_ARGS__)
 
 void LogManager::add_encounter_log(EVTCData evtc_data)
 {
 	auto encounter_log = std::make_shared<EncounterLog>(evtc_data);
+	encounter_log->sequence = this->next_sequence++;
 
 	auto id = encounter_log->id;
 
+	global::logger->trace(TraceEvent::LOG_REGISTERED, LogSource::LogManager, hash_trace_id(id), static_cast<int64_t>(hash_trace_id(evtc_data.evtc_file_path.native())), evtc_data.root, static_cast<int64_t>(evtc_data.trigger_id));
+
 	global::dps_report_uploader->process_auto_upload(encounter_log);
 	global::elite_insights->process_auto_parse(encounter_log);
 
 	{
-		std::unique_lock lock(this->encounter_logs_mutex);
-		this->encounter_logs.push_front(encounter_log);
+		std::lock_guard lock(this->publish_mutex);
+
+		auto current = this->snapshot.load(std::memory_order_relaxed);
+		auto next = std::make_shared<EncounterLogSnapshot>(*current);
+
+		const auto session_id = this->session_tracker.add(*encounter_log);
+
+		{
+			std::lock_guard log_lock(encounter_log->mutex);
+			encounter_log->session_id = session_id;
+		}
+
+		encounter_log->published_generation = encounter_log->generation.load(std::memory_order_acquire);
+		auto encounter_log_data = std::make_shared<const EncounterLogData>(encounter_log->get_data());
+
+		// an auto parse can finish before the log is published, its result is not delivered to apply_changes
+		this->session_tracker.update(*encounter_log_data);
+
+		// detection workers add logs concurrently, a later sequence can be published first
+		auto position = std::lower_bound(next->rows.begin(), next->rows.end(), encounter_log->sequence, [](const EncounterLogRow& row, uint32_t sequence) { return std::get<1>(row)->sequence > sequence; });
+		next->rows.emplace(position, encounter_log, encounter_log_data);
+		next->sessions = this->session_tracker.get_sessions();
+		next->version = current->version + 1;
+
+		{
+			std::unique_lock index_lock(this->index_mutex);
+			this->index.update(*encounter_log_data);
+		}
+
+		this->enforce_working_set(next);
+
+		this->snapshot.store(std::move(next), std::memory_order_release);
+	}
+
+	LOG_FORMAT(LogLevel::Info, "Added encounter log: {}", id);
+}
+
+void LogManager::apply_changes(const std::vector<LogChangeEvent>& events)
+{
+	// the data is copied under the publish mutex so a concurrent older copy can never overwrite a newer one
+	std::lock_guard lock(this->publish_mutex);
+
+	auto current = this->snapshot.load(std::memory_order_relaxed);
+
+	std::shared_ptr<EncounterLogSnapshot> next;
+
+	std::unique_lock index_lock(this->index_mutex);
+
+	for (const auto& event : events)
+	{
+		auto row = current->find(event.encounter_log->sequence);
+
+		// evicted or not yet added, add_encounter_log copies the latest state itself
+		if (row == current->rows.end() || std::get<0>(*row) != event.encounter_log)
+			continue;
+
+		// changes are posted after they are made, a row copied at a later generation already holds this one
+		if (event.generation <= event.encounter_log->published_generation)
+			continue;
+
+		if (!next)
+			next = std::make_shared<EncounterLogSnapshot>(*current);
+
+		event.encounter_log->published_generation = event.encounter_log->generation.load(std::memory_order_acquire);
+		auto encounter_log_data = std::make_shared<const EncounterLogData>(event.encounter_log->get_data());
+
+		this->index.update(*encounter_log_data);
+		this->session_tracker.update(*encounter_log_data);
+
+		std::get<1>(next->rows[row - current->rows.begin()]) = std::move(encounter_log_data);
 	}
 
-	LOG("Added encounter log: " + id, LogLevel::Info);
+	index_lock.unlock();
+
+	if (!next)
+		return;
+
+	next->sessions = this->session_tracker.get_sessions();
+
+	// finished uploads can make further logs evictable
+	this->enforce_working_set(next);
+
+	next->version = current->version + 1;
+
+	this->snapshot.store(std::move(next), std::memory_order_release);
+}
+
+void LogManager::page_in(size_t count)
+{
+	this->restore(global::log_catalog->load(count));
+}
+
+void LogManager::page_in_sequences(const std::vector<uint32_t>& sequences)
+{
+	this->restore(global::log_catalog->load_sequences(sequences));
+}
+
+void LogManager::restore(std::vector<EncounterLogData> restored)
+{
+	if (restored.empty())
+		return;
+
+	std::lock_guard lock(this->publish_mutex);
+	std::unique_lock index_lock(this->index_mutex);
+
+	auto current = this->snapshot.load(std::memory_order_relaxed);
+	auto next = std::make_shared<EncounterLogSnapshot>(*current);
+
+	for (auto& restored_data : restored)
+	{
+		auto encounter_log = std::make_shared<EncounterLog>(std::move(restored_data));
+		auto encounter_log_data = std::make_shared<const EncounterLogData>(encounter_log->get_data());
+
+		this->index.update(*encounter_log_data);
+		this->pinned_sequences.insert(encounter_log_data->sequence);
+
+		// keep the rows ordered by sequence, evictions do not strictly follow it
+		auto position = std::lower_bound(next->rows.begin(), next->rows.end(), encounter_log_data->sequence, [](const EncounterLogRow& row, uint32_t sequence) { return std::get<1>(row)->sequence > sequence; });
+		next->rows.emplace(position, encounter_log, encounter_log_data);
+	}
+
+	index_lock.unlock();
+
+
+	next->version = current->version + 1;
+
+	this->snapshot.store(std::move(next), std::memory_order_release);
+
+	LOG_FORMAT(LogLevel::Debug, "Paged in {} encounter logs", restored.size());
+}
+
+void LogManager::enforce_working_set(std::shared_ptr<EncounterLogSnapshot>& next)
+{
+	if (!global::log_catalog->is_initialized())
+		return;
+
+	if (this->unpin_requested.exchange(false))
+		this->pinned_sequences.clear();
+
+	const auto limit = static_cast<size_t>(GET_SETTING(display.working_set_size)) + this->pinned_sequences.size();
+
+	if (next->rows.size() <= limit)
+		return;
+
+	const auto is_idle = [](const EncounterLogData& data) -> bool
+		{
+			return data.parse_status != ParseStatus::QUEUED && data.parse_status != ParseStatus::PARSING &&
+				data.dps_report_upload.status != DpsReportUploadStatus::QUEUED && data.dps_report_upload.status != DpsReportUploadStatus::UPLOADING &&
+				data.wingman_upload.status != WingmanUploadStatus::QUEUED && data.wingman_upload.status != WingmanUploadStatus::UPLOADING;
+		};
+
+	const auto is_fully_uploaded = [](const EncounterLogData& data) -> bool
+		{
+			return data.dps_report_upload.status == DpsReportUploadStatus::UPLOADED &&
+				(data.wingman_upload.status == WingmanUploadStatus::UPLOADED || data.wingman_upload.status == WingmanUploadStatus::SKIPPED || data.wingman_upload.status == WingmanUploadStatus::UNAVAILABLE);
+		};
+
+	auto excess = next->rows.size() - limit;
+
+	std::vector<bool> evict(next->rows.size(), false);
+	std::vector<EncounterLogData> evicted_data;
+	evicted_data.reserve(excess);
+
+	// rows are ordered newest first, walk from the back; candidates are confirmed on the live log since the row may trail a pending change
+	for (auto pass = 0; pass < 2 && excess > 0; pass++)
+	{
+		for (auto i = next->rows.size(); i-- > 0 && excess > 0;)
+		{
+			if (evict[i] || this->pinned_sequences.contains(std::get<1>(next->rows[i])->sequence))
+				continue;
+
+			const auto is_candidate = [&is_idle, &is_fully_uploaded, pass](const EncounterLogData& data) -> bool
+				{
+					return is_idle(data) && (pass > 0 || is_fully_uploaded(data));
+				};
+
+			if (!is_candidate(*std::get<1>(next->rows[i])))
+				continue;
+
+			auto data = std::get<0>(next->rows[i])->get_data();
+
+			if (!is_candidate(data))
+				continue;
+
+			evict[i] = true;
+			evicted_data.push_back(std::move(data));
+			excess--;
+		}
+	}
+
+	std::deque<EncounterLogRow> rows;
+
+	for (size_t i = 0; i < next->rows.size(); i++)
+	{
+		if (evict[i])
+			std::get<0>(next->rows[i])->retain_files = true;
+		else
+			rows.push_back(std::move(next->rows[i]));
+	}
+
+	next->rows = std::move(rows);
+
+	for (const auto& data : evicted_data)
+	{
+		global::log_catalog->store(data);
+		global::wingman_uploader->forget_check(data.evtc_data.evtc_file_path);
+
+		this->session_tracker.remove(data.sequence);
+
+		{
+			std::unique_lock index_lock(this->index_mutex);
+			this->index.update(data, true);
+		}
+	}
+
+	const auto evicted_count = evicted_data.size();
+
+	if (evicted_count > 0)
+		LOG_FORMAT(LogLevel::Debug, "Evicted {} encounter logs to the catalog", evicted_count);
+}
+
+void LogManager::dump_memory_usage()
+{
+	const auto snapshot = this->get_snapshot();
+
+	size_t record_bytes = 0;
+
+	for (const auto& [_, encounter_log_data] : snapshot->rows)
+		record_bytes += encounter_log_data->get_memory_usage();
+
+	const auto row_bytes = snapshot->rows.size() * sizeof(EncounterLogRow);
+	const auto interned_bytes = global::string_interner->get_memory_usage();
+	const auto total_bytes = record_bytes + row_bytes + interned_bytes;
+
+	LOG(std::format("Logs: {} | records: {} bytes | rows: {} bytes | interned strings: {} ({} bytes)", snapshot->rows.size(), record_bytes, row_bytes, global::string_interner->get_count(), interned_bytes), LogLevel::Info);
+
+	if (!snapshot->rows.empty())
+		LOG(std::format("Average: {} bytes per log", total_bytes / snapshot->rows.size()), LogLevel::Info);
 }
 
-#undef LOG
\ No newline at end of file
+#undef LOG
+#undef LOG_FORMAT
\ No newline at end of file
@@ -1,10 +1,39 @@
 #pragma once
 
+#include "change_bus.h"
 #include "encounter_log.h"
 #include "evtc_parser.h"
+#include "log_index.h"
+#include "session_tracker.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <deque>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+using EncounterLogRow = std::tuple<std::shared_ptr<EncounterLog>, std::shared_ptr<const EncounterLogData>>;
+
+// immutable view of all loaded encounter logs, ordered by descending sequence
+class EncounterLogSnapshot
+{
+public:
+	uint64_t version = 0;
+	std::deque<EncounterLogRow> rows;
+	std::shared_ptr<const std::vector<EncounterSession>> sessions = std::make_shared<const std::vector<EncounterSession>>(); // oldest first, also covers evicted logs
+
+	auto find(uint32_t sequence) const -> std::deque<EncounterLogRow>::const_iterator
+	{
+		auto it = std::lower_bound(this->rows.begin(), this->rows.end(), sequence, [](const EncounterLogRow& row, uint32_t sequence) { return std::get<1>(row)->sequence > sequence; });
+		return it != this->rows.end() && std::get<1>(*it)->sequence == sequence ? it : this->rows.end();
+	}
+};
 
 class LogManager
 {
@@ -12,24 +41,86 @@ public:
 	LogManager() {}
 	~LogManager() {}
 
-	auto get_encounter_logs() -> std::deque<std::shared_ptr<EncounterLog>> 
+	// lock free, the snapshot stays valid for as long as the caller holds it
+	auto get_snapshot() const -> std::shared_ptr<const EncounterLogSnapshot>
 	{
-		std::shared_lock lock(this->encounter_logs_mutex);
+		return this->snapshot.load(std::memory_order_acquire);
+	}
 
-		return this->encounter_logs; 
+	auto get_encounter_logs() const -> std::deque<std::shared_ptr<EncounterLog>>
+	{
+		std::deque<std::shared_ptr<EncounterLog>> encounter_logs;
+
+		for (const auto& [encounter_log, _] : this->get_snapshot()->rows)
+			encounter_logs.push_back(encounter_log);
+
+		return encounter_logs;
 	}
 
 	auto clear_encounter_logs() -> void
 	{
-		std::unique_lock lock(this->encounter_logs_mutex);
-		this->encounter_logs.clear();
+		std::lock_guard lock(this->publish_mutex);
+
+		{
+			std::unique_lock index_lock(this->index_mutex);
+			this->index.clear();
+		}
+
+		this->session_tracker.clear();
+		this->pinned_sequences.clear();
+
+		auto next = std::make_shared<EncounterLogSnapshot>();
+		next->version = this->snapshot.load(std::memory_order_relaxed)->version + 1;
+
+		this->snapshot.store(std::move(next), std::memory_order_release);
 	}
 
 	void add_encounter_log(EVTCData evtc_data);
 
+	// restores up to count of the most recently evicted logs from the catalog at the end of the list
+	void page_in(size_t count);
+
+	// restores the given logs from the catalog, used to bring back search results
+	void page_in_sequences(const std::vector<uint32_t>& sequences);
+
+	// lets the working set evict paged in logs again with the next published change, called once the user closes the window
+	void unpin_paged_in()
+	{
+		this->unpin_requested.store(true);
+	}
+
+	// evaluates the filter against the indexes of all loaded and evicted logs
+	auto query(const LogFilter& filter) -> LogQueryResult
+	{
+		std::shared_lock lock(this->index_mutex);
+		return this->index.query(filter);
+	}
+
+	// writes the memory held by the published log records to the log
+	void dump_memory_usage();
+
+	// change bus subscriber, replaces the rows of the changed logs with a copy of their current data
+	void apply_changes(const std::vector<LogChangeEvent>& events);
+
 private:
-	std::shared_mutex encounter_logs_mutex;
-	std::deque<std::shared_ptr<EncounterLog>> encounter_logs;
+	std::mutex publish_mutex;
+
+	std::unordered_set<uint32_t> pinned_sequences; // paged in logs, kept until the user unpins them
+	std::atomic<bool> unpin_requested = false;
+
+	std::atomic<uint32_t> next_sequence = 0;
+
+	std::shared_mutex index_mutex;
+	LogIndex index;
+
+	SessionTracker session_tracker;
+
+	void restore(std::vector<EncounterLogData> restored);
+
+	// moves the oldest idle logs to the catalog until the working set fits, fully uploaded logs are evicted first
+	void enforce_working_set(std::shared_ptr<EncounterLogSnapshot>& next);
+
+	std::atomic<std::shared_ptr<const EncounterLogSnapshot>> snapshot = std::make_shared<const EncounterLogSnapshot>();
 };
 
-namespace global { extern std::unique_ptr<LogManager> log_manager; }
\ No newline at end of file
+namespace global { extern std::unique_ptr<LogManager> log_manager; }
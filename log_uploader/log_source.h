@@ -0,0 +1,69 @@
+#pragma once
+
+// free of platform headers, shared with the trace decoder in tools/
+enum class LogSource
+{
+	Core,
+	DirectoryMonitor,
+	EVTCParser,
+	LogManager,
+	Settings,
+	EliteInsights,
+	DpsReportUploader,
+	WingmanUploader,
+	UI,
+	MumbleLink,
+	BandwidthLimiter,
+	EVTCCompressor,
+	HttpMetrics,
+	ChangeBus,
+	LogCatalog,
+	FileReclaimer,
+	ReportStore,
+	EncounterStatistics
+};
+
+constexpr auto get_log_source_name(LogSource source) -> const char*
+{
+	switch (source)
+	{
+	case LogSource::Core:
+		return "Core";
+	case LogSource::DirectoryMonitor:
+		return "Directory Monitor";
+	case LogSource::EVTCParser:
+		return "EVTC Parser";
+	case LogSource::LogManager:
+		return "Log Manager";
+	case LogSource::Settings:
+		return "Settings";
+	case LogSource::EliteInsights:
+		return "Elite Insights";
+	case LogSource::DpsReportUploader:
+		return "dps.report Uploader";
+	case LogSource::WingmanUploader:
+		return "Wingman Uploader";
+	case LogSource::UI:
+		return "UI";
+	case LogSource::MumbleLink:
+		return "Mumble Link";
+	case LogSource::BandwidthLimiter:
+		return "Bandwidth Limiter";
+	case LogSource::EVTCCompressor:
+		return "EVTC Compressor";
+	case LogSource::HttpMetrics:
+		return "HTTP Metrics";
+	case LogSource::ChangeBus:
+		return "Change Bus";
+	case LogSource::LogCatalog:
+		return "Log Catalog";
+	case LogSource::FileReclaimer:
+		return "File Reclaimer";
+	case LogSource::ReportStore:
+		return "Report Store";
+	case LogSource::EncounterStatistics:
+		return "Encounter Statistics";
+	default:
+		return "Unknown";
+	}
+}
@@ -1,10 +1,11 @@
 #include "logger.h"
 
+#include <algorithm>
 #include <iostream>
 
 namespace global { std::unique_ptr<Logger> logger = std::make_unique<Logger>(); }
 
-void Logger::initialize(std::filesystem::path log_file_path, HANDLE arcdps_handle)
+void Logger::initialize(std::filesystem::path log_file_path, HANDLE arcdps_handle, LogOverflowPolicy overflow_policy)
 {
 	std::lock_guard lock(this->initialization_mutex);
 
@@ -17,20 +18,33 @@ void Logger::initialize(std::filesystem::path log_file_path, HANDLE arcdps_handl
 	if (!std::filesystem::exists(log_file_path.parent_path()))
 		std::filesystem::create_directories(log_file_path.parent_path());
 
-	this->log_file = std::ofstream(log_file_path, std::ofstream::out | std::ofstream::trunc);
+	this->log_file_path = log_file_path;
+
+	// the log of the previous session is kept as log.1.txt
+	if (std::filesystem::exists(log_file_path))
+		this->rotate_log_file();
+	else
+		this->log_file.open(log_file_path, std::ofstream::out | std::ofstream::trunc);
 
 	if (!this->log_file.is_open())
 		throw std::runtime_error("Failed to open log file: " + log_file_path.string());
 
+	this->log_file_size = 0;
+	this->rotations = 0;
+	this->start_time = this->last_flush_time = std::chrono::steady_clock::now();
+
 	this->arcdps_log_function = reinterpret_cast<ArcdpsLogFunctionPtr>(GetProcAddress(reinterpret_cast<HMODULE>(arcdps_handle), "e8"));
 	this->arcdps_file_log_function = reinterpret_cast<ArcdpsLogFunctionPtr>(GetProcAddress(reinterpret_cast<HMODULE>(arcdps_handle), "e3"));
 
 	if (!this->arcdps_log_function || !this->arcdps_file_log_function)
 		throw std::runtime_error("Failed to get arcdps log functions");
 
-	this->message_handler_thread = std::thread(&Logger::write_thread, this);
+	this->overflow_policy = overflow_policy;
 
+	// the writer thread exits once it finds the logger released
 	this->initialized.store(true);
+
+	this->message_handler_thread = std::thread(&Logger::write_thread, this);
 }
 
 void Logger::release()
@@ -39,63 +53,340 @@ void Logger::release()
 
 	this->initialized.store(false);
 
-	this->message_queue_cv.notify_all();
+	{
+		std::lock_guard write_lock(this->write_mutex);
+		this->write_signal++;
+	}
+
+	this->write_cv.notify_all();
 
 	if (this->message_handler_thread.joinable())
 		this->message_handler_thread.join();
 }
 
-void Logger::write(const std::string& message, LogLevel level, LogSource source)
+void Logger::dump_metrics()
 {
-#ifndef _DEBUG
-	if (level == LogLevel::Debug)
-		return;
-#endif // !_DEBUG
+	const auto seconds = (std::max)(std::chrono::duration<double>(std::chrono::steady_clock::now() - this->start_time).count(), 1.);
+	const auto messages = this->written_messages.load();
+	const auto flushes = this->flushes.load();
+
+	this->write_format(LogLevel::Info, LogSource::Core, "Logger | messages: {} ({:.2f}/s) flushes: {} ({:.2f}/s) rotations: {} dropped: {} dropped trace records: {} coalesced arcdps calls: {} coalesced file lines: {}", messages, messages / seconds, flushes, flushes / seconds, this->rotations.load(), this->dropped_messages.load(), this->dropped_traces.load(), this->saved_game_calls.load(), this->saved_file_lines.load());
+}
 
-	if (!this->is_initialized())
+void Logger::trace(TraceEvent event, LogSource source, uint64_t log_id_hash, int64_t payload_0, int64_t payload_1, int64_t payload_2)
+{
+	if (!this->trace_enabled.load(std::memory_order_relaxed) || !this->is_initialized())
 		return;
 
+	TraceRecord record;
+	record.time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	record.log_id_hash = log_id_hash;
+	record.payload = { payload_0, payload_1, payload_2 };
+	record.thread_id = static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+	record.source = static_cast<uint16_t>(source);
+	record.event = static_cast<uint16_t>(event);
+
+	if (!this->trace_queue.try_push([&record](TraceRecord& slot) { slot = record; }))
 	{
-		std::lock_guard<std::mutex> lock(this->message_queue_mutex);
-		this->message_queue.push({ level, source, message });
+		this->dropped_traces.fetch_add(1, std::memory_order_relaxed);
+		return;
 	}
 
-	this->message_queue_cv.notify_one();
+	this->wake_writer();
+}
+
+void Logger::write(const std::string& message, LogLevel level, LogSource source)
+{
+	if (!is_enabled(level) || !this->is_initialized())
+		return;
+
+	this->push([&](LogMessage& log_message)
+		{
+			log_message.level = level;
+			log_message.source = source;
+			log_message.message.assign(message); // reuses the capacity of the slot
+		});
 }
 
 void Logger::write_thread()
 {
+	// swapped with the queue slots, the message buffers circulate instead of being reallocated
+	std::vector<LogMessage> batch(max_batch_size);
+	uint64_t reported_drops = 0;
+
 	while (true)
 	{
-		std::unique_lock<std::mutex> lock(this->message_queue_mutex);
+		size_t batch_size = 0;
+
+		const auto take = [&](LogMessage& log_message)
+			{
+				auto& batch_message = batch[batch_size];
+
+				batch_message.level = log_message.level;
+				batch_message.source = log_message.source;
+				batch_message.format = {};
+
+				if (log_message.deferred_format.is_pending())
+				{
+					batch_message.message.clear();
+					batch_message.format = log_message.deferred_format.get_format();
+					log_message.deferred_format.format_to(batch_message.message);
+				}
+				else
+					std::swap(batch_message.message, log_message.message);
+			};
+
+		while (batch_size < batch.size() && this->message_queue.try_pop(take))
+			batch_size++;
+
+		const auto trace_count = this->trace_buffer.size();
+		this->take_traces();
+
+		this->expire_coalesced_messages(batch_size == 0 && !this->is_initialized());
 
-		this->message_queue_cv.wait(lock, [this]
+		if (batch_size == 0)
+		{
+			if (this->trace_buffer.size() > trace_count)
+				continue;
+
+			// written in one go once a burst of messages is over
+			this->flush_log_file();
+			this->flush_trace_file();
+
+			if (!this->is_initialized())
+				break;
+
+			std::unique_lock write_lock(this->write_mutex);
+
+			const auto signal = this->write_signal;
+
+			this->writer_waiting.store(true, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			// repeats are written once their window ends even if nothing else is logged
+			if (this->message_queue.empty() && this->trace_queue.empty() && this->is_initialized())
 			{
-				return !this->message_queue.empty() || !this->is_initialized();
+				const auto signaled = [this, signal] { return this->write_signal != signal; };
+
+				if (this->coalesce_deadline == std::chrono::steady_clock::time_point::max())
+					this->write_cv.wait(write_lock, signaled);
+				else
+					this->write_cv.wait_until(write_lock, this->coalesce_deadline, signaled);
 			}
-		);
 
-		if (!this->is_initialized() && this->message_queue.empty())
-			break;
+			this->writer_waiting.store(false, std::memory_order_relaxed);
+			continue;
+		}
+
+		if (const auto drops = this->dropped_messages.load(std::memory_order_relaxed); drops != reported_drops)
+		{
+			this->write_message({ LogLevel::Warning, LogSource::Core, std::to_string(drops - reported_drops) + " log messages were dropped, the log queue was full" });
+			reported_drops = drops;
+		}
+
+		for (size_t i = 0; i < batch_size; i++)
+			this->write_message(batch[i]);
+
+		if (this->log_file_buffer.size() >= flush_size || std::chrono::steady_clock::now() - this->last_flush_time >= flush_interval)
+		{
+			this->flush_log_file();
+			this->flush_trace_file();
+		}
+	}
+}
+
+void Logger::write_message(const LogMessage& log_message)
+{
+	const auto now = std::chrono::steady_clock::now();
+
+	this->written_messages.fetch_add(1, std::memory_order_relaxed);
+
+	// formatted messages are grouped by their call site, plain messages by their text
+	auto key = std::string{ static_cast<char>(log_message.source), static_cast<char>(log_message.level) };
+	key += log_message.format.empty() ? std::string_view(log_message.message) : log_message.format;
+
+	auto [it, inserted] = this->coalesced_messages.try_emplace(std::move(key));
+	auto& coalesced_message = it->second;
+
+	if (!inserted && now - coalesced_message.window_start < coalesce_window)
+	{
+		coalesced_message.game_repeats++;
+		this->saved_game_calls.fetch_add(1, std::memory_order_relaxed);
+
+		// lines of one call site may still differ, e.g. by log id, those are kept in the log file
+		if (log_message.message == coalesced_message.last_message)
+		{
+			coalesced_message.file_repeats++;
+			this->saved_file_lines.fetch_add(1, std::memory_order_relaxed);
+		}
+		else
+		{
+			this->write_file_repeats(coalesced_message);
+			this->write_to_file(log_message);
+			coalesced_message.last_message = log_message.message;
+		}
+
+		return;
+	}
+
+	if (!inserted)
+	{
+		this->write_game_repeats(coalesced_message);
+		this->write_file_repeats(coalesced_message);
+	}
+
+	coalesced_message.window_start = now;
+	coalesced_message.level = log_message.level;
+	coalesced_message.source = log_message.source;
+	coalesced_message.last_message = log_message.message;
+
+	this->write_to_game(log_message);
+	this->write_to_file(log_message);
+}
 
-		auto log_message = this->message_queue.front();
-		this->message_queue.pop();
+void Logger::write_to_game(const LogMessage& log_message)
+{
+	if (this->arcdps_log_function)
+		this->arcdps_log_function(const_cast<char*>(this->format_log_message_arc(log_message).c_str()));
 
-		lock.unlock();
+	if (log_message.level == LogLevel::Error && this->arcdps_file_log_function)
+		this->arcdps_file_log_function(const_cast<char*>(this->format_log_message_arc_file(log_message).c_str()));
+}
 
+void Logger::write_to_file(const LogMessage& log_message)
+{
 #ifdef _DEBUG
-		std::cout << this->format_log_message(log_message) << std::endl;
+	std::cout << this->format_log_message(log_message) << std::endl;
 #endif // _DEBUG
 
-		if (this->arcdps_log_function)
-			this->arcdps_log_function(const_cast<char*>(this->format_log_message_arc(log_message).c_str()));
+	this->log_file_buffer += this->format_log_message(log_message);
+	this->log_file_buffer += '\n';
+
+	// the game may crash right after an error
+	if (log_message.level == LogLevel::Error)
+		this->flush_log_file();
+}
 
-		if (log_message.level == LogLevel::Error && this->arcdps_file_log_function)
-			this->arcdps_file_log_function(const_cast<char*>(this->format_log_message_arc_file(log_message).c_str()));
+void Logger::write_game_repeats(CoalescedMessage& coalesced_message)
+{
+	if (coalesced_message.game_repeats == 0)
+		return;
 
-		if (this->log_file.is_open())
-			this->log_file << this->format_log_message(log_message) << std::endl;
+	this->write_to_game({ coalesced_message.level, coalesced_message.source, coalesced_message.last_message + " (x" + std::to_string(coalesced_message.game_repeats) + ")" });
+	coalesced_message.game_repeats = 0;
+}
+
+void Logger::write_file_repeats(CoalescedMessage& coalesced_message)
+{
+	if (coalesced_message.file_repeats == 0)
+		return;
+
+	this->write_to_file({ coalesced_message.level, coalesced_message.source, coalesced_message.last_message + " (x" + std::to_string(coalesced_message.file_repeats) + ")" });
+	coalesced_message.file_repeats = 0;
+}
+
+void Logger::expire_coalesced_messages(bool all)
+{
+	const auto now = std::chrono::steady_clock::now();
 
+	this->coalesce_deadline = std::chrono::steady_clock::time_point::max();
+
+	for (auto it = this->coalesced_messages.begin(); it != this->coalesced_messages.end();)
+	{
+		auto& coalesced_message = it->second;
+
+		if (!all && now - coalesced_message.window_start < coalesce_window)
+		{
+			// windows without repeats end silently, they do not need to wake the writer
+			if (coalesced_message.game_repeats > 0 || coalesced_message.file_repeats > 0)
+				this->coalesce_deadline = (std::min)(this->coalesce_deadline, coalesced_message.window_start + coalesce_window);
+
+			it++;
+			continue;
+		}
+
+		this->write_game_repeats(coalesced_message);
+		this->write_file_repeats(coalesced_message);
+		it = this->coalesced_messages.erase(it);
+	}
+}
+
+void Logger::flush_log_file()
+{
+	this->last_flush_time = std::chrono::steady_clock::now();
+
+	if (this->log_file_buffer.empty())
+		return;
+
+	if (this->log_file.is_open())
+	{
+		this->log_file.write(this->log_file_buffer.data(), static_cast<std::streamsize>(this->log_file_buffer.size()));
 		this->log_file.flush();
+
+		this->log_file_size += this->log_file_buffer.size();
+		this->flushes.fetch_add(1, std::memory_order_relaxed);
 	}
+
+	this->log_file_buffer.clear();
+
+	if (this->log_file_size >= max_log_file_size)
+		this->rotate_log_file();
+}
+
+void Logger::take_traces()
+{
+	while (this->trace_queue.try_pop([this](const TraceRecord& record) { this->trace_buffer.push_back(record); }))
+	{
+		if (this->trace_buffer.size() * sizeof(TraceRecord) >= flush_size)
+			this->flush_trace_file();
+	}
+}
+
+void Logger::flush_trace_file()
+{
+	if (this->trace_buffer.empty())
+		return;
+
+	// created on the first record, a new trace per session
+	if (!this->trace_file.is_open())
+	{
+		this->trace_file.open(this->log_file_path.parent_path() / "trace.bin", std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+
+		TraceFileHeader header;
+		header.record_size = sizeof(TraceRecord);
+		header.steady_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		header.system_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+		this->trace_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	}
+
+	this->trace_file.write(reinterpret_cast<const char*>(this->trace_buffer.data()), static_cast<std::streamsize>(this->trace_buffer.size() * sizeof(TraceRecord)));
+	this->trace_file.flush();
+
+	this->trace_buffer.clear();
+}
+
+void Logger::rotate_log_file()
+{
+	this->log_file.close();
+
+	std::error_code error;
+
+	// the oldest log is overwritten
+	for (auto index = max_rotated_log_files; index > 0; index--)
+		std::filesystem::rename(index == 1 ? this->log_file_path : this->get_rotated_log_file_path(index - 1), this->get_rotated_log_file_path(index), error);
+
+	this->log_file.open(this->log_file_path, std::ofstream::out | std::ofstream::trunc);
+	this->log_file_size = 0;
+
+	this->rotations.fetch_add(1, std::memory_order_relaxed);
+}
+
+auto Logger::get_rotated_log_file_path(int index) const -> std::filesystem::path
+{
+	auto file_name = this->log_file_path.stem();
+	file_name += "." + std::to_string(index);
+	file_name += this->log_file_path.extension();
+
+	return this->log_file_path.parent_path() / file_name;
 }
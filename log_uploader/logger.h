@@ -2,14 +2,20 @@
 
 #include "module.h"
 #include "arcdps.h"
+#include "bounded_ring.h"
+#include "deferred_format.h"
+#include "log_source.h"
+#include "trace_format.h"
 
 #include <filesystem>
 #include <atomic>
-#include <mutex>
-#include <queue>
+#include <chrono>
 #include <condition_variable>
 #include <fstream>
+#include <mutex>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 enum class LogLevel
 {
@@ -19,25 +25,20 @@ enum class LogLevel
 	Debug
 };
 
-enum class LogSource
-{
-	Core,
-	DirectoryMonitor,
-	EVTCParser,
-	LogManager,
-	Settings,
-	EliteInsights,
-	DpsReportUploader,
-	WingmanUploader,
-	UI,
-	MumbleLink
-};
-
 struct LogMessage
 {
 	LogLevel level = LogLevel::Info;
 	LogSource source = LogSource::Core;
 	std::string message;
+	DeferredFormat deferred_format; // formatted into message by the writer thread when pending
+	std::string_view format; // format string of a formatted message, groups repeated messages of one call site
+};
+
+// what a write does while the writer thread is behind and the queue is full
+enum class LogOverflowPolicy
+{
+	DROP_OLDEST,
+	DROP_NEWEST
 };
 
 class Logger : public Module
@@ -46,34 +47,189 @@ public:
 	Logger() {}
 	~Logger() {}
 
-	void initialize(std::filesystem::path log_file_path, HANDLE arcdps_handle);
+	void initialize(std::filesystem::path log_file_path, HANDLE arcdps_handle, LogOverflowPolicy overflow_policy = LogOverflowPolicy::DROP_OLDEST);
 	void release() override;
 
+	// debug messages are only written by debug builds, checked before a message is built
+	static constexpr auto is_enabled(LogLevel level) -> bool
+	{
+#ifdef _DEBUG
+		return true;
+#else
+		return level != LogLevel::Debug;
+#endif // _DEBUG
+	}
+
+	// writes the message, flush and rotation counters to the log
+	void dump_metrics();
+
+	// pipeline events are appended to trace.bin next to the log file while enabled, see tools/trace_decoder
+	void set_trace_enabled(bool enabled) { this->trace_enabled.store(enabled, std::memory_order_relaxed); }
+
+	// a fixed size record, nothing is formatted or allocated, a no-op while tracing is disabled
+	void trace(TraceEvent event, LogSource source, uint64_t log_id_hash, int64_t payload_0 = 0, int64_t payload_1 = 0, int64_t payload_2 = 0);
+
+	// never blocks, called from every thread including the render thread
 	void write(const std::string& message, LogLevel level = LogLevel::Info, LogSource source = LogSource::Core);
 
+	// checked at compile time like std::format, the message is only formatted on the writer thread
+	template <typename... Args>
+	void write_format(LogLevel level, LogSource source, std::format_string<Args...> format, Args&&... args)
+	{
+		if (!is_enabled(level) || !this->is_initialized())
+			return;
+
+		if constexpr (DeferredFormat::fits<Args...>)
+		{
+			this->push([&](LogMessage& log_message)
+				{
+					log_message.level = level;
+					log_message.source = source;
+					log_message.deferred_format.store(format.get(), std::forward<Args>(args)...);
+				});
+		}
+		else
+			this->write(std::format(format, std::forward<Args>(args)...), level, source);
+	}
+
 private:
-	std::mutex message_queue_mutex;
-	std::condition_variable message_queue_cv;
-	std::queue<LogMessage> message_queue;
+	static constexpr size_t message_queue_capacity = 4096;
+	static constexpr size_t max_batch_size = 256;
+
+	// the log file is flushed once the queue is drained, after flush_size bytes or after flush_interval while busy, errors are flushed right away
+	static constexpr size_t flush_size = 64 * 1024;
+	static constexpr auto flush_interval = std::chrono::seconds(1);
+
+	// repeats of a message within the window are collapsed into one "(xN)" line at its end
+	// arcdps chat gets one line per call site, the log file keeps every line that differs from the one before
+	static constexpr auto coalesce_window = std::chrono::seconds(10);
+
+	// log.txt is rotated to log.1.txt, log.2.txt, ... at startup and whenever it grows beyond max_log_file_size
+	static constexpr uintmax_t max_log_file_size = 8 * 1024 * 1024;
+	static constexpr int max_rotated_log_files = 3;
+
+	// writers fill the slots in place, after a while no write allocates
+	BoundedRing<LogMessage> message_queue{ message_queue_capacity };
+	LogOverflowPolicy overflow_policy = LogOverflowPolicy::DROP_OLDEST;
+	std::atomic<uint64_t> dropped_messages = 0;
+
+	// the writer thread sleeps on the signal, writers only take the mutex to wake it while it is waiting
+	std::atomic<bool> writer_waiting = false;
+	std::mutex write_mutex;
+	std::condition_variable write_cv;
+	uint32_t write_signal = 0;
+
+	static constexpr size_t trace_queue_capacity = 4096;
+
+	BoundedRing<TraceRecord> trace_queue{ trace_queue_capacity };
+	std::atomic<bool> trace_enabled = false;
+	std::atomic<uint64_t> dropped_traces = 0; // newest records are dropped, a trace keeps its beginning
 
 	std::thread message_handler_thread;
+
+	// only used by the writer thread
+	std::filesystem::path log_file_path;
 	std::ofstream log_file;
+	std::string log_file_buffer; // lines not yet written to the log file
+	uintmax_t log_file_size = 0;
+	std::chrono::steady_clock::time_point last_flush_time;
+
+	std::ofstream trace_file;
+	std::vector<TraceRecord> trace_buffer; // records not yet written to the trace file
+
+	class CoalescedMessage
+	{
+	public:
+		std::chrono::steady_clock::time_point window_start;
+		LogLevel level = LogLevel::Info;
+		LogSource source = LogSource::Core;
+		std::string last_message;
+		uint64_t game_repeats = 0; // not sent to arcdps
+		uint64_t file_repeats = 0; // identical lines in a row not written to the log file
+	};
+
+	std::unordered_map<std::string, CoalescedMessage> coalesced_messages; // by source, level and format
+	std::chrono::steady_clock::time_point coalesce_deadline = std::chrono::steady_clock::time_point::max(); // earliest window end with repeats to write
+
+	std::chrono::system_clock::time_point cached_timestamp_time;
+	std::string cached_timestamp;
+
+	std::chrono::steady_clock::time_point start_time;
+	std::atomic<uint64_t> written_messages = 0;
+	std::atomic<uint64_t> flushes = 0;
+	std::atomic<uint64_t> rotations = 0;
+	std::atomic<uint64_t> saved_game_calls = 0;
+	std::atomic<uint64_t> saved_file_lines = 0;
 
 	ArcdpsLogFunctionPtr arcdps_log_function = nullptr;
 	ArcdpsLogFunctionPtr arcdps_file_log_function = nullptr;
 
+	template <typename Fill>
+	void push(const Fill& fill)
+	{
+		while (!this->message_queue.try_push(fill))
+		{
+			if (this->overflow_policy == LogOverflowPolicy::DROP_NEWEST)
+			{
+				this->dropped_messages.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			// the writer thread may have made room in the meantime, then nothing is dropped
+			if (this->message_queue.try_pop([](LogMessage& log_message) { log_message.deferred_format.reset(); }))
+				this->dropped_messages.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		this->wake_writer();
+	}
+
+	void wake_writer()
+	{
+		// pairs with the fence in write_thread, either the writer sees the message or the writer is seen waiting
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (this->writer_waiting.load(std::memory_order_relaxed))
+		{
+			{
+				std::lock_guard lock(this->write_mutex);
+				this->write_signal++;
+			}
+
+			this->write_cv.notify_one();
+		}
+	}
+
 	void write_thread();
+	void write_message(const LogMessage& log_message);
+	void write_to_game(const LogMessage& log_message);
+	void write_to_file(const LogMessage& log_message);
+	void write_game_repeats(CoalescedMessage& coalesced_message);
+	void write_file_repeats(CoalescedMessage& coalesced_message);
+	void expire_coalesced_messages(bool all);
+	void flush_log_file();
+	void take_traces();
+	void flush_trace_file();
+	void rotate_log_file();
+	auto get_rotated_log_file_path(int index) const -> std::filesystem::path;
 
-	auto get_timestamp() -> std::string
+	// only formatted once per second
+	auto get_timestamp() -> const std::string&
 	{
-		auto now = std::chrono::system_clock::now();
+		auto now = std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now());
+
+		if (now == this->cached_timestamp_time && !this->cached_timestamp.empty())
+			return this->cached_timestamp;
+
 		auto now_time_t = std::chrono::system_clock::to_time_t(now);
 		std::tm now_tm = {};
 		localtime_s(&now_tm, &now_time_t);
 		std::stringstream ss;
 		ss << std::put_time(&now_tm, "%Y-%m-%d %H:%M:%S");
 
-		return ss.str();
+		this->cached_timestamp_time = now;
+		this->cached_timestamp = ss.str();
+
+		return this->cached_timestamp;
 	};
 
 	auto get_log_level_string(LogLevel level) -> std::string
@@ -95,31 +251,7 @@ private:
 
 	auto get_log_source_string(LogSource source) -> std::string
 	{
-		switch (source)
-		{
-		case LogSource::Core:
-			return "Core";
-		case LogSource::DirectoryMonitor:
-			return "Directory Monitor";
-		case LogSource::EVTCParser:
-			return "EVTC Parser";
-		case LogSource::LogManager:
-			return "Log Manager";
-		case LogSource::Settings:
-			return "Settings";
-		case LogSource::EliteInsights:
-			return "Elite Insights";
-		case LogSource::DpsReportUploader:
-			return "dps.report Uploader";
-		case LogSource::WingmanUploader:
-			return "Wingman Uploader";
-		case LogSource::UI:
-			return "UI";
-		case LogSource::MumbleLink:
-			return "Mumble Link";
-		default:
-			return "Unknown";
-		}
+		return get_log_source_name(source);
 	};
 
 	auto format_log_message(const LogMessage& log_message) -> std::string
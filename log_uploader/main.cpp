@@ -1,11 +1,17 @@
 #include "arcdps.h"
+#include "change_bus.h"
 #include "directory_monitor.h"
 #include "dps_report_uploader.h"
 #include "elite_insights.h"
+#include "encounter_statistics.h"
+#include "evtc_compressor.h"
+#include "file_reclaimer.h"
 #include "global.h"
+#include "log_catalog.h"
 #include "log_manager.h"
 #include "logger.h"
 #include "mumble_link.h"
+#include "report_store.h"
 #include "settings.h"
 #include "ui.h"
 #include "wingman_uploader.h"
@@ -18,7 +24,8 @@
 #include <ShlObj.h>
 #include <Windows.h>
 
-#define LOG(message, log_level) global::logger->write(message, log_level, LogSource::Core)
+#define LOG(message, log_level) do { if (Logger::is_enabled(log_level)) global::logger->write(message, log_level, LogSource::Core); } while (0)
+#define LOG_FORMAT(log_level, ...) global::logger->write_format(log_level, LogSource::Core, __VA_ARGS__)
 
 std::atomic<bool> initialized = false;
 
@@ -85,7 +92,7 @@ uintptr_t mod_combat(cbtevent* ev, ag* src, ag* dst, const char* skillname, uint
 		if (account_name.at(0) == ':')
 			account_name.erase(0, 1);
 
-		LOG("Account name set to: " + account_name, LogLevel::Debug);
+		LOG_FORMAT(LogLevel::Debug, "Account name set to: {}", account_name);
 
 		static auto mumble_link_disabled = false;
 
@@ -275,13 +282,30 @@ extern "C" __declspec(dllexport) void* get_init_addr(char* arcversion, ImGuiCont
 				dx_swap_chain->GetDevice(__uuidof(ID3D11Device), reinterpret_cast<void**>(&d3d_device));*/
 
 			global::settings->initialize(data_path / "settings.json");
+			global::logger->set_trace_enabled(GET_SETTING(diagnostics.trace_pipeline));
 			global::mumble_link->initialize();
 			global::ui->initialize();
 
+			global::change_bus->subscribe([](const std::vector<LogChangeEvent>& events) { global::log_manager->apply_changes(events); });
+			global::change_bus->initialize();
+
 			initialization_thread = std::thread([data_path, boss_encounter_path]() -> void
 				{
+					global::file_reclaimer->initialize(data_path / "data");
+					global::report_store->initialize(data_path / "data");
 					global::elite_insights->initialize(data_path / "elite-insights", data_path / "data");
-					global::directory_monitor->initialize(boss_encounter_path);
+					global::evtc_compressor->initialize(data_path / "data");
+					global::log_catalog->initialize(data_path / "data" / "catalog.jsonl");
+					global::encounter_statistics->initialize(data_path / "statistics.json");
+
+					// settings hold utf-8 paths
+					std::vector<std::filesystem::path> monitor_directories = { boss_encounter_path };
+
+					for (const auto& directory : GET_SETTING(monitor.additional_directories))
+						monitor_directories.push_back(std::filesystem::path(std::u8string(directory.begin(), directory.end())));
+
+					global::directory_monitor->initialize(monitor_directories);
+
 					global::dps_report_uploader->initialize();
 					global::wingman_uploader->initialize();
 
@@ -310,9 +334,18 @@ extern "C" __declspec(dllexport) void* get_release_addr()
 
 			global::directory_monitor->release();
 			global::elite_insights->release();
+			global::encounter_statistics->release();
 			global::dps_report_uploader->release();
 			global::wingman_uploader->release();
+			global::change_bus->release();
+			global::log_catalog->release();
 			global::ui->release();
+
+			// drop the remaining logs while the reclaimer can still take their files
+			global::log_manager->clear_encounter_logs();
+			global::report_store->release();
+			global::file_reclaimer->release();
+
 			global::mumble_link->release();
 			global::settings->release();
 			global::logger->release();
@@ -323,4 +356,5 @@ extern "C" __declspec(dllexport) void* get_release_addr()
 	return mod_release;
 }
 
-#undef LOG
\ No newline at end of file
+#undef LOG
+#undef LOG_FORMAT
\ No newline at end of file
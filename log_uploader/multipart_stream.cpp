@@ -0,0 +1,172 @@
+#include "multipart_stream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <random>
+#include <stdexcept>
+
+MappedFile::MappedFile(const std::filesystem::path& file_path)
+{
+	this->file_handle = CreateFileW(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	if (this->file_handle == INVALID_HANDLE_VALUE)
+		throw std::runtime_error("Failed to open file: " + file_path.string());
+
+	LARGE_INTEGER file_size = {};
+
+	if (!GetFileSizeEx(this->file_handle, &file_size))
+	{
+		CloseHandle(this->file_handle);
+		throw std::runtime_error("Failed to get file size: " + file_path.string());
+	}
+
+	this->view_size = static_cast<uint64_t>(file_size.QuadPart);
+
+	if (this->view_size == 0) // empty files can not be mapped
+		return;
+
+	this->mapping_handle = CreateFileMappingW(this->file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	if (this->mapping_handle == nullptr)
+	{
+		CloseHandle(this->file_handle);
+		throw std::runtime_error("Failed to create file mapping: " + file_path.string());
+	}
+
+	this->view = static_cast<const uint8_t*>(MapViewOfFile(this->mapping_handle, FILE_MAP_READ, 0, 0, 0));
+
+	if (this->view == nullptr)
+	{
+		CloseHandle(this->mapping_handle);
+		CloseHandle(this->file_handle);
+		throw std::runtime_error("Failed to map file: " + file_path.string());
+	}
+}
+
+MappedFile::~MappedFile()
+{
+	if (this->view != nullptr)
+		UnmapViewOfFile(this->view);
+
+	if (this->mapping_handle != nullptr)
+		CloseHandle(this->mapping_handle);
+
+	if (this->file_handle != INVALID_HANDLE_VALUE)
+		CloseHandle(this->file_handle);
+}
+
+MultipartStream::MultipartStream()
+{
+	std::random_device random_device;
+	std::mt19937_64 generator(random_device());
+
+	this->boundary = std::format("----LogUploaderBoundary{:016x}", generator());
+}
+
+void MultipartStream::add_field(const std::string& name, const std::string& value)
+{
+	if (this->finalized)
+		throw std::logic_error("Multipart stream already finalized");
+
+	this->segments.push_back({ std::format("--{}\r\nContent-Disposition: form-data; name=\"{}\"\r\n\r\n{}\r\n", this->boundary, name, value), nullptr });
+}
+
+void MultipartStream::add_file(const std::string& name, const std::filesystem::path& file_path, const std::string& file_name)
+{
+	if (this->finalized)
+		throw std::logic_error("Multipart stream already finalized");
+
+	auto file = std::make_shared<MappedFile>(file_path);
+
+	this->segments.push_back({ std::format("--{}\r\nContent-Disposition: form-data; name=\"{}\"; filename=\"{}\"\r\nContent-Type: application/octet-stream\r\n\r\n", this->boundary, name, file_name), nullptr });
+	this->segments.push_back({ "", std::move(file) });
+	this->segments.push_back({ "\r\n", nullptr });
+}
+
+void MultipartStream::add_file(const std::string& name, std::shared_ptr<MultipartSource> source, const std::string& file_name)
+{
+	if (this->finalized)
+		throw std::logic_error("Multipart stream already finalized");
+
+	if (!source)
+		throw std::invalid_argument("Multipart source is null");
+
+	this->segments.push_back({ std::format("--{}\r\nContent-Disposition: form-data; name=\"{}\"; filename=\"{}\"\r\nContent-Type: application/octet-stream\r\n\r\n", this->boundary, name, file_name), nullptr });
+	this->segments.push_back({ "", nullptr, std::move(source) });
+	this->segments.push_back({ "\r\n", nullptr });
+}
+
+auto MultipartStream::get_content_length() -> uint64_t
+{
+	this->finalize();
+
+	uint64_t content_length = 0;
+
+	for (const auto& segment : this->segments)
+		content_length += segment.size();
+
+	return content_length;
+}
+
+auto MultipartStream::get_content_type() const -> std::string
+{
+	return "multipart/form-data; boundary=" + this->boundary;
+}
+
+auto MultipartStream::create_read_callback() -> cpr::ReadCallback
+{
+	const auto content_length = static_cast<cpr::cpr_off_t>(this->get_content_length());
+
+	return cpr::ReadCallback(content_length, [this](char* buffer, size_t& size, intptr_t) -> bool
+		{
+			size = this->read(buffer, size);
+			return !this->failed;
+		});
+}
+
+auto MultipartStream::read(char* buffer, size_t size) -> size_t
+{
+	this->finalize();
+
+	size_t written = 0;
+
+	while (written < size && this->segment_index < this->segments.size())
+	{
+		const auto& segment = this->segments[this->segment_index];
+
+		const auto available = segment.size() - this->segment_offset;
+		const auto count = static_cast<size_t>(std::min<uint64_t>(available, size - written));
+
+		if (count > 0)
+		{
+			if (!segment.source)
+				std::memcpy(buffer + written, segment.data() + this->segment_offset, count);
+			else if (!segment.source->read(this->segment_offset, reinterpret_cast<uint8_t*>(buffer) + written, count))
+			{
+				this->failed = true;
+				return written;
+			}
+		}
+
+		written += count;
+		this->segment_offset += count;
+
+		if (this->segment_offset >= segment.size())
+		{
+			this->segment_index++;
+			this->segment_offset = 0;
+		}
+	}
+
+	return written;
+}
+
+void MultipartStream::finalize()
+{
+	if (this->finalized)
+		return;
+
+	this->segments.push_back({ "--" + this->boundary + "--\r\n", nullptr });
+	this->finalized = true;
+}
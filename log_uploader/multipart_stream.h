@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include <Windows.h>
+
+#include <cpr/cpr.h>
+
+// read-only view of a whole file, pages are loaded on demand by the os
+class MappedFile
+{
+public:
+	MappedFile(const std::filesystem::path& file_path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	auto data() const -> const uint8_t* { return this->view; }
+	auto size() const -> uint64_t { return this->view_size; }
+
+private:
+	HANDLE file_handle = INVALID_HANDLE_VALUE;
+	HANDLE mapping_handle = nullptr;
+
+	const uint8_t* view = nullptr;
+	uint64_t view_size = 0;
+};
+
+// file content that is produced while streaming instead of being read from a file on disk
+class MultipartSource
+{
+public:
+	virtual ~MultipartSource() {}
+
+	virtual auto size() const -> uint64_t = 0;
+
+	// reads exactly size bytes at the offset, returns false when the content is no longer available
+	virtual auto read(uint64_t offset, uint8_t* buffer, size_t size) -> bool = 0;
+};
+
+// multipart/form-data request body streamed from memory-mapped files through a cpr read callback
+class MultipartStream
+{
+public:
+	MultipartStream();
+
+	void add_field(const std::string& name, const std::string& value);
+	void add_file(const std::string& name, const std::filesystem::path& file_path, const std::string& file_name);
+	void add_file(const std::string& name, std::shared_ptr<MultipartSource> source, const std::string& file_name);
+
+	auto get_content_length() -> uint64_t;
+	auto get_content_type() const -> std::string;
+
+	auto create_header() const -> cpr::Header
+	{
+		return cpr::Header{ { "Content-Type", this->get_content_type() } };
+	}
+
+	// the stream has to outlive the request
+	auto create_read_callback() -> cpr::ReadCallback;
+
+	auto read(char* buffer, size_t size) -> size_t;
+
+private:
+	struct Segment
+	{
+		std::string text;
+		std::shared_ptr<MappedFile> file;
+		std::shared_ptr<MultipartSource> source;
+
+		auto data() const -> const uint8_t* { return this->file ? this->file->data() : reinterpret_cast<const uint8_t*>(this->text.data()); }
+		auto size() const -> uint64_t { return this->source ? this->source->size() : this->file ? this->file->size() : this->text.size(); }
+	};
+
+	std::string boundary;
+	std::vector<Segment> segments;
+	bool finalized = false;
+	bool failed = false; // a source could not be read, the request is aborted
+
+	size_t segment_index = 0;
+	uint64_t segment_offset = 0;
+
+	void finalize();
+};
@@ -3,7 +3,8 @@
 
 namespace global { std::unique_ptr<MumbleLink> mumble_link = std::make_unique<MumbleLink>(); }
 
-#define LOG(message, log_level) global::logger->write(message, log_level, LogSource::MumbleLink)
+#define LOG(message, log_level) do { if (Logger::is_enabled(log_level)) global::logger->write(message, log_level, LogSource::MumbleLink); } while (0)
+#define LOG_FORMAT(log_level, ...) global::logger->write_format(log_level, LogSource::MumbleLink, __VA_ARGS__)
 
 bool MumbleLink::initialize(std::string linked_mem_name)
 {
@@ -68,4 +69,5 @@ void MumbleLink::release()
 	this->linked_mem_name.clear();
 }
 
-#undef LOG
\ No newline at end of file
+#undef LOG
+#undef LOG_FORMAT
\ No newline at end of file
@@ -0,0 +1,347 @@
+#include "report_chunks.h"
+
+#include <algorithm>
+#include <array>
+#include <memory>
+
+#include <miniz/miniz.h>
+
+namespace
+{
+	// content defined chunking with a gear rolling hash, a cut depends only on the last 64 bytes so shared content realigns after differing data
+	constexpr size_t min_chunk_size = 8 * 1024;
+	constexpr size_t max_chunk_size = 128 * 1024;
+	constexpr uint64_t cut_mask = 0xfffe000000000000; // 15 bits, 32 KiB average past the minimum
+
+	constexpr auto create_gear_table() -> std::array<uint64_t, 256>
+	{
+		std::array<uint64_t, 256> table{};
+
+		uint64_t state = 0x9e3779b97f4a7c15;
+
+		for (auto& value : table) // splitmix64
+		{
+			state += 0x9e3779b97f4a7c15;
+
+			auto z = state;
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+			value = z ^ (z >> 31);
+		}
+
+		return table;
+	}
+
+	constexpr auto gear_table = create_gear_table();
+
+	auto find_cut(const uint8_t* data, size_t size) -> size_t
+	{
+		if (size <= min_chunk_size)
+			return size;
+
+		const auto end = (std::min)(size, max_chunk_size);
+
+		uint64_t hash = 0;
+
+		for (size_t i = min_chunk_size; i < end; i++)
+		{
+			hash = (hash << 1) + gear_table[data[i]];
+
+			if ((hash & cut_mask) == 0)
+				return i + 1;
+		}
+
+		return end;
+	}
+
+	auto get_chunk_id(const uint8_t* data, size_t size) -> ChunkID
+	{
+		ChunkID chunk_id;
+		chunk_id.size = static_cast<uint32_t>(size);
+
+		uint64_t hash = 0xcbf29ce484222325; // fnv-1a
+		uint64_t check = 0x84222325cbf29ce4;
+
+		for (size_t i = 0; i < size; i++)
+		{
+			hash = (hash ^ data[i]) * 0x100000001b3;
+			check = (check + data[i] + 1) * 0x9e3779b97f4a7c15;
+			check ^= check >> 32;
+		}
+
+		chunk_id.hash = hash;
+		chunk_id.check = check;
+
+		return chunk_id;
+	}
+}
+
+bool ReportChunkStore::initialize(std::filesystem::path pack_file_path)
+{
+	std::lock_guard lock(this->mutex);
+
+	this->pack_file_path = std::move(pack_file_path);
+	this->pack_file.open(this->pack_file_path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+
+	this->chunks.clear();
+	this->pack_size = this->garbage_size = this->deduplicated_size = 0;
+
+	return this->pack_file.is_open();
+}
+
+void ReportChunkStore::release()
+{
+	std::lock_guard lock(this->mutex);
+
+	this->pack_file.close();
+	this->chunks.clear();
+	this->pack_size = this->garbage_size = 0;
+
+	std::error_code error;
+	std::filesystem::remove(this->pack_file_path, error);
+}
+
+auto ReportChunkStore::store(const uint8_t* data, size_t size) -> std::optional<ChunkManifest>
+{
+	ChunkManifest manifest;
+
+	std::lock_guard lock(this->mutex);
+
+	if (!this->pack_file.is_open())
+		return std::nullopt;
+
+	for (size_t offset = 0; offset < size;)
+	{
+		const auto chunk_size = find_cut(data + offset, size - offset);
+		const auto chunk_id = get_chunk_id(data + offset, chunk_size);
+
+		if (auto it = this->chunks.find(chunk_id); it != this->chunks.end())
+		{
+			it->second.references++;
+			this->deduplicated_size += chunk_size;
+		}
+		else
+		{
+			size_t deflated_size = 0;
+			std::unique_ptr<void, decltype(&mz_free)> deflated(tdefl_compress_mem_to_heap(data + offset, chunk_size, &deflated_size, TDEFL_DEFAULT_MAX_PROBES), mz_free);
+
+			this->pack_file.clear();
+			this->pack_file.seekp(static_cast<std::streamoff>(this->pack_size));
+
+			if (!deflated || !this->pack_file.write(static_cast<const char*>(deflated.get()), deflated_size))
+			{
+				this->release_locked(manifest);
+				return std::nullopt;
+			}
+
+			this->chunks.emplace(chunk_id, Chunk{ this->pack_size, static_cast<uint32_t>(deflated_size), 1 });
+			this->pack_size += deflated_size;
+		}
+
+		manifest.push_back(chunk_id);
+		offset += chunk_size;
+	}
+
+	this->pack_file.flush();
+
+	return manifest;
+}
+
+auto ReportChunkStore::read(const ChunkID& chunk_id, std::vector<uint8_t>& data) -> bool
+{
+	std::vector<uint8_t> deflated;
+
+	{
+		std::lock_guard lock(this->mutex);
+
+		auto it = this->chunks.find(chunk_id);
+
+		if (it == this->chunks.end())
+			return false;
+
+		deflated.resize(it->second.stored_size);
+
+		this->pack_file.clear();
+		this->pack_file.seekg(static_cast<std::streamoff>(it->second.offset));
+
+		if (!this->pack_file.read(reinterpret_cast<char*>(deflated.data()), deflated.size()))
+			return false;
+	}
+
+	data.resize(chunk_id.size);
+
+	return tinfl_decompress_mem_to_mem(data.data(), data.size(), deflated.data(), deflated.size(), 0) == chunk_id.size;
+}
+
+void ReportChunkStore::retain(const ChunkManifest& manifest)
+{
+	std::lock_guard lock(this->mutex);
+
+	for (const auto& chunk_id : manifest)
+		if (auto it = this->chunks.find(chunk_id); it != this->chunks.end())
+			it->second.references++;
+}
+
+void ReportChunkStore::release(const ChunkManifest& manifest)
+{
+	std::lock_guard lock(this->mutex);
+	this->release_locked(manifest);
+}
+
+void ReportChunkStore::release_locked(const ChunkManifest& manifest)
+{
+	for (const auto& chunk_id : manifest)
+	{
+		auto it = this->chunks.find(chunk_id);
+
+		if (it == this->chunks.end() || --it->second.references > 0)
+			continue;
+
+		this->garbage_size += it->second.stored_size;
+		this->chunks.erase(it);
+	}
+}
+
+void ReportChunkStore::compact()
+{
+	std::lock_guard lock(this->mutex);
+
+	if (!this->pack_file.is_open() || this->garbage_size < 16 * 1024 * 1024 || this->garbage_size * 2 < this->pack_size)
+		return;
+
+	auto compacted_file_path = this->pack_file_path;
+	compacted_file_path += ".tmp";
+
+	std::unordered_map<ChunkID, Chunk, ChunkIDHash> compacted_chunks;
+	uint64_t compacted_size = 0;
+
+	{
+		std::ofstream compacted_file(compacted_file_path, std::ios::binary | std::ios::trunc);
+
+		std::vector<char> buffer;
+
+		for (const auto& [chunk_id, chunk] : this->chunks)
+		{
+			buffer.resize(chunk.stored_size);
+
+			this->pack_file.clear();
+			this->pack_file.seekg(static_cast<std::streamoff>(chunk.offset));
+
+			if (!this->pack_file.read(buffer.data(), buffer.size()) || !compacted_file.write(buffer.data(), buffer.size()))
+				break;
+
+			compacted_chunks.emplace(chunk_id, Chunk{ compacted_size, chunk.stored_size, chunk.references });
+			compacted_size += chunk.stored_size;
+		}
+
+		if (compacted_chunks.size() != this->chunks.size() || !compacted_file.flush())
+		{
+			compacted_file.close();
+
+			std::error_code error;
+			std::filesystem::remove(compacted_file_path, error);
+			return;
+		}
+	}
+
+	this->pack_file.close();
+
+	std::error_code error;
+	std::filesystem::rename(compacted_file_path, this->pack_file_path, error);
+
+	if (error)
+	{
+		std::filesystem::remove(compacted_file_path, error);
+		this->pack_file.open(this->pack_file_path, std::ios::in | std::ios::out | std::ios::binary);
+		return;
+	}
+
+	this->pack_file.open(this->pack_file_path, std::ios::in | std::ios::out | std::ios::binary);
+
+	this->chunks = std::move(compacted_chunks);
+	this->pack_size = compacted_size;
+	this->garbage_size = 0;
+}
+
+ChunkedFileSource::ChunkedFileSource(ReportChunkStore& chunk_store, ChunkManifest manifest) : chunk_store(chunk_store), manifest(std::move(manifest))
+{
+	this->chunk_store.retain(this->manifest);
+
+	this->offsets.reserve(this->manifest.size() + 1);
+	this->offsets.push_back(0);
+
+	for (const auto& chunk_id : this->manifest)
+		this->offsets.push_back(this->offsets.back() + chunk_id.size);
+}
+
+ChunkedFileSource::~ChunkedFileSource()
+{
+	this->chunk_store.release(this->manifest);
+}
+
+auto ChunkedFileSource::read(uint64_t offset, uint8_t* buffer, size_t size) -> bool
+{
+	while (size > 0)
+	{
+		const auto index = static_cast<size_t>(std::upper_bound(this->offsets.begin(), this->offsets.end(), offset) - this->offsets.begin()) - 1;
+
+		if (index >= this->manifest.size())
+			return false;
+
+		// reads arrive sequentially in small pieces, the current chunk is kept inflated
+		if (index != this->cached_index)
+		{
+			if (!this->chunk_store.read(this->manifest[index], this->cached_chunk))
+				return false;
+
+			this->cached_index = index;
+		}
+
+		const auto chunk_offset = static_cast<size_t>(offset - this->offsets[index]);
+		const auto count = (std::min)(size, this->cached_chunk.size() - chunk_offset);
+
+		std::copy_n(this->cached_chunk.data() + chunk_offset, count, buffer);
+
+		buffer += count;
+		offset += count;
+		size -= count;
+	}
+
+	return true;
+}
+
+auto ChunkedFileSource::write_to(const std::filesystem::path& file_path) -> bool
+{
+	auto temporary_file_path = file_path;
+	temporary_file_path += ".tmp";
+
+	{
+		std::ofstream file(temporary_file_path, std::ios::binary | std::ios::trunc);
+
+		for (size_t index = 0; file && index < this->manifest.size(); index++)
+		{
+			if (!this->chunk_store.read(this->manifest[index], this->cached_chunk))
+				file.setstate(std::ios::failbit);
+			else
+				file.write(reinterpret_cast<const char*>(this->cached_chunk.data()), this->cached_chunk.size());
+		}
+
+		this->cached_index = SIZE_MAX;
+
+		if (file.flush())
+		{
+			file.close();
+
+			std::error_code error;
+			std::filesystem::rename(temporary_file_path, file_path, error);
+
+			if (!error)
+				return true;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::remove(temporary_file_path, error);
+
+	return false;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "multipart_stream.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+class ChunkID
+{
+public:
+	uint64_t hash = 0;
+	uint64_t check = 0; // second independent hash, a match on both is treated as equal content
+	uint32_t size = 0;
+
+	bool operator==(const ChunkID&) const = default;
+};
+
+struct ChunkIDHash
+{
+	auto operator()(const ChunkID& chunk_id) const -> size_t { return static_cast<size_t>(chunk_id.hash); }
+};
+
+using ChunkManifest = std::vector<ChunkID>;
+
+// content defined chunks shared between reports, the scripts and styles embedded by an Elite Insights version are stored once
+class ReportChunkStore
+{
+public:
+	ReportChunkStore() {}
+	~ReportChunkStore() {}
+
+	// the pack only lives for the current session like the reports referencing it
+	bool initialize(std::filesystem::path pack_file_path);
+	void release();
+
+	// stores the chunks of the content that are not present yet, the manifest holds a reference to each of them
+	auto store(const uint8_t* data, size_t size) -> std::optional<ChunkManifest>;
+
+	auto read(const ChunkID& chunk_id, std::vector<uint8_t>& data) -> bool;
+
+	void retain(const ChunkManifest& manifest);
+	void release(const ChunkManifest& manifest);
+
+	// rewrites the pack once most of it is no longer referenced
+	void compact();
+
+	// bytes of referenced chunks, the pack shrinks to it on the next compaction
+	auto get_disk_usage() -> uint64_t
+	{
+		std::lock_guard lock(this->mutex);
+		return this->pack_size - this->garbage_size;
+	}
+
+	auto get_deduplicated_size() -> uint64_t
+	{
+		std::lock_guard lock(this->mutex);
+		return this->deduplicated_size;
+	}
+
+private:
+	class Chunk
+	{
+	public:
+		uint64_t offset = 0;
+		uint32_t stored_size = 0; // deflated
+		uint32_t references = 0;
+	};
+
+	std::mutex mutex;
+
+	std::filesystem::path pack_file_path;
+	std::fstream pack_file;
+
+	std::unordered_map<ChunkID, Chunk, ChunkIDHash> chunks;
+
+	uint64_t pack_size = 0;
+	uint64_t garbage_size = 0; // bytes of chunks without references left in the pack
+	uint64_t deduplicated_size = 0; // raw bytes that did not have to be written again
+
+	void release_locked(const ChunkManifest& manifest);
+};
+
+// streams a chunked file in its original form, keeps its chunks referenced until it is destroyed
+class ChunkedFileSource : public MultipartSource
+{
+public:
+	ChunkedFileSource(ReportChunkStore& chunk_store, ChunkManifest manifest);
+	~ChunkedFileSource();
+
+	auto size() const -> uint64_t override { return this->offsets.back(); }
+	auto read(uint64_t offset, uint8_t* buffer, size_t size) -> bool override;
+
+	// writes the whole content to the file, used when a report is needed on disk again
+	auto write_to(const std::filesystem::path& file_path) -> bool;
+
+private:
+	ReportChunkStore& chunk_store;
+	ChunkManifest manifest;
+
+	std::vector<uint64_t> offsets; // start of every chunk in the original content plus the total size
+
+	size_t cached_index = SIZE_MAX;
+	std::vector<uint8_t> cached_chunk;
+};
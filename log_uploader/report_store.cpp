@@ -0,0 +1,798 @@
+#include "change_bus.h"
+#include "elite_insights.h"
+#include "file_reclaimer.h"
+#include "logger.h"
+#include "report_store.h"
+#include "settings.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include <miniz/miniz.h>
+
+namespace global { std::unique_ptr<ReportStore> report_store = std::make_unique<ReportStore>(); }
+
+#define LOG(message, log_level) do { if (Logger::is_enabled(log_level)) global::logger->write(message, log_level, LogSource::ReportStore); } while (0)
+#define LOG_FORMAT(log_level, ...) global::logger->write_format(log_level, LogSource::ReportStore, __VA_ARGS__)
+
+namespace
+{
+	auto get_report_files(const ReportData& report_data) -> std::array<std::filesystem::path, 2>
+	{
+		return { report_data.get_html_file_path(), report_data.get_json_file_path() };
+	}
+
+	auto get_compressed_file_path(const std::filesystem::path& file_path) -> std::filesystem::path
+	{
+		auto compressed_file_path = file_path;
+		compressed_file_path += ".gz";
+		return compressed_file_path;
+	}
+
+	auto get_report_data(const std::string& report_key) -> ReportData
+	{
+		ReportData report_data;
+		report_data.report_key = report_key;
+		return report_data;
+	}
+
+	auto read_file(const std::filesystem::path& file_path, std::vector<uint8_t>& data) -> bool
+	{
+		std::ifstream file(file_path, std::ios::binary | std::ios::ate);
+
+		if (!file.is_open())
+			return false;
+
+		data.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+
+		return static_cast<bool>(file.read(reinterpret_cast<char*>(data.data()), data.size()));
+	}
+
+	// writes next to the target first so an interrupted write never leaves a truncated report behind
+	auto write_file(const std::filesystem::path& file_path, const void* data, size_t size) -> bool
+	{
+		auto temporary_file_path = file_path;
+		temporary_file_path += ".tmp";
+
+		{
+			std::ofstream file(temporary_file_path, std::ios::binary | std::ios::trunc);
+
+			if (!file.is_open() || !file.write(static_cast<const char*>(data), size))
+				return false;
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temporary_file_path, file_path, error);
+
+		if (error)
+			std::filesystem::remove(temporary_file_path, error);
+
+		return !error;
+	}
+
+	void write_le32(std::vector<uint8_t>& buffer, uint32_t value)
+	{
+		for (int i = 0; i < 4; i++)
+			buffer.push_back(static_cast<uint8_t>(value >> (i * 8)));
+	}
+
+	auto read_le32(const uint8_t* data) -> uint32_t
+	{
+		return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<uint32_t>(data[3]) << 24);
+	}
+
+	constexpr size_t gzip_header_size = 10;
+	constexpr size_t gzip_trailer_size = 8;
+
+	// plain gzip member without optional header fields, readable by any gzip tool
+	auto gzip_file(const std::filesystem::path& source_file_path, const std::filesystem::path& target_file_path) -> bool
+	{
+		std::vector<uint8_t> data;
+
+		if (!read_file(source_file_path, data))
+			return false;
+
+		size_t deflated_size = 0;
+		std::unique_ptr<void, decltype(&mz_free)> deflated(tdefl_compress_mem_to_heap(data.data(), data.size(), &deflated_size, TDEFL_DEFAULT_MAX_PROBES), mz_free);
+
+		if (!deflated)
+			return false;
+
+		std::vector<uint8_t> buffer = { 0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff };
+		buffer.reserve(gzip_header_size + deflated_size + gzip_trailer_size);
+		buffer.insert(buffer.end(), static_cast<uint8_t*>(deflated.get()), static_cast<uint8_t*>(deflated.get()) + deflated_size);
+
+		write_le32(buffer, static_cast<uint32_t>(mz_crc32(MZ_CRC32_INIT, data.data(), data.size())));
+		write_le32(buffer, static_cast<uint32_t>(data.size()));
+
+		return write_file(target_file_path, buffer.data(), buffer.size());
+	}
+
+	auto gunzip(const std::vector<uint8_t>& data, std::vector<uint8_t>& inflated) -> bool
+	{
+		// only the layout written by gzip_file is accepted
+		if (data.size() < gzip_header_size + gzip_trailer_size || data[0] != 0x1f || data[1] != 0x8b || data[2] != 0x08 || data[3] != 0x00)
+			return false;
+
+		const auto trailer = data.data() + data.size() - gzip_trailer_size;
+
+		inflated.resize(read_le32(trailer + 4));
+
+		if (tinfl_decompress_mem_to_mem(inflated.data(), inflated.size(), data.data() + gzip_header_size, data.size() - gzip_header_size - gzip_trailer_size, 0) != inflated.size())
+			return false;
+
+		return read_le32(trailer) == static_cast<uint32_t>(mz_crc32(MZ_CRC32_INIT, inflated.data(), inflated.size()));
+	}
+
+	auto gunzip_file(const std::filesystem::path& source_file_path, const std::filesystem::path& target_file_path) -> bool
+	{
+		std::vector<uint8_t> data, inflated;
+
+		if (!read_file(source_file_path, data) || !gunzip(data, inflated))
+			return false;
+
+		return write_file(target_file_path, inflated.data(), inflated.size());
+	}
+
+	// a gzipped report inflated while it is streamed, only the deflate window is held in memory
+	// reads are expected in order, reading before the window starts inflating from the beginning again
+	class GzipFileSource : public MultipartSource
+	{
+	public:
+		explicit GzipFileSource(const std::filesystem::path& file_path) : file(std::make_unique<MappedFile>(file_path))
+		{
+			const auto data = this->file->data();
+			const auto file_size = this->file->size();
+
+			// only the layout written by gzip_file is accepted
+			if (file_size < gzip_header_size + gzip_trailer_size || data[0] != 0x1f || data[1] != 0x8b || data[2] != 0x08 || data[3] != 0x00)
+				throw std::runtime_error("Not a gzip file: " + file_path.string());
+
+			const auto trailer = data + file_size - gzip_trailer_size;
+
+			this->expected_crc = read_le32(trailer);
+			this->inflated_size = read_le32(trailer + 4);
+
+			this->restart();
+		}
+
+		auto size() const -> uint64_t override { return this->inflated_size; }
+
+		auto read(uint64_t offset, uint8_t* buffer, size_t size) -> bool override
+		{
+			if (offset + size > this->inflated_size)
+				return false;
+
+			if (offset < this->window_start)
+				this->restart();
+
+			while (size > 0)
+			{
+				if (offset < this->produced)
+				{
+					// the window is at most one dictionary long, its bytes sit at their offset modulo the dictionary size
+					const auto index = static_cast<size_t>(offset & (TINFL_LZ_DICT_SIZE - 1));
+					const auto count = (std::min)({ size, static_cast<size_t>(this->produced - offset), TINFL_LZ_DICT_SIZE - index });
+
+					std::copy_n(this->dictionary.get() + index, count, buffer);
+
+					offset += count;
+					buffer += count;
+					size -= count;
+					continue;
+				}
+
+				if (!this->inflate())
+					return false;
+			}
+
+			return true;
+		}
+
+	private:
+		std::unique_ptr<MappedFile> file;
+		uint32_t expected_crc = 0;
+		uint64_t inflated_size = 0;
+
+		tinfl_decompressor decompressor{};
+		std::unique_ptr<uint8_t[]> dictionary = std::make_unique<uint8_t[]>(TINFL_LZ_DICT_SIZE);
+
+		size_t input_offset = 0; // into the deflate stream
+		uint64_t window_start = 0; // offset of the oldest inflated byte still in the dictionary
+		uint64_t produced = 0;
+		uint32_t crc = MZ_CRC32_INIT;
+		bool done = false;
+
+		void restart()
+		{
+			tinfl_init(&this->decompressor);
+
+			this->input_offset = 0;
+			this->window_start = 0;
+			this->produced = 0;
+			this->crc = MZ_CRC32_INIT;
+			this->done = false;
+		}
+
+		auto inflate() -> bool
+		{
+			if (this->done)
+				return false;
+
+			const auto input = this->file->data() + gzip_header_size;
+			const auto input_size = static_cast<size_t>(this->file->size() - gzip_header_size - gzip_trailer_size);
+
+			const auto output_index = static_cast<size_t>(this->produced & (TINFL_LZ_DICT_SIZE - 1));
+
+			size_t input_bytes = input_size - this->input_offset;
+			size_t output_bytes = TINFL_LZ_DICT_SIZE - output_index;
+
+			// the whole stream is mapped, there is never more input to wait for
+			const auto status = tinfl_decompress(&this->decompressor, input + this->input_offset, &input_bytes, this->dictionary.get(), this->dictionary.get() + output_index, &output_bytes, 0);
+
+			if (status < TINFL_STATUS_DONE)
+				return false;
+
+			this->input_offset += input_bytes;
+			this->window_start = this->produced;
+			this->produced += output_bytes;
+			this->crc = static_cast<uint32_t>(mz_crc32(this->crc, this->dictionary.get() + output_index, output_bytes));
+
+			if (status == TINFL_STATUS_DONE)
+			{
+				this->done = true;
+
+				// a damaged file fails the upload instead of sending a broken report
+				if (this->produced != this->inflated_size || this->crc != this->expected_crc)
+					return false;
+			}
+
+			return output_bytes > 0 || status == TINFL_STATUS_HAS_MORE_OUTPUT;
+		}
+	};
+
+	auto get_file_size(const std::filesystem::path& file_path) -> uint64_t
+	{
+		std::error_code error;
+		const auto size = std::filesystem::file_size(file_path, error);
+		return error ? 0 : size;
+	}
+}
+
+
+ReportLease::~ReportLease()
+{
+	if (this->valid)
+		global::report_store->unlease(this->report_key);
+}
+
+ReportLease& ReportLease::operator=(ReportLease&& other) noexcept
+{
+	if (this != &other)
+	{
+		if (this->valid)
+			global::report_store->unlease(this->report_key);
+
+		this->report_key = std::move(other.report_key);
+		this->valid = std::exchange(other.valid, false);
+		this->html_source = std::move(other.html_source);
+		this->json_source = std::move(other.json_source);
+	}
+
+	return *this;
+}
+
+void ReportStore::initialize(std::filesystem::path data_directory)
+{
+	std::lock_guard initialization_lock(this->initialization_mutex);
+
+	if (this->is_initialized())
+		return;
+
+	this->chunks_available = this->chunk_store.initialize(data_directory / "report_chunks.pack");
+
+	if (!this->chunks_available)
+		LOG("Failed to create the report chunk pack, html reports are gzipped instead", LogLevel::Warning);
+
+	this->initialized = true;
+
+	this->maintenance_thread = std::thread(&ReportStore::run, this);
+}
+
+void ReportStore::release()
+{
+	std::lock_guard initialization_lock(this->initialization_mutex);
+
+	if (!this->initialized)
+		return;
+
+	{
+		std::lock_guard lock(this->mutex);
+		this->initialized = false;
+	}
+
+	this->cv.notify_all();
+
+	if (this->maintenance_thread.joinable())
+		this->maintenance_thread.join();
+
+	if (this->chunks_available)
+		this->chunk_store.release();
+}
+
+void ReportStore::add(const ReportData& report_data)
+{
+	if (report_data.report_key.empty())
+		return;
+
+	uint64_t size = 0;
+
+	for (const auto& file_path : get_report_files(report_data))
+		size += get_file_size(file_path);
+
+	{
+		std::lock_guard lock(this->mutex);
+
+		auto& report = this->reports[report_data.report_key];
+
+		// a log parsed again writes the same report key
+		if (report.state == ReportState::BUSY)
+			return;
+
+		if (report.state == ReportState::COMPRESSED)
+		{
+			this->chunk_store.release(report.html_manifest);
+			report.html_manifest.clear();
+
+			for (const auto& file_path : get_report_files(report_data))
+				global::file_reclaimer->reclaim(get_compressed_file_path(file_path));
+		}
+
+		this->disk_usage += size - report.size;
+
+		report.state = ReportState::PLAIN;
+		report.size = size;
+		report.last_access = std::chrono::steady_clock::now();
+
+		this->budget_changed = true;
+	}
+
+	this->cv.notify_all();
+}
+
+void ReportStore::open(std::shared_ptr<EncounterLog> encounter_log)
+{
+	{
+		std::lock_guard log_lock(encounter_log->mutex);
+
+		if (encounter_log->view.opening_report)
+			return;
+
+		encounter_log->view.opening_report = true;
+	}
+
+	global::change_bus->post(encounter_log, LogChange::REPORT_OPENING);
+
+	{
+		std::lock_guard lock(this->mutex);
+		this->open_queue.push_back(std::move(encounter_log));
+	}
+
+	this->cv.notify_all();
+}
+
+void ReportStore::open_queued_reports()
+{
+	while (true)
+	{
+		std::unique_lock lock(this->mutex);
+
+		if (this->open_queue.empty())
+			return;
+
+		auto encounter_log = std::move(this->open_queue.front());
+		this->open_queue.pop_front();
+
+		lock.unlock();
+
+		const auto encounter_log_data = encounter_log->get_data();
+
+		// old reports are stored compressed, the lease restores them before the browser reads the file
+		if (auto report_lease = this->acquire(encounter_log_data.report_data); report_lease)
+			ShellExecuteW(nullptr, L"open", encounter_log_data.report_data.get_html_file_path().c_str(), nullptr, nullptr, SW_SHOWNORMAL);
+		else
+		{
+			LOG("Report of " + encounter_log_data.id + " was removed to stay within the disk budget, parsing it again", LogLevel::Info);
+			global::elite_insights->queue_reparse(encounter_log);
+		}
+
+		{
+			std::lock_guard log_lock(encounter_log->mutex);
+			encounter_log->view.opening_report = false;
+		}
+
+		global::change_bus->post(encounter_log, LogChange::REPORT_OPENING);
+	}
+}
+
+void ReportStore::set_budget_changed()
+{
+	{
+		std::lock_guard lock(this->mutex);
+		this->budget_changed = true;
+	}
+
+	this->cv.notify_all();
+}
+
+auto ReportStore::acquire(const ReportData& report_data) -> ReportLease
+{
+	return this->acquire(report_data, true);
+}
+
+auto ReportStore::acquire_for_upload(const ReportData& report_data) -> ReportLease
+{
+	return this->acquire(report_data, false);
+}
+
+auto ReportStore::acquire(const ReportData& report_data, bool restore_files) -> ReportLease
+{
+	const auto& report_key = report_data.report_key;
+
+	if (report_key.empty())
+		return {};
+
+	std::unique_lock lock(this->mutex);
+
+	auto it = this->reports.end();
+
+	// the report can be evicted while another thread compresses it
+	this->cv.wait(lock, [&] { it = this->reports.find(report_key); return it == this->reports.end() || it->second.state != ReportState::BUSY; });
+
+	if (it == this->reports.end())
+	{
+		// untracked reports are only expected while the store is not running
+		if (this->initialized)
+			return {};
+
+		for (const auto& file_path : get_report_files(report_data))
+			if (!std::filesystem::exists(file_path))
+				return {};
+
+		return ReportLease(std::string());
+	}
+
+	// elements of the map keep their address while busy, unlike its iterators
+	auto& report = it->second;
+
+	report.leases++;
+	report.last_access = std::chrono::steady_clock::now();
+
+	if (report.state == ReportState::PLAIN)
+		return ReportLease(report_key);
+
+	if (!restore_files)
+	{
+		ReportLease lease(report_key);
+
+		// the source holds its own chunk references, restoring or evicting the report does not affect the upload
+		if (!report.html_manifest.empty())
+			lease.html_source = std::make_shared<ChunkedFileSource>(this->chunk_store, report.html_manifest);
+
+		lock.unlock();
+
+		for (const auto& [file_path, source] : { std::pair{ report_data.get_json_file_path(), &lease.json_source }, std::pair{ report_data.get_html_file_path(), &lease.html_source } })
+		{
+			if (*source)
+				continue;
+
+			try
+			{
+				*source = std::make_shared<GzipFileSource>(get_compressed_file_path(file_path));
+			}
+			catch (const std::exception& e)
+			{
+				LOG("Failed to read compressed report: " + std::string(e.what()), LogLevel::Warning);
+				return {};
+			}
+		}
+
+		return lease;
+	}
+
+	const auto html_manifest = report.html_manifest;
+
+	report.state = ReportState::BUSY;
+
+	lock.unlock();
+
+	const auto restored = this->restore(report_key, html_manifest);
+
+	uint64_t size = 0;
+
+	for (const auto& file_path : get_report_files(report_data))
+		size += get_file_size(file_path);
+
+	lock.lock();
+
+	if (restored)
+	{
+		for (const auto& file_path : get_report_files(report_data))
+			global::file_reclaimer->reclaim(get_compressed_file_path(file_path));
+
+		this->chunk_store.release(html_manifest);
+
+		report.state = ReportState::PLAIN;
+		report.html_manifest.clear();
+
+		this->disk_usage += size - report.size;
+		report.size = size;
+	}
+	else
+	{
+		LOG("Failed to restore report: " + report_key, LogLevel::Warning);
+
+		report.state = ReportState::COMPRESSED;
+		report.leases--;
+	}
+
+	this->cv.notify_all();
+
+	if (!restored)
+		return {};
+
+	return ReportLease(report_key);
+}
+
+void ReportStore::remove(const ReportData& report_data)
+{
+	if (report_data.report_key.empty())
+		return;
+
+	ChunkManifest html_manifest;
+
+	{
+		std::lock_guard lock(this->mutex);
+
+		if (auto it = this->reports.find(report_data.report_key); it != this->reports.end())
+		{
+			if (it->second.state == ReportState::BUSY)
+			{
+				it->second.removed = true;
+				return;
+			}
+
+			html_manifest = std::move(it->second.html_manifest);
+
+			this->disk_usage -= it->second.size;
+			this->reports.erase(it);
+		}
+	}
+
+	this->delete_files(report_data.report_key, html_manifest);
+}
+
+void ReportStore::unlease(const std::string& report_key)
+{
+	std::lock_guard lock(this->mutex);
+
+	if (auto it = this->reports.find(report_key); it != this->reports.end())
+	{
+		it->second.leases--;
+		it->second.last_access = std::chrono::steady_clock::now();
+	}
+}
+
+auto ReportStore::compress(const std::string& report_key, ChunkManifest& html_manifest) -> bool
+{
+	const auto report_data = get_report_data(report_key);
+
+	const auto html_file_path = report_data.get_html_file_path();
+	const auto json_file_path = report_data.get_json_file_path();
+
+	if (!gzip_file(json_file_path, get_compressed_file_path(json_file_path)))
+		return false;
+
+	if (!this->chunks_available)
+		return gzip_file(html_file_path, get_compressed_file_path(html_file_path));
+
+	std::vector<uint8_t> data;
+
+	if (!read_file(html_file_path, data) || data.empty())
+		return false;
+
+	auto manifest = this->chunk_store.store(data.data(), data.size());
+
+	if (!manifest.has_value())
+		return false;
+
+	html_manifest = std::move(manifest.value());
+
+	return true;
+}
+
+auto ReportStore::restore(const std::string& report_key, const ChunkManifest& html_manifest) -> bool
+{
+	const auto report_data = get_report_data(report_key);
+
+	const auto html_file_path = report_data.get_html_file_path();
+	const auto json_file_path = report_data.get_json_file_path();
+
+	if (!gunzip_file(get_compressed_file_path(json_file_path), json_file_path))
+		return false;
+
+	if (html_manifest.empty())
+		return gunzip_file(get_compressed_file_path(html_file_path), html_file_path);
+
+	return ChunkedFileSource(this->chunk_store, html_manifest).write_to(html_file_path);
+}
+
+void ReportStore::delete_files(const std::string& report_key, const ChunkManifest& html_manifest)
+{
+	if (!html_manifest.empty())
+		this->chunk_store.release(html_manifest);
+
+	for (const auto& file_path : get_report_files(get_report_data(report_key)))
+	{
+		global::file_reclaimer->reclaim(file_path);
+		global::file_reclaimer->reclaim(get_compressed_file_path(file_path));
+	}
+}
+
+void ReportStore::compress_idle_reports()
+{
+	const auto compress_after = std::chrono::minutes(GET_SETTING(elite_insights.compress_reports_after));
+
+	if (compress_after.count() == 0)
+		return;
+
+	while (this->is_initialized())
+	{
+		// a report the user asked for does not wait for the whole pass
+		this->open_queued_reports();
+
+		std::unique_lock lock(this->mutex);
+
+		const auto now = std::chrono::steady_clock::now();
+
+		auto it = std::find_if(this->reports.begin(), this->reports.end(), [&](const auto& entry)
+			{
+				const auto& report = entry.second;
+				return report.state == ReportState::PLAIN && report.leases == 0 && now - report.last_access >= compress_after;
+			});
+
+		if (it == this->reports.end())
+			return;
+
+		const auto report_key = it->first;
+		const auto report_files = get_report_files(get_report_data(report_key));
+
+		// elements of the map keep their address while busy, unlike its iterators
+		auto& report = it->second;
+
+		report.state = ReportState::BUSY;
+
+		lock.unlock();
+
+		ChunkManifest html_manifest;
+
+		const auto compressed = this->compress(report_key, html_manifest);
+
+		uint64_t size = 0;
+
+		for (const auto& file_path : report_files)
+			if (!compressed)
+				size += get_file_size(file_path);
+			else if (file_path.extension() == ".json" || html_manifest.empty())
+				size += get_file_size(get_compressed_file_path(file_path));
+
+		lock.lock();
+
+		if (compressed)
+		{
+			for (const auto& file_path : report_files)
+				global::file_reclaimer->reclaim(file_path);
+
+			report.state = ReportState::COMPRESSED;
+			report.html_manifest = std::move(html_manifest);
+		}
+		else
+		{
+			LOG("Failed to compress report: " + report_key, LogLevel::Warning);
+
+			for (const auto& file_path : report_files)
+				global::file_reclaimer->reclaim(get_compressed_file_path(file_path));
+
+			report.state = ReportState::PLAIN;
+
+			// retried once it is accessed again instead of on every pass
+			report.last_access = now;
+		}
+
+		this->disk_usage += size - report.size;
+		report.size = size;
+
+		if (report.removed)
+		{
+			const auto removed_manifest = std::move(report.html_manifest);
+
+			this->disk_usage -= report.size;
+			this->reports.erase(report_key);
+
+			lock.unlock();
+
+			this->delete_files(report_key, removed_manifest);
+		}
+		else
+			lock.unlock();
+
+		this->cv.notify_all();
+	}
+}
+
+void ReportStore::enforce_disk_budget()
+{
+	const auto disk_budget = static_cast<uint64_t>(GET_SETTING(elite_insights.report_disk_budget)) * 1024 * 1024;
+
+	std::vector<std::string> evicted;
+
+	{
+		std::lock_guard lock(this->mutex);
+
+		// chunks only count while referenced, the pack is compacted down to them afterwards
+		while (this->disk_usage + this->chunk_store.get_disk_usage() > disk_budget)
+		{
+			auto lru = this->reports.end();
+
+			for (auto it = this->reports.begin(); it != this->reports.end(); ++it)
+				if (it->second.state != ReportState::BUSY && it->second.leases == 0 && (lru == this->reports.end() || it->second.last_access < lru->second.last_access))
+					lru = it;
+
+			if (lru == this->reports.end())
+				break;
+
+			this->disk_usage -= lru->second.size;
+
+			// released right away so the loop sees the shrinking chunk usage
+			this->chunk_store.release(lru->second.html_manifest);
+
+			evicted.push_back(lru->first);
+			this->reports.erase(lru);
+		}
+	}
+
+	if (evicted.empty())
+		return;
+
+	for (const auto& report_key : evicted)
+		this->delete_files(report_key, {});
+
+	LOG("Removed " + std::to_string(evicted.size()) + " reports to stay within the disk budget", LogLevel::Info);
+}
+
+void ReportStore::run()
+{
+	while (this->is_initialized())
+	{
+		this->open_queued_reports();
+		this->enforce_disk_budget();
+		this->compress_idle_reports();
+
+		if (this->chunks_available)
+			this->chunk_store.compact();
+
+		std::unique_lock lock(this->mutex);
+
+		// new reports and reports to open wake the thread early, the age of idle reports is checked once a minute
+		this->cv.wait_for(lock, std::chrono::minutes(1), [this] { return !this->initialized || this->budget_changed || !this->open_queue.empty(); });
+
+		this->budget_changed = false;
+	}
+}
+
+#undef LOG
+#undef LOG_FORMAT
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "encounter_log.h"
+#include "module.h"
+#include "report_chunks.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+// keeps the reports of a log from being compressed or removed while held
+class ReportLease
+{
+public:
+	ReportLease() {}
+	ReportLease(std::string report_key) : report_key(std::move(report_key)), valid(true) {}
+	~ReportLease();
+
+	ReportLease(ReportLease&& other) noexcept : report_key(std::move(other.report_key)), valid(std::exchange(other.valid, false)), html_source(std::move(other.html_source)), json_source(std::move(other.json_source)) {}
+	ReportLease& operator=(ReportLease&& other) noexcept;
+
+	ReportLease(const ReportLease&) = delete;
+	ReportLease& operator=(const ReportLease&) = delete;
+
+	explicit operator bool() const { return this->valid; }
+
+	// set when the report was acquired for streaming and is stored compressed, the files on disk are used otherwise
+	auto get_html_source() const -> std::shared_ptr<MultipartSource> { return this->html_source; }
+	auto get_json_source() const -> std::shared_ptr<MultipartSource> { return this->json_source; }
+
+private:
+	friend class ReportStore;
+
+	std::string report_key;
+	bool valid = false;
+
+	std::shared_ptr<MultipartSource> html_source;
+	std::shared_ptr<MultipartSource> json_source;
+};
+
+// keeps the Elite Insights reports within the configured disk budget, the least recently used ones are removed
+// idle html reports are split into chunks shared with all other reports, json reports are gzipped
+class ReportStore : public Module
+{
+public:
+	ReportStore() {}
+	~ReportStore() {}
+
+	void initialize(std::filesystem::path data_directory);
+	void release() override;
+
+	// tracks the reports of a freshly parsed log
+	void add(const ReportData& report_data);
+
+	// restores the report files if needed, returns an empty lease when they were removed
+	auto acquire(const ReportData& report_data) -> ReportLease;
+
+	// leaves compressed reports in place and streams them through the lease instead
+	auto acquire_for_upload(const ReportData& report_data) -> ReportLease;
+
+	// restores the report on the maintenance thread and opens it in the browser, the log is parsed again when the report was removed
+	void open(std::shared_ptr<EncounterLog> encounter_log);
+
+	// deletes the reports of a log that is no longer referenced
+	void remove(const ReportData& report_data);
+
+	// applies changed budget or compression settings right away
+	void set_budget_changed();
+
+	auto get_disk_usage() -> uint64_t
+	{
+		std::lock_guard lock(this->mutex);
+		return this->disk_usage + this->chunk_store.get_disk_usage();
+	}
+
+	// bytes of html reports that are shared with other reports and only stored once
+	auto get_deduplicated_size() -> uint64_t { return this->chunk_store.get_deduplicated_size(); }
+
+private:
+	friend class ReportLease;
+
+	enum class ReportState
+	{
+		PLAIN,
+		COMPRESSED,
+		BUSY // being compressed or decompressed outside the lock
+	};
+
+	class Report
+	{
+	public:
+		ReportState state = ReportState::PLAIN;
+		uint64_t size = 0; // bytes on disk of both files in their current state, without the shared chunks
+		ChunkManifest html_manifest; // set while the html report is stored as chunks
+		uint32_t leases = 0;
+		bool removed = false; // removed while busy, deleted once the transition finished
+		std::chrono::steady_clock::time_point last_access{};
+	};
+
+	std::mutex mutex;
+	std::condition_variable cv;
+
+	std::unordered_map<std::string, Report> reports;
+	uint64_t disk_usage = 0;
+
+	ReportChunkStore chunk_store;
+	bool chunks_available = false;
+
+	bool budget_changed = false; // wakes the maintenance thread before its next scheduled pass
+
+	std::deque<std::shared_ptr<EncounterLog>> open_queue; // reports to open, handled between the compression of two reports
+
+	std::thread maintenance_thread;
+
+	void unlease(const std::string& report_key);
+
+	auto acquire(const ReportData& report_data, bool restore_files) -> ReportLease;
+
+	auto compress(const std::string& report_key, ChunkManifest& html_manifest) -> bool;
+	auto restore(const std::string& report_key, const ChunkManifest& html_manifest) -> bool;
+	void delete_files(const std::string& report_key, const ChunkManifest& html_manifest);
+
+	void open_queued_reports();
+	void compress_idle_reports();
+	void enforce_disk_budget();
+	void run();
+};
+
+namespace global { extern std::unique_ptr<ReportStore> report_store; }
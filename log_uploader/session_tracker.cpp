@@ -0,0 +1,118 @@
+#include "session_tracker.h"
+
+#include <algorithm>
+
+namespace
+{
+	auto get_trigger_category(TriggerID trigger_id) -> std::pair<std::string_view, std::string_view>
+	{
+		static const auto categories = []()
+			{
+				std::unordered_map<TriggerID, std::pair<std::string_view, std::string_view>> categories;
+
+				for (const auto& [category, sub_categories] : global::categorized_triggers)
+					for (const auto& [sub_category, trigger_ids] : sub_categories)
+						for (const auto trigger_id : trigger_ids)
+							categories.emplace(trigger_id, std::pair<std::string_view, std::string_view>{ category, sub_category });
+
+				return categories;
+			}();
+
+		if (auto it = categories.find(trigger_id); it != categories.end())
+			return it->second;
+
+		return { "Other", "Uncategorized" };
+	}
+}
+
+auto SessionTracker::add(const EncounterLogData& encounter_log_data) -> uint32_t
+{
+	const auto [category, sub_category] = get_trigger_category(encounter_log_data.evtc_data.trigger_id);
+	const auto time = encounter_log_data.evtc_data.time;
+
+	// logs of a second client in the same directory form their own sessions, logs without a pov share one
+	const auto account_name = encounter_log_data.evtc_data.account_name;
+
+	auto& latest_session_id = this->latest_sessions[{ &account_name.str(), category }];
+
+	if (latest_session_id == 0 || time - this->sessions[latest_session_id - 1].end_time > session_gap)
+	{
+		EncounterSession session;
+		session.id = static_cast<uint32_t>(this->sessions.size() + 1);
+		session.account_name = account_name;
+		session.category = category;
+		session.start_time = session.end_time = time;
+
+		this->sessions.push_back(std::move(session));
+		latest_session_id = this->sessions.back().id;
+	}
+
+	auto& session = this->sessions[latest_session_id - 1];
+
+	session.log_count++;
+	session.start_time = (std::min)(session.start_time, time);
+	session.end_time = (std::max)(session.end_time, time);
+
+	if (std::find(session.sub_categories.begin(), session.sub_categories.end(), sub_category) == session.sub_categories.end())
+		session.sub_categories.push_back(sub_category);
+
+	this->contributions[encounter_log_data.sequence] = Contribution{ session.id };
+	this->sessions_changed = true;
+
+	return session.id;
+}
+
+void SessionTracker::update(const EncounterLogData& encounter_log_data)
+{
+	auto it = this->contributions.find(encounter_log_data.sequence);
+
+	if (it == this->contributions.end())
+		return;
+
+	auto& contribution = it->second;
+	auto& session = this->sessions[contribution.session_id - 1];
+
+	const auto parsed = encounter_log_data.parse_status == ParseStatus::PARSED;
+	const auto updated = Contribution{ contribution.session_id, parsed && encounter_log_data.encounter_data.success, parsed && !encounter_log_data.encounter_data.success, parsed ? encounter_log_data.encounter_data.duration_ms : 0 };
+
+	// most changes are upload progress, they leave the session as it is
+	if (updated.kill == contribution.kill && updated.wipe == contribution.wipe && updated.duration_ms == contribution.duration_ms)
+		return;
+
+	session.kills -= contribution.kill;
+	session.wipes -= contribution.wipe;
+	session.combat_time -= std::chrono::milliseconds(contribution.duration_ms);
+
+	contribution = updated;
+
+	session.kills += contribution.kill;
+	session.wipes += contribution.wipe;
+	session.combat_time += std::chrono::milliseconds(contribution.duration_ms);
+
+	// the log time marks the end of the encounter, its start is only known once parsed
+	if (parsed)
+		session.start_time = (std::min)(session.start_time, encounter_log_data.evtc_data.time - std::chrono::milliseconds(contribution.duration_ms));
+
+	this->sessions_changed = true;
+}
+
+auto SessionTracker::get_sessions() -> std::shared_ptr<const std::vector<EncounterSession>>
+{
+	if (this->sessions_changed)
+	{
+		this->published_sessions = std::make_shared<const std::vector<EncounterSession>>(this->sessions);
+		this->sessions_changed = false;
+	}
+
+	return this->published_sessions;
+}
+
+void SessionTracker::clear()
+{
+	this->sessions.clear();
+	this->latest_sessions.clear();
+	this->contributions.clear();
+
+	this->published_sessions = std::make_shared<const std::vector<EncounterSession>>();
+	this->sessions_changed = false;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "encounter_log.h"
+#include "string_interner.h"
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// a burst of logs of one account in one kind of content, e.g. a raid evening or a fractal run
+class EncounterSession
+{
+public:
+	uint32_t id = 0;
+
+	InternedString account_name;
+	std::string_view category; // e.g. Raids, Fractals
+	std::vector<std::string_view> sub_categories; // wings or fractals in the order they were first played
+
+	std::chrono::system_clock::time_point start_time{};
+	std::chrono::system_clock::time_point end_time{};
+
+	uint32_t log_count = 0;
+	uint32_t kills = 0;
+	uint32_t wipes = 0;
+	std::chrono::milliseconds combat_time{};
+
+	// from the start of the first encounter to the end of the last one
+	auto get_clear_time() const -> std::chrono::system_clock::duration { return this->end_time - this->start_time; }
+};
+
+// clusters logs into sessions as they arrive, all updates are constant time and not thread safe
+class SessionTracker
+{
+public:
+	SessionTracker() {}
+	~SessionTracker() {}
+
+	// logs further apart than this start a new session
+	static constexpr auto session_gap = std::chrono::minutes(30);
+
+	// adds the log to the latest session of the account that recorded it and its category or starts a new one, returns the session id
+	auto add(const EncounterLogData& encounter_log_data) -> uint32_t;
+
+	// applies parse results of a log to the aggregates of its session
+	void update(const EncounterLogData& encounter_log_data);
+
+	// forgets what an evicted log contributes, its session keeps the counts as they are
+	void remove(uint32_t sequence) { this->contributions.erase(sequence); }
+
+	void clear();
+
+	// copied only after a session changed, unchanged sessions are shared by consecutive snapshots
+	auto get_sessions() -> std::shared_ptr<const std::vector<EncounterSession>>;
+
+private:
+	// what a log currently adds to its session, subtracted again before the log is counted anew
+	class Contribution
+	{
+	public:
+		uint32_t session_id = 0;
+		bool kill = false;
+		bool wipe = false;
+		int duration_ms = 0;
+	};
+
+	std::vector<EncounterSession> sessions; // indexed by id - 1
+	std::shared_ptr<const std::vector<EncounterSession>> published_sessions = std::make_shared<const std::vector<EncounterSession>>();
+	bool sessions_changed = false;
+
+	std::map<std::pair<const std::string*, std::string_view>, uint32_t> latest_sessions; // by account and category
+	std::unordered_map<uint32_t, Contribution> contributions; // by log sequence
+};
@@ -3,7 +3,8 @@
 
 namespace global { std::unique_ptr<Settings> settings = std::make_unique<Settings>(); }
 
-#define LOG(message, log_level) global::logger->write(message, log_level, LogSource::Settings)
+#define LOG(message, log_level) do { if (Logger::is_enabled(log_level)) global::logger->write(message, log_level, LogSource::Settings); } while (0)
+#define LOG_FORMAT(log_level, ...) global::logger->write_format(log_level, LogSource::Settings, __VA_ARGS__)
 
 void Settings::initialize(std::filesystem::path settings_file_path)
 {
@@ -106,4 +107,5 @@ bool Settings::save()
 	return false;
 }
 
-#undef LOG
\ No newline at end of file
+#undef LOG
+#undef LOG_FORMAT
\ No newline at end of file
@@ -100,9 +100,33 @@ struct UploaderSettings
 
 		int request_timeout = 180000; // temporary ...
 
-		NLOHMANN_DEFINE_TYPE_INTRUSIVE(EliteInsights, auto_update, update_channel, auto_parse)
+		// MiB of reports kept on disk, the least recently used reports are removed beyond it
+		int report_disk_budget = 2048;
+		auto set_report_disk_budget(int budget) { this->report_disk_budget = std::clamp(budget, 128, 65536); }
+
+		// minutes until an unused report is gzipped, 0 = never
+		int compress_reports_after = 30;
+		auto set_compress_reports_after(int minutes) { this->compress_reports_after = std::clamp(minutes, 0, 1440); }
+
+		NLOHMANN_DEFINE_TYPE_INTRUSIVE(EliteInsights, auto_update, update_channel, auto_parse, report_disk_budget, compress_reports_after)
 	} elite_insights;
 
+	struct Bandwidth
+	{
+		bool limit_uploads = false;
+
+		// KiB/s, 0 = unlimited
+		int in_combat_limit = 256;
+		auto set_in_combat_limit(int limit) { this->in_combat_limit = std::clamp(limit, 0, 102400); }
+
+		int out_of_combat_limit = 0;
+		auto set_out_of_combat_limit(int limit) { this->out_of_combat_limit = std::clamp(limit, 0, 102400); }
+
+		bool compress_evtc = true;
+
+		NLOHMANN_DEFINE_TYPE_INTRUSIVE(Bandwidth, limit_uploads, in_combat_limit, out_of_combat_limit, compress_evtc)
+	} bandwidth;
+
 	struct Display
 	{
 		Hotkey hotkey = Hotkey();
@@ -126,20 +150,49 @@ struct UploaderSettings
 
 		bool clip_to_screen = false;
 
-		NLOHMANN_DEFINE_TYPE_INTRUSIVE(Display, hotkey, window_size, hide_title_bar, hide_background, hide_elite_insights, hide_dps_report, hide_wingman, hide_in_combat, clip_to_screen)
+		int working_set_size = 500; // logs kept in memory, older idle logs are moved to the catalog
+		auto set_working_set_size(int size) { this->working_set_size = std::clamp(size, 50, 10000); }
+
+		NLOHMANN_DEFINE_TYPE_INTRUSIVE(Display, hotkey, window_size, hide_title_bar, hide_background, hide_elite_insights, hide_dps_report, hide_wingman, hide_in_combat, clip_to_screen, working_set_size)
 	} display;
 
+	struct Monitor
+	{
+		// internal, KiB of directory changes read at once, applied on the next start
+		int change_buffer_size = 64;
+		auto set_change_buffer_size(int size) { this->change_buffer_size = std::clamp(size, 4, 1024); }
+
+		// watched next to the arcdps log directory, e.g. of a second client or an archive share, applied on the next start
+		std::vector<std::string> additional_directories;
+
+		NLOHMANN_DEFINE_TYPE_INTRUSIVE(Monitor, change_buffer_size, additional_directories)
+	} monitor;
+
+	struct Diagnostics
+	{
+		// binary trace of detection, parsing and uploads in trace.bin, read with tools/trace_decoder
+		bool trace_pipeline = false;
+
+		NLOHMANN_DEFINE_TYPE_INTRUSIVE(Diagnostics, trace_pipeline)
+	} diagnostics;
+
 	void verify()
 	{
 #define VERIFY_SETTING(path, setting) this->path.set_##setting(this->path.setting)
 
 		VERIFY_SETTING(dps_report, user_token);
 		VERIFY_SETTING(display, window_size);
+		VERIFY_SETTING(display, working_set_size);
+		VERIFY_SETTING(elite_insights, report_disk_budget);
+		VERIFY_SETTING(elite_insights, compress_reports_after);
+		VERIFY_SETTING(bandwidth, in_combat_limit);
+		VERIFY_SETTING(bandwidth, out_of_combat_limit);
+		VERIFY_SETTING(monitor, change_buffer_size);
 
 #undef VERIFY_SETTING
 	}
 
-	NLOHMANN_DEFINE_TYPE_INTRUSIVE(UploaderSettings, dps_report, wingman, elite_insights, display)
+	NLOHMANN_DEFINE_TYPE_INTRUSIVE(UploaderSettings, dps_report, wingman, elite_insights, bandwidth, display, monitor, diagnostics)
 };
 
 class Settings : public Module
@@ -0,0 +1,96 @@
+#include "streaming_quantile.h"
+
+#include <algorithm>
+#include <cmath>
+
+void StreamingQuantile::add(double value)
+{
+	auto& q = this->heights;
+	auto& n = this->positions;
+	auto& np = this->desired_positions;
+
+	// the first five values are kept sorted as they are
+	if (this->count < 5)
+	{
+		q[this->count++] = value;
+		std::sort(q.begin(), q.begin() + this->count);
+
+		if (this->count == 5)
+		{
+			n = { 1., 2., 3., 4., 5. };
+			np = { 1., 1. + 2. * this->quantile, 1. + 4. * this->quantile, 3. + 2. * this->quantile, 5. };
+		}
+
+		return;
+	}
+
+	const std::array<double, 5> increments = { 0., this->quantile / 2., this->quantile, (1. + this->quantile) / 2., 1. };
+
+	size_t k = 0;
+
+	if (value < q[0])
+	{
+		q[0] = value;
+		k = 0;
+	}
+	else if (value >= q[4])
+	{
+		q[4] = value;
+		k = 3;
+	}
+	else
+	{
+		while (value >= q[k + 1])
+			k++;
+	}
+
+	for (auto i = k + 1; i < 5; i++)
+		n[i] += 1.;
+
+	for (size_t i = 0; i < 5; i++)
+		np[i] += increments[i];
+
+	this->count++;
+
+	// moves the middle markers towards their desired positions, parabolic if it keeps them ordered, linear otherwise
+	for (size_t i = 1; i < 4; i++)
+	{
+		const auto d = np[i] - n[i];
+
+		if ((d >= 1. && n[i + 1] - n[i] > 1.) || (d <= -1. && n[i - 1] - n[i] < -1.))
+		{
+			const auto sign = d >= 0. ? 1. : -1.;
+
+			const auto parabolic = q[i] + sign / (n[i + 1] - n[i - 1]) *
+				((n[i] - n[i - 1] + sign) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+				(n[i + 1] - n[i] - sign) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+
+			if (q[i - 1] < parabolic && parabolic < q[i + 1])
+				q[i] = parabolic;
+			else
+			{
+				const auto j = sign > 0. ? i + 1 : i - 1;
+				q[i] = q[i] + sign * (q[j] - q[i]) / (n[j] - n[i]);
+			}
+
+			n[i] += sign;
+		}
+	}
+}
+
+auto StreamingQuantile::get() const -> double
+{
+	if (this->count == 0)
+		return 0.;
+
+	if (this->count < 5)
+	{
+		const auto rank = this->quantile * static_cast<double>(this->count - 1);
+		const auto lower = static_cast<size_t>(std::floor(rank));
+		const auto upper = static_cast<size_t>(std::ceil(rank));
+
+		return this->heights[lower] + (rank - static_cast<double>(lower)) * (this->heights[upper] - this->heights[lower]);
+	}
+
+	return this->heights[2];
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include <nlohmann/json.hpp>
+
+// P² quantile estimate of a stream, constant memory and time per value (Jain & Chlamtac)
+class StreamingQuantile
+{
+public:
+	StreamingQuantile(double quantile = 0.5) : quantile(quantile) {}
+
+	void add(double value);
+
+	// exact until five values were added
+	auto get() const -> double;
+
+	auto get_count() const -> uint64_t { return this->count; }
+
+	NLOHMANN_DEFINE_TYPE_INTRUSIVE(StreamingQuantile, quantile, count, heights, positions, desired_positions)
+
+private:
+	double quantile = 0.5;
+	uint64_t count = 0;
+
+	std::array<double, 5> heights{};
+	std::array<double, 5> positions{};
+	std::array<double, 5> desired_positions{};
+};
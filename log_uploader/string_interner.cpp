@@ -0,0 +1,34 @@
+#include "string_interner.h"
+
+namespace global { std::unique_ptr<StringInterner> string_interner = std::make_unique<StringInterner>(); }
+
+auto StringInterner::intern(std::string_view value) -> const std::string*
+{
+	std::lock_guard lock(this->mutex);
+
+	auto it = this->strings.find(value);
+
+	if (it == this->strings.end())
+		it = this->strings.emplace(value).first;
+
+	// unordered_set nodes never move, the pointer stays valid across rehashes
+	return &*it;
+}
+
+auto StringInterner::get_count() -> size_t
+{
+	std::lock_guard lock(this->mutex);
+	return this->strings.size();
+}
+
+auto StringInterner::get_memory_usage() -> size_t
+{
+	std::lock_guard lock(this->mutex);
+
+	size_t bytes = this->strings.bucket_count() * sizeof(void*);
+
+	for (const auto& string : this->strings)
+		bytes += sizeof(string) + 2 * sizeof(void*) + (string.capacity() > std::string().capacity() ? string.capacity() + 1 : 0);
+
+	return bytes;
+}
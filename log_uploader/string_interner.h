@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+// owns one copy of every distinct string for the lifetime of the addon, interned strings are never released
+class StringInterner
+{
+public:
+	StringInterner() {}
+	~StringInterner() {}
+
+	auto intern(std::string_view value) -> const std::string*;
+
+	auto get_count() -> size_t;
+	auto get_memory_usage() -> size_t;
+
+private:
+	class Hash
+	{
+	public:
+		using is_transparent = void;
+
+		auto operator()(std::string_view value) const -> size_t { return std::hash<std::string_view>{}(value); }
+	};
+
+	std::mutex mutex;
+	std::unordered_set<std::string, Hash, std::equal_to<>> strings;
+};
+
+namespace global { extern std::unique_ptr<StringInterner> string_interner; }
+
+// pointer sized handle to an interned string, copies and comparisons do not touch the heap
+class InternedString
+{
+public:
+	InternedString() = default;
+	InternedString(std::string_view value) : value(value.empty() ? &empty_string() : global::string_interner->intern(value)) {}
+	InternedString(const std::string& value) : InternedString(std::string_view(value)) {}
+	InternedString(const char* value) : InternedString(std::string_view(value)) {}
+
+	auto str() const -> const std::string& { return *this->value; }
+	auto c_str() const -> const char* { return this->value->c_str(); }
+	auto empty() const -> bool { return this->value->empty(); }
+
+	operator const std::string& () const { return *this->value; }
+
+	bool operator==(const InternedString& other) const { return this->value == other.value; }
+
+private:
+	static auto empty_string() -> const std::string&
+	{
+		static const std::string empty;
+		return empty;
+	}
+
+	const std::string* value = &empty_string();
+};
+
+inline std::ostream& operator<<(std::ostream& stream, const InternedString& value)
+{
+	return stream << value.str();
+}
+
+// inline storage for short display strings, longer values are truncated
+template <size_t capacity>
+class FixedString
+{
+public:
+	FixedString() = default;
+	FixedString(std::string_view value) { this->assign(value); }
+	FixedString(const std::string& value) { this->assign(value); }
+	FixedString(const char* value) { this->assign(value); }
+
+	auto c_str() const -> const char* { return this->data; }
+	auto view() const -> std::string_view { return std::string_view(this->data, this->size); }
+	auto empty() const -> bool { return this->size == 0; }
+
+private:
+	static_assert(capacity > 0 && capacity <= 255);
+
+	char data[capacity + 1] = {};
+	unsigned char size = 0;
+
+	void assign(std::string_view value)
+	{
+		this->size = static_cast<unsigned char>(value.copy(this->data, capacity));
+		this->data[this->size] = '\0';
+	}
+};
+
+template <size_t capacity>
+inline std::ostream& operator<<(std::ostream& stream, const FixedString<capacity>& value)
+{
+	return stream << value.view();
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "log_source.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// binary pipeline trace written by Logger::trace and read by tools/trace_decoder
+// a TraceFileHeader followed by fixed size TraceRecords, little-endian as written by x86 and x64
+
+constexpr uint32_t trace_format_version = 1;
+constexpr std::array<char, 8> trace_magic = { 'L', 'U', 'T', 'R', 'A', 'C', 'E', '\0' };
+
+enum class TraceEvent : uint16_t
+{
+	LOG_DETECTED,
+	LOG_READY,
+	LOG_REGISTERED,
+	LOG_DUPLICATE,
+	PARSE_QUEUED,
+	PARSE_STARTED,
+	PARSE_FINISHED,
+	UPLOAD_QUEUED,
+	UPLOAD_STARTED,
+	UPLOAD_FINISHED
+};
+
+class TraceFileHeader
+{
+public:
+	std::array<char, 8> magic = trace_magic;
+	uint32_t version = trace_format_version;
+	uint32_t record_size = 0;
+
+	// taken together when the trace starts, record times are converted to wall clock time with them
+	int64_t steady_time_ns = 0;
+	int64_t system_time_ns = 0; // since the unix epoch
+};
+
+class TraceRecord
+{
+public:
+	int64_t time_ns = 0; // steady clock
+	uint64_t log_id_hash = 0; // see hash_trace_id, 0 for events without a log
+	std::array<int64_t, 3> payload{}; // meaning depends on the event, see get_trace_payload_names
+	uint32_t thread_id = 0;
+	uint16_t source = 0; // LogSource
+	uint16_t event = 0; // TraceEvent
+};
+
+static_assert(std::is_trivially_copyable_v<TraceFileHeader> && sizeof(TraceFileHeader) == 32);
+static_assert(std::is_trivially_copyable_v<TraceRecord> && sizeof(TraceRecord) == 48);
+
+// FNV-1a of the encounter log id, the decoder hashes an id the same way to filter by it
+// detection events happen before the log has an id, they are keyed by the native file path and linked to the id by log_registered
+template <typename Char>
+constexpr auto hash_trace_id(std::basic_string_view<Char> id) -> uint64_t
+{
+	if (id.empty())
+		return 0;
+
+	uint64_t hash = 14695981039346656037ull;
+
+	for (const auto c : id)
+	{
+		hash ^= static_cast<uint64_t>(static_cast<std::make_unsigned_t<Char>>(c));
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
+
+template <typename Char>
+constexpr auto hash_trace_id(const std::basic_string<Char>& id) -> uint64_t
+{
+	return hash_trace_id(std::basic_string_view<Char>(id));
+}
+
+constexpr auto get_trace_event_name(TraceEvent event) -> const char*
+{
+	switch (event)
+	{
+	case TraceEvent::LOG_DETECTED:
+		return "log_detected";
+	case TraceEvent::LOG_READY:
+		return "log_ready";
+	case TraceEvent::LOG_REGISTERED:
+		return "log_registered";
+	case TraceEvent::LOG_DUPLICATE:
+		return "log_duplicate";
+	case TraceEvent::PARSE_QUEUED:
+		return "parse_queued";
+	case TraceEvent::PARSE_STARTED:
+		return "parse_started";
+	case TraceEvent::PARSE_FINISHED:
+		return "parse_finished";
+	case TraceEvent::UPLOAD_QUEUED:
+		return "upload_queued";
+	case TraceEvent::UPLOAD_STARTED:
+		return "upload_started";
+	case TraceEvent::UPLOAD_FINISHED:
+		return "upload_finished";
+	default:
+		return "unknown";
+	}
+}
+
+// empty names are unused payloads
+constexpr auto get_trace_payload_names(TraceEvent event) -> std::array<const char*, 3>
+{
+	switch (event)
+	{
+	case TraceEvent::LOG_DETECTED:
+		return { "queue_depth", "recovered", "" };
+	case TraceEvent::LOG_READY:
+		return { "readiness_ms", "file_size", "" };
+	case TraceEvent::LOG_REGISTERED:
+		return { "file_hash", "root", "trigger_id" };
+	case TraceEvent::PARSE_QUEUED:
+		return { "queue_depth", "", "" };
+	case TraceEvent::PARSE_FINISHED:
+		return { "parse_status", "duration_ms", "" };
+	case TraceEvent::UPLOAD_STARTED:
+		return { "file_size", "", "" };
+	case TraceEvent::UPLOAD_FINISHED:
+		return { "status_code", "uploaded", "duration_ms" };
+	default:
+		return { "", "", "" };
+	}
+}
@@ -1,9 +1,16 @@
+#include "bandwidth_limiter.h"
+#include "change_bus.h"
+#include "directory_monitor.h"
 #include "dps_report_uploader.h"
 #include "elite_insights.h"
+#include "encounter_statistics.h"
+#include "http_metrics.h"
 #include "imgui_ex.h"
+#include "log_catalog.h"
 #include "log_manager.h"
 #include "logger.h"
 #include "mumble_link.h"
+#include "report_store.h"
 #include "ui.h"
 #include "wingman_uploader.h"
 
@@ -12,7 +19,8 @@
 
 namespace global { std::unique_ptr<UI> ui = std::make_unique<UI>(); }
 
-#define LOG(message, log_level) global::logger->write(message, log_level, LogSource::UI)
+#define LOG(message, log_level) do { if (Logger::is_enabled(log_level)) global::logger->write(message, log_level, LogSource::UI); } while (0)
+#define LOG_FORMAT(log_level, ...) global::logger->write_format(log_level, LogSource::UI, __VA_ARGS__)
 
 #define SAVE_SETTING(Setting) \
 global::settings->write([this](auto& _settings) \
@@ -32,6 +40,17 @@ void UI::initialize()
 	this->initialized.store(true);
 }
 
+void UI::release()
+{
+	std::lock_guard lock(this->initialization_mutex);
+
+	this->initialized.store(false);
+
+	// the last references to the logs should not outlive the modules their destructors rely on
+	this->encounter_logs.reset();
+	this->filtered_logs.clear();
+}
+
 void UI::draw()
 {
 	if (!this->is_initialized())
@@ -43,6 +62,8 @@ void UI::draw()
 	{
 		const auto in_combat = (global::mumble_link->get_memory().getMumbleContext()->uiState & UiStateFlags_::UiStateFlags_InCombat) != 0;
 
+		global::bandwidth_limiter->set_in_combat(in_combat);
+
 		if (!in_combat)
 			this->force_open.store(false);
 
@@ -70,8 +91,14 @@ void UI::draw_arc_window_options()
 
 	if (ImGui::Checkbox("Log Uploader", &open))
 		if (open != open_base)
+		{
 			this->open.store(open);
 
+			// logs paged in to browse them are only kept while the window stays open
+			if (!open)
+				global::log_manager->unpin_paged_in();
+		}
+
 	ImGui::PopStyleVar();
 }
 
@@ -103,12 +130,22 @@ void UI::draw_arc_mod_options()
 	{
 		this->draw_wingman_settings();
 	}
+	ImGui::Spacing();
+	if (ImGui::CollapsingHeader("Bandwidth", ImGuiTreeNodeFlags_DefaultOpen))
+	{
+		this->draw_bandwidth_settings();
+	}
 }
 
 void UI::on_open_hotkey()
 {
-	this->open.store(!this->open.load());
+	const auto open = !this->open.load();
+
+	this->open.store(open);
 	this->force_open.store(!this->force_open.load());
+
+	if (!open)
+		global::log_manager->unpin_paged_in();
 }
 
 void UI::refresh_settings_cache()
@@ -118,10 +155,67 @@ void UI::refresh_settings_cache()
 
 void UI::refresh_encounter_logs()
 {
-	this->encounter_logs.clear();
+	auto snapshot = global::log_manager->get_snapshot();
 
-	for (auto& encounter_log : global::log_manager->get_encounter_logs())
-		this->encounter_logs.push_back(std::make_tuple(encounter_log, encounter_log->get_data()));
+	// rows are immutable, the frame only needs to pick up a new snapshot when something changed
+	if (this->encounter_logs && this->encounter_logs->version == snapshot->version)
+		return;
+
+	this->encounter_logs = std::move(snapshot);
+
+	// the context menu shows the filtered logs on every tab, they must follow each snapshot
+	this->refresh_filtered_logs();
+}
+
+void UI::refresh_filtered_logs()
+{
+	// a cleared filter shows the snapshot rows, the filtered rows would only keep their logs alive
+	if (this->filter.empty())
+	{
+		this->filtered_logs.clear();
+		this->cold_matches.clear();
+		this->filter_dirty = false;
+		return;
+	}
+
+	if (!this->filter_dirty && this->filtered_version == this->encounter_logs->version)
+		return;
+
+	auto result = global::log_manager->query(this->filter);
+
+	this->filtered_logs.clear();
+
+	// the index and the snapshot are published together, lookups only miss for logs evicted in between
+	for (const auto sequence : result.sequences)
+		if (auto row = this->encounter_logs->find(sequence); row != this->encounter_logs->rows.end())
+			this->filtered_logs.push_back(*row);
+
+	this->cold_matches = std::move(result.cold_sequences);
+	this->filtered_version = this->encounter_logs->version;
+	this->filter_dirty = false;
+}
+
+void UI::draw_filter_bar()
+{
+	ImGui::SetNextItemWidth(-FLT_MIN);
+
+	if (ImGui::InputTextWithHint("##filter", "Filter logs", this->filter_text, sizeof(this->filter_text)))
+	{
+		this->filter = LogFilter::parse(this->filter_text);
+		this->filter_dirty = true;
+	}
+
+	ImGui::DelayedTooltipText("Space separated terms are combined, comma separated values within a term match any of them.\n\n"
+		"boss:<name>   account:<name>   trigger:<id>\n"
+		"result:success|fail   mode:nm|cm|lcm|unknown\n"
+		"parse:<status>   dps:<status>   wingman:<status>\n"
+		"since:<n>m|h|d|w   after:<YYYY-MM-DD>   before:<YYYY-MM-DD>\n\n"
+		"Words without a prefix match the encounter name.");
+
+	if (this->filter.error_message.has_value())
+		ImGui::TextColored(ImVec4(1.f, 0.35f, 0.35f, 1.f), "%s", this->filter.error_message.value().c_str());
+
+	this->refresh_filtered_logs();
 }
 
 void UI::draw_main_window()
@@ -153,210 +247,593 @@ void UI::draw_main_window()
 	if (ImGui::Begin("Log Uploader", &open, window_flags))
 	{
 		if (open != open_base)
+		{
 			this->open.store(open);
 
+			// logs paged in to browse them are only kept while the window stays open
+			if (!open)
+				global::log_manager->unpin_paged_in();
+		}
+
 		if (this->settings.display.clip_to_screen)
 			ImGui::ClipWindowToScreen();
 
-		auto column_count = static_cast<int>(LogTableColumns::_COUNT);
+		if (ImGui::BeginTabBar("Main Tabs"))
+		{
+			if (ImGui::BeginTabItem("Logs"))
+			{
+				this->draw_log_table();
+				ImGui::EndTabItem();
+			}
 
-		if (this->settings.display.hide_elite_insights)
-			column_count--;
-		if (this->settings.display.hide_dps_report)
-			column_count--;
-		if (this->settings.display.hide_wingman)
-			column_count--;
+			if (ImGui::BeginTabItem("Statistics"))
+			{
+				this->draw_statistics();
+				ImGui::EndTabItem();
+			}
 
-		std::deque<std::pair<std::shared_ptr<EncounterLog>, EncounterLogData>> all_log_data;
+			ImGui::EndTabBar();
+		}
 
-		if (ImGui::BeginTable("Logs Table", column_count, ImGuiTableFlags_BordersH))
+		this->draw_context_menu();
+	}
+
+	if (hide_background)
+		ImGui::PopStyleColor(2);
+
+	ImGui::PopStyleVar();
+	ImGui::End();
+}
+
+void UI::draw_log_table()
+{
+	auto column_count = static_cast<int>(LogTableColumns::_COUNT);
+
+	if (this->settings.display.hide_elite_insights)
+		column_count--;
+	if (this->settings.display.hide_dps_report)
+		column_count--;
+	if (this->settings.display.hide_wingman)
+		column_count--;
+
+	this->draw_filter_bar();
+
+	const auto& visible_logs = this->get_visible_logs();
+
+	if (ImGui::BeginTable("Logs Table", column_count, ImGuiTableFlags_BordersH))
+	{
+		static bool select_all_toggle = false;
+		bool select_all = false;
+		bool all_selected = true;
+
+		auto get_column_width = [](const char* text) -> float // please forgive me
+			{
+				return ImGui::CalcTextSize(text).x + 2.f;
+			};
+
+		ImGui::TableSetupColumn("##select_all", ImGuiTableColumnFlags_WidthFixed, ImGui::GetTextLineHeight());
+		ImGui::TableSetupColumn("Time", ImGuiTableColumnFlags_WidthFixed, get_column_width("00:00"));
+		ImGui::TableSetupColumn("Encounter", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("Result", ImGuiTableColumnFlags_WidthFixed, ImGui::GetTextLineHeightWithSpacing() / 2 + get_column_width("100.000%"));
+		ImGui::TableSetupColumn("Duration", ImGuiTableColumnFlags_WidthFixed, get_column_width("00m 00s 000ms"));
+		if (!this->settings.display.hide_elite_insights)
+			ImGui::TableSetupColumn("Report", ImGuiTableColumnFlags_WidthFixed, get_column_width("XXXXXXXXXXX"));
+		if (!this->settings.display.hide_dps_report)
+			ImGui::TableSetupColumn("dps.report", ImGuiTableColumnFlags_WidthFixed, get_column_width("XXXXXXXXXXX"));
+		if (!this->settings.display.hide_wingman)
+			ImGui::TableSetupColumn("Wingman", ImGuiTableColumnFlags_WidthFixed, get_column_width("XXXXXXXXXXX"));
+
+		ImGui::TableNextRow(ImGuiTableRowFlags_Headers);
+		for (int column = LogTableColumns::SELECT; column < column_count; column++)
 		{
-			static bool select_all_toggle = false;
-			bool select_all = false;
-			bool all_selected = true;
+			ImGui::TableSetColumnIndex(column);
+			ImGui::PushID(&column);
+			if (column == LogTableColumns::SELECT)
+			{
+				if (!visible_logs.empty())
+					if (ImGui::SmallCheckbox("##select_all", &select_all_toggle))
+						select_all = true;
+			}
+			else
+			{
+				if (column == LogTableColumns::REPORT || column == LogTableColumns::DPS_REPORT || column == LogTableColumns::WINGMAN)
+					ImGui::CenterNextItemHorizontally(ImGui::TableGetColumnName(column));
 
-			auto get_column_width = [](const char* text) -> float // please forgive me
-				{
-					return ImGui::CalcTextSize(text).x + 2.f;
-				};
-
-			ImGui::TableSetupColumn("##select_all", ImGuiTableColumnFlags_WidthFixed, ImGui::GetTextLineHeight());
-			ImGui::TableSetupColumn("Time", ImGuiTableColumnFlags_WidthFixed, get_column_width("00:00"));
-			ImGui::TableSetupColumn("Encounter", ImGuiTableColumnFlags_WidthStretch);
-			ImGui::TableSetupColumn("Result", ImGuiTableColumnFlags_WidthFixed, ImGui::GetTextLineHeightWithSpacing() / 2 + get_column_width("100.000%"));
-			ImGui::TableSetupColumn("Duration", ImGuiTableColumnFlags_WidthFixed, get_column_width("00m 00s 000ms"));
-			if (!this->settings.display.hide_elite_insights)
-				ImGui::TableSetupColumn("Report", ImGuiTableColumnFlags_WidthFixed, get_column_width("XXXXXXXXXXX"));
-			if (!this->settings.display.hide_dps_report)
-				ImGui::TableSetupColumn("dps.report", ImGuiTableColumnFlags_WidthFixed, get_column_width("XXXXXXXXXXX"));
-			if (!this->settings.display.hide_wingman)
-				ImGui::TableSetupColumn("Wingman", ImGuiTableColumnFlags_WidthFixed, get_column_width("XXXXXXXXXXX"));
+				ImGui::TextUnformatted(ImGui::TableGetColumnName(column));
+			}
+			ImGui::PopID();
+		}
+
+		for (const auto& [encounter_log, encounter_log_row] : visible_logs)
+		{
+			const auto& encounter_log_data = *encounter_log_row;
+
+			ImGui::ID log_id(encounter_log_data.id);
+
+			auto selected = select_all ? select_all_toggle : encounter_log_data.view.selected;
+
+			if (!selected)
+				all_selected = false;
 
-			ImGui::TableNextRow(ImGuiTableRowFlags_Headers);
-			for (int column = LogTableColumns::SELECT; column < column_count; column++)
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+
+			if ((ImGui::SmallCheckbox("##select", &selected) || select_all) && selected != encounter_log_data.view.selected)
 			{
-				ImGui::TableSetColumnIndex(column);
-				ImGui::PushID(&column);
-				if (column == LogTableColumns::SELECT)
 				{
-					if (!this->encounter_logs.empty())
-						if (ImGui::SmallCheckbox("##select_all", &select_all_toggle))
-							select_all = true;
+					std::unique_lock lock(encounter_log->mutex);
+					encounter_log->view.selected = selected;
 				}
-				else
-				{
-					if (column == LogTableColumns::REPORT || column == LogTableColumns::DPS_REPORT || column == LogTableColumns::WINGMAN)
-						ImGui::CenterNextItemHorizontally(ImGui::TableGetColumnName(column));
 
-					ImGui::TextUnformatted(ImGui::TableGetColumnName(column));
-				}
-				ImGui::PopID();
+				global::change_bus->post(encounter_log, LogChange::SELECTION);
 			}
 
-			for (auto [encounter_log, encounter_log_data] : this->encounter_logs)
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(encounter_log_data.view.time.c_str());
+			if (ImGui::IsItemHovered())
 			{
-				ImGui::ID log_id(encounter_log_data.id);
+				auto timestamp_from_timepoint = [](const std::chrono::system_clock::time_point& timepoint)
+					{
 
-				if (select_all)
-					encounter_log_data.view.selected = select_all_toggle;
+						auto sys_time = std::chrono::clock_cast<std::chrono::system_clock>(timepoint);
+						auto sys_time_trunc = std::chrono::floor<std::chrono::seconds>(sys_time);
 
-				if (!encounter_log_data.view.selected)
-					all_selected = false;
+						std::chrono::zoned_time local_time{ std::chrono::current_zone(), sys_time_trunc };
 
-				ImGui::TableNextRow();
+						std::string formatted_time = std::format("{:%d %B %Y, %H:%M:%S}", local_time);
+
+						// Format timestamp
+						std::ostringstream timestamp_stream;
+
+						timestamp_stream << formatted_time;
+
+						// Get the current time
+						auto now = std::chrono::system_clock::now();
+
+						// Calculate difference
+						auto diff = now - timepoint;
+
+						// Components of the difference
+						std::vector<std::pair<int64_t, std::string>> components = {
+							{std::chrono::duration_cast<std::chrono::years>(diff).count(), "y"},
+							{std::chrono::duration_cast<std::chrono::months>(diff % std::chrono::years(1)).count(), "M"},
+							{std::chrono::duration_cast<std::chrono::days>(diff % std::chrono::months(1)).count(), "d"},
+							{std::chrono::duration_cast<std::chrono::hours>(diff % std::chrono::days(1)).count(), "h"},
+							{std::chrono::duration_cast<std::chrono::minutes>(diff % std::chrono::hours(1)).count(), "m"},
+							{std::chrono::duration_cast<std::chrono::seconds>(diff % std::chrono::minutes(1)).count(), "s"}
+						};
+
+						// Build dynamic "X ago" string
+						std::ostringstream ago_stream;
+						bool first = true;
+						for (const auto& [value, unit] : components)
+						{
+							if (value > 0)
+							{
+								ago_stream << value << unit + " ";
+								first = false;
+							}
+						}
+
+						if (first)
+							ago_stream << "now";
+						else
+							ago_stream << "ago";
+
+						// Combine and return the result
+						return timestamp_stream.str() + " (" + ago_stream.str() + ")";
+					};
+
+				ImGui::BeginTooltip();
+				ImGui::TextUnformatted(timestamp_from_timepoint(encounter_log_data.parse_status != ParseStatus::PARSED ? encounter_log_data.evtc_data.time : encounter_log_data.encounter_data.end_time).c_str());
+				ImGui::EndTooltip();
+			}
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(encounter_log_data.view.name.c_str());
+			ImGui::TableNextColumn();
+			if (encounter_log_data.parse_status == ParseStatus::PARSED)
+				ImGui::Indicator(encounter_log_data.encounter_data.success ? Color::Green : Color::Red);
+			else
+				ImGui::Indicator(Color::Gray);
+			ImGui::SameLine();
+			ImGui::TextUnformatted(encounter_log_data.view.result.c_str());
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(encounter_log_data.view.duration.c_str());
+
+			if (!this->settings.display.hide_elite_insights)
+			{
 				ImGui::TableNextColumn();
+				if (ImGui::ButtonParser(encounter_log_data.parse_status, encounter_log_data.view.opening_report))
+				{
+					if (encounter_log_data.parse_status == ParseStatus::UNPARSED)
+						global::elite_insights->queue_encounter_log(encounter_log);
+					else if (encounter_log_data.parse_status == ParseStatus::PARSED)
+						global::report_store->open(encounter_log);
+				}
+				if (encounter_log_data.report_data.error_message.has_value())
+					ImGui::DelayedTooltipText(encounter_log_data.report_data.error_message.value().c_str());
+			}
 
-				if (ImGui::SmallCheckbox("##select", &encounter_log_data.view.selected) || select_all)
+			if (!this->settings.display.hide_dps_report)
+			{
+				ImGui::TableNextColumn();
+				if (ImGui::ButtonDpsReport(encounter_log_data.dps_report_upload.status, encounter_log_data.view.dps_report_progress))
 				{
-					std::unique_lock lock(encounter_log->mutex);
-					encounter_log->view.selected = encounter_log_data.view.selected;
+					if (encounter_log_data.dps_report_upload.status == DpsReportUploadStatus::AVAILABLE || encounter_log_data.dps_report_upload.status == DpsReportUploadStatus::FAILED)
+						global::dps_report_uploader->queue_upload(encounter_log);
+					else if (encounter_log_data.dps_report_upload.status == DpsReportUploadStatus::UPLOADED && !encounter_log_data.dps_report_upload.url.empty())
+						ShellExecuteA(nullptr, "open", encounter_log_data.dps_report_upload.url.c_str(), nullptr, nullptr, SW_SHOWNORMAL);
 				}
+				if (encounter_log_data.dps_report_upload.error_message.has_value())
+					ImGui::DelayedTooltipText(encounter_log_data.dps_report_upload.error_message.value().c_str());
+			}
 
+			if (!this->settings.display.hide_wingman)
+			{
 				ImGui::TableNextColumn();
-				ImGui::TextUnformatted(encounter_log_data.view.time.c_str());
-				if (ImGui::IsItemHovered())
+				if (ImGui::ButtonWingman(encounter_log_data.wingman_upload.status, encounter_log_data.parse_status, encounter_log_data.view.wingman_progress))
 				{
-					auto timestamp_from_timepoint = [](const std::chrono::system_clock::time_point& timepoint)
-						{
+					if (encounter_log_data.wingman_upload.status == WingmanUploadStatus::AVAILABLE && encounter_log_data.parse_status == ParseStatus::PARSED)
+						global::wingman_uploader->queue_upload(encounter_log);
+				}
+				if (encounter_log_data.wingman_upload.error_message.has_value())
+					ImGui::DelayedTooltipText(encounter_log_data.wingman_upload.error_message.value().c_str());
+			}
+		}
 
-							auto sys_time = std::chrono::clock_cast<std::chrono::system_clock>(timepoint);
-							auto sys_time_trunc = std::chrono::floor<std::chrono::seconds>(sys_time);
+		if (!this->filter.empty())
+		{
+			if (!this->cold_matches.empty())
+			{
+				ImGui::TableNextRow();
+				ImGui::TableSetColumnIndex(LogTableColumns::ENCOUNTER);
 
-							std::chrono::zoned_time local_time{ std::chrono::current_zone(), sys_time_trunc };
+				const auto label = "Load matching older logs (" + std::to_string(this->cold_matches.size()) + ")";
 
-							std::string formatted_time = std::format("{:%d %B %Y, %H:%M:%S}", local_time);
+				if (ImGui::Selectable(label.c_str()))
+				{
+					auto count = min(this->cold_matches.size(), static_cast<size_t>(50));
+					global::log_manager->page_in_sequences(std::vector<uint32_t>(this->cold_matches.begin(), this->cold_matches.begin() + count));
+				}
+			}
+		}
+		else if (const auto cold_count = global::log_catalog->get_count(); cold_count > 0)
+		{
+			ImGui::TableNextRow();
+			ImGui::TableSetColumnIndex(LogTableColumns::ENCOUNTER);
 
-							// Format timestamp
-							std::ostringstream timestamp_stream;
+			const auto label = "Load older logs (" + std::to_string(cold_count) + ")";
 
-							timestamp_stream << formatted_time;
+			// pages in automatically once the user scrolled to the end of the table
+			if (ImGui::Selectable(label.c_str()) || (ImGui::IsItemVisible() && ImGui::GetScrollMaxY() > 0.f && ImGui::GetScrollY() >= ImGui::GetScrollMaxY()))
+				global::log_manager->page_in(50);
+		}
 
-							// Get the current time
-							auto now = std::chrono::system_clock::now();
+		select_all_toggle = all_selected;
+	}
+	ImGui::EndTable();
+}
 
-							// Calculate difference
-							auto diff = now - timepoint;
+void UI::draw_statistics()
+{
+	const auto statistics = global::encounter_statistics->get_snapshot();
 
-							// Components of the difference
-							std::vector<std::pair<int64_t, std::string>> components = {
-								{std::chrono::duration_cast<std::chrono::years>(diff).count(), "y"},
-								{std::chrono::duration_cast<std::chrono::months>(diff % std::chrono::years(1)).count(), "M"},
-								{std::chrono::duration_cast<std::chrono::days>(diff % std::chrono::months(1)).count(), "d"},
-								{std::chrono::duration_cast<std::chrono::hours>(diff % std::chrono::days(1)).count(), "h"},
-								{std::chrono::duration_cast<std::chrono::minutes>(diff % std::chrono::hours(1)).count(), "m"},
-								{std::chrono::duration_cast<std::chrono::seconds>(diff % std::chrono::minutes(1)).count(), "s"}
-							};
+	if (statistics->empty())
+	{
+		ImGui::TextDisabled("No encounters recorded yet, statistics are collected as logs are parsed");
+		return;
+	}
 
-							// Build dynamic "X ago" string
-							std::ostringstream ago_stream;
-							bool first = true;
-							for (const auto& [value, unit] : components)
-							{
-								if (value > 0)
-								{
-									ago_stream << value << unit + " ";
-									first = false;
-								}
-							}
+	auto format_duration = [](int duration_ms) -> std::string
+		{
+			if (duration_ms <= 0)
+				return "-";
 
-							if (first)
-								ago_stream << "now";
-							else
-								ago_stream << "ago";
+			return std::format("{}m {:02}s", duration_ms / 60000, (duration_ms / 1000) % 60);
+		};
 
-							// Combine and return the result
-							return timestamp_stream.str() + " (" + ago_stream.str() + ")";
-						};
+	auto get_difficulty_name = [](EncounterDifficulty difficulty) -> const char*
+		{
+			switch (difficulty)
+			{
+			case EncounterDifficulty::NORMAL_MODE:
+				return "NM";
+			case EncounterDifficulty::CHALLENGE_MODE:
+				return "CM";
+			case EncounterDifficulty::LEGENDARY_CHALLENGE_MODE:
+				return "LCM";
+			default:
+				return "EM";
+			}
+		};
 
-					ImGui::BeginTooltip();
-					ImGui::TextUnformatted(timestamp_from_timepoint(encounter_log_data.parse_status != ParseStatus::PARSED ? encounter_log_data.evtc_data.time : encounter_log_data.encounter_data.end_time).c_str());
-					ImGui::EndTooltip();
-				}
-				ImGui::TableNextColumn();
-				ImGui::TextUnformatted(encounter_log_data.view.name.c_str());
-				ImGui::TableNextColumn();
-				if (encounter_log_data.parse_status == ParseStatus::PARSED)
-					ImGui::Indicator(encounter_log_data.encounter_data.success ? Color::Green : Color::Red);
-				else
-					ImGui::Indicator(Color::Gray);
-				ImGui::SameLine();
-				ImGui::TextUnformatted(encounter_log_data.view.result.c_str());
-				ImGui::TableNextColumn();
-				ImGui::TextUnformatted(encounter_log_data.view.duration.c_str());
+	if (ImGui::BeginTable("Statistics Table", 6, ImGuiTableFlags_BordersH | ImGuiTableFlags_ScrollY))
+	{
+		auto get_column_width = [](const char* text) -> float
+			{
+				return ImGui::CalcTextSize(text).x + 2.f;
+			};
+
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Encounter", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("Mode", ImGuiTableColumnFlags_WidthFixed, get_column_width("LCM"));
+		ImGui::TableSetupColumn("Kills", ImGuiTableColumnFlags_WidthFixed, get_column_width("0000 / 0000"));
+		ImGui::TableSetupColumn("Success", ImGuiTableColumnFlags_WidthFixed, get_column_width("100.0%"));
+		ImGui::TableSetupColumn("Best", ImGuiTableColumnFlags_WidthFixed, get_column_width("00m 00s"));
+		ImGui::TableSetupColumn("Median", ImGuiTableColumnFlags_WidthFixed, get_column_width("00m 00s"));
+		ImGui::TableHeadersRow();
+
+		for (const auto& [key, statistic] : *statistics)
+		{
+			const auto& [trigger_id, difficulty] = key;
+
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			if (!statistic.encounter_name.empty())
+				ImGui::TextUnformatted(statistic.encounter_name.c_str());
+			else if (auto it = global::trigger_id_encounter_name_map.find(trigger_id); it != global::trigger_id_encounter_name_map.end())
+				ImGui::TextUnformatted(it->second.c_str());
+			else
+				ImGui::TextUnformatted("Undefined");
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(get_difficulty_name(difficulty));
+			ImGui::TableNextColumn();
+			ImGui::Text("%u / %u", statistic.kills, statistic.attempts);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f%%", statistic.get_success_rate() * 100.f);
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(format_duration(statistic.best_kill_ms).c_str());
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(format_duration(static_cast<int>(statistic.median_kill_ms.get())).c_str());
+			if (statistic.median_kill_ms.get_count() >= 5)
+				ImGui::DelayedTooltipText("Estimated from all kills without keeping them");
+		}
+
+		ImGui::EndTable();
+	}
+}
+
+void UI::draw_log_actions(const std::deque<EncounterLogRow>& logs)
+{
+	auto get_encounter_logs = [](const std::deque<EncounterLogRow>& rows) -> std::vector<std::shared_ptr<EncounterLog>>
+		{
+			std::vector<std::shared_ptr<EncounterLog>> encounter_logs;
+			encounter_logs.reserve(rows.size());
+
+			for (auto& [encounter_log, _] : rows)
+				encounter_logs.push_back(encounter_log);
+
+			return encounter_logs;
+		};
+
+	struct LogAction
+	{
+		enum Type
+		{
+			PARSE,
+			OPEN_REPORTS,
+			UPLOAD_TO_DPS_REPORT,
+			COPY_DPS_REPORT_URLS,
+			UPLOAD_TO_WINGMAN,
+			_COUNT
+		};
+	};
+
+	std::array<std::deque<EncounterLogRow>, LogAction::_COUNT> action_logs;
+
+	for (auto& [encounter_log, encounter_log_data] : logs)
+	{
+		if (encounter_log_data->parse_status == ParseStatus::PARSED)
+		{
+			// Open Reports
+			action_logs[LogAction::OPEN_REPORTS].emplace_back(encounter_log, encounter_log_data);
+
+			// Upload to Wingman
+			if (encounter_log_data->wingman_upload.status == WingmanUploadStatus::AVAILABLE ||
+				encounter_log_data->wingman_upload.status == WingmanUploadStatus::FAILED)
+			{
+				action_logs[LogAction::UPLOAD_TO_WINGMAN].emplace_back(encounter_log, encounter_log_data);
+			}
+		}
+		else if (encounter_log_data->parse_status == ParseStatus::UNPARSED)
+		{
+			// Parse
+			action_logs[LogAction::PARSE].emplace_back(encounter_log, encounter_log_data);
+		}
+
+		// Upload to dps.report
+		if (encounter_log_data->dps_report_upload.status == DpsReportUploadStatus::AVAILABLE ||
+			encounter_log_data->dps_report_upload.status == DpsReportUploadStatus::FAILED)
+		{
+			action_logs[LogAction::UPLOAD_TO_DPS_REPORT].emplace_back(encounter_log, encounter_log_data);
+		}
+
+		// Copy dps.report URLs
+		if (encounter_log_data->dps_report_upload.status == DpsReportUploadStatus::UPLOADED &&
+			!encounter_log_data->dps_report_upload.url.empty())
+		{
+			action_logs[LogAction::COPY_DPS_REPORT_URLS].emplace_back(encounter_log, encounter_log_data);
+		}
+	}
+
+	bool options_available = false;
+
+	// Parse
+	if (!action_logs[LogAction::PARSE].empty())
+	{
+		options_available = true;
+		if (ImGui::MenuItem(("Parse (" + std::to_string(action_logs[LogAction::PARSE].size()) + ")").c_str()))
+		{
+			global::elite_insights->queue_encounter_logs(get_encounter_logs(action_logs[LogAction::PARSE]));
+		}
+	}
+
+	// Open Reports
+	if (!action_logs[LogAction::OPEN_REPORTS].empty())
+	{
+		options_available = true;
+		if (ImGui::MenuItem(("Open reports (" + std::to_string(action_logs[LogAction::OPEN_REPORTS].size()) + ")").c_str()))
+		{
+			for (auto& [encounter_log, encounter_log_data] : action_logs[LogAction::OPEN_REPORTS])
+			{
+				global::report_store->open(encounter_log);
+			}
+		}
+	}
 
-				if (!this->settings.display.hide_elite_insights)
+	// Upload to dps.report
+	if (!action_logs[LogAction::UPLOAD_TO_DPS_REPORT].empty())
+	{
+		options_available = true;
+		if (ImGui::MenuItem(("Upload to dps.report (" + std::to_string(action_logs[LogAction::UPLOAD_TO_DPS_REPORT].size()) + ")").c_str()))
+		{
+			global::dps_report_uploader->queue_uploads(get_encounter_logs(action_logs[LogAction::UPLOAD_TO_DPS_REPORT]));
+		}
+	}
+
+	// Copy dps.report URLs
+	if (!action_logs[LogAction::COPY_DPS_REPORT_URLS].empty())
+	{
+		options_available = true;
+		if (ImGui::BeginMenu(("Copy dps.report URLs (" + std::to_string(action_logs[LogAction::COPY_DPS_REPORT_URLS].size()) + ")").c_str()))
+		{
+			if (ImGui::MenuItem("As raw list"))
+			{
+				std::string urls;
+				for (auto& [_, encounter_log_data] : action_logs[LogAction::COPY_DPS_REPORT_URLS])
 				{
-					ImGui::TableNextColumn();
-					if (ImGui::ButtonParser(encounter_log_data.parse_status))
-					{
-						if (encounter_log_data.parse_status == ParseStatus::UNPARSED)
-							global::elite_insights->queue_encounter_log(encounter_log);
-						else if (encounter_log_data.parse_status == ParseStatus::PARSED)
-							ShellExecute(nullptr, L"open", encounter_log_data.report_data.html_file_path.c_str(), nullptr, nullptr, SW_SHOWNORMAL);
-					}
-					if (encounter_log_data.report_data.error_message.has_value())
-						ImGui::DelayedTooltipText(encounter_log_data.report_data.error_message.value().c_str());
+					urls += encounter_log_data->dps_report_upload.url + "\n";
 				}
+				if (!urls.empty())
+				{
+					ImGui::SetClipboardText(urls.c_str());
+				}
+			}
 
-				if (!this->settings.display.hide_dps_report)
+			if (ImGui::MenuItem("As markdown links"))
+			{
+				std::stringstream ss;
+				for (auto& [_, encounter_log_data] : action_logs[LogAction::COPY_DPS_REPORT_URLS])
 				{
-					ImGui::TableNextColumn();
-					if (ImGui::ButtonDpsReport(encounter_log_data.dps_report_upload.status))
-					{
-						if (encounter_log_data.dps_report_upload.status == DpsReportUploadStatus::AVAILABLE || encounter_log_data.dps_report_upload.status == DpsReportUploadStatus::FAILED)
-							global::dps_report_uploader->queue_upload(encounter_log);
-						else if (encounter_log_data.dps_report_upload.status == DpsReportUploadStatus::UPLOADED && !encounter_log_data.dps_report_upload.url.empty())
-							ShellExecuteA(nullptr, "open", encounter_log_data.dps_report_upload.url.c_str(), nullptr, nullptr, SW_SHOWNORMAL);
-					}
-					if (encounter_log_data.dps_report_upload.error_message.has_value())
-						ImGui::DelayedTooltipText(encounter_log_data.dps_report_upload.error_message.value().c_str());
+					if (encounter_log_data->parse_status == ParseStatus::PARSED)
+						ss << "[" << encounter_log_data->view.name << " (" << encounter_log_data->view.duration
+						<< (!encounter_log_data->encounter_data.success ? " | " + (encounter_log_data->encounter_data.valid_boss ? std::format("{:.2f}%", 100.f - encounter_log_data->encounter_data.health_percent_burned) + " left" : "failure") : "")
+						<< ")](" << encounter_log_data->dps_report_upload.url << ")"
+						<< "\n";
+					else
+						ss << "[" << encounter_log_data->view.name << "](" << encounter_log_data->dps_report_upload.url << ")\n";
 				}
+				ImGui::SetClipboardText(ss.str().c_str());
+			}
+			ImGui::EndMenu();
+		}
+	}
+
+	// Upload to Wingman
+	if (!action_logs[LogAction::UPLOAD_TO_WINGMAN].empty())
+	{
+		options_available = true;
+		if (ImGui::MenuItem(("Upload to Wingman (" + std::to_string(action_logs[LogAction::UPLOAD_TO_WINGMAN].size()) + ")").c_str()))
+		{
+			global::wingman_uploader->queue_uploads(get_encounter_logs(action_logs[LogAction::UPLOAD_TO_WINGMAN]));
+		}
+	}
+
+	if (!options_available)
+	{
+		ImGui::TextDisabled("No options available");
+	}
+}
+
+void UI::draw_session_menu()
+{
+	const auto& sessions = *this->encounter_logs->sessions;
+
+	if (sessions.empty())
+		return;
+
+	constexpr size_t max_sessions = 10;
+
+	auto format_time = [](const std::chrono::system_clock::time_point& time_point)
+		{
+			return std::format("{:%H:%M}", std::chrono::zoned_time{ std::chrono::current_zone(), std::chrono::floor<std::chrono::minutes>(time_point) });
+		};
+
+	auto format_duration = [](std::chrono::system_clock::duration duration)
+		{
+			const auto minutes = std::chrono::duration_cast<std::chrono::minutes>(duration).count();
+			return minutes >= 60 ? std::format("{}h {}m", minutes / 60, minutes % 60) : std::format("{}m", minutes);
+		};
+
+	if (ImGui::BeginMenu(("Sessions (" + std::to_string(sessions.size()) + ")").c_str()))
+	{
+		for (auto it = sessions.rbegin(); it != sessions.rend() && std::distance(sessions.rbegin(), it) < static_cast<ptrdiff_t>(max_sessions); ++it)
+		{
+			const auto& session = *it;
+
+			const auto time_range = format_time(session.start_time) + " - " + format_time(session.end_time);
+			const auto label = std::format("{}, {} ({})##{}", session.category, time_range, session.log_count, session.id);
+
+			if (!ImGui::BeginMenu(label.c_str()))
+				continue;
+
+			std::string sub_categories;
+			for (const auto& sub_category : session.sub_categories)
+				sub_categories += (sub_categories.empty() ? "" : ", ") + std::string(sub_category);
+
+			const auto summary = std::format("{} kills, {} wipes, clear time {}", session.kills, session.wipes, format_duration(session.get_clear_time()));
+
+			if (!session.account_name.empty())
+				ImGui::TextDisabled("%s", session.account_name.c_str());
 
-				if (!this->settings.display.hide_wingman)
+			ImGui::TextDisabled("%s", summary.c_str());
+			ImGui::TextDisabled("%s", sub_categories.c_str());
+			ImGui::Spacing();
+
+			// only built while the session menu is open, the logs must not outlive the rows that hold them
+			std::deque<EncounterLogRow> session_logs;
+			for (const auto& row : this->encounter_logs->rows)
+			{
+				if (std::get<1>(row)->session_id == session.id)
+					session_logs.push_back(row);
+			}
+
+			if (session_logs.empty())
+			{
+				ImGui::TextDisabled("Logs moved to the catalog");
+			}
+			else
+			{
+				this->draw_log_actions(session_logs);
+
+				ImGui::Separator();
+
+				if (ImGui::MenuItem("Copy session summary"))
 				{
-					ImGui::TableNextColumn();
-					if (ImGui::ButtonWingman(encounter_log_data.wingman_upload.status, encounter_log_data.parse_status))
+					std::stringstream ss;
+					ss << "**" << session.category << "** " << time_range << " (" << format_duration(session.get_clear_time()) << ")\n";
+					ss << summary << (sub_categories.empty() ? "" : " | " + sub_categories) << "\n";
+
+					// oldest first, rows are ordered newest first
+					for (auto row = session_logs.rbegin(); row != session_logs.rend(); ++row)
 					{
-						if (encounter_log_data.wingman_upload.status == WingmanUploadStatus::AVAILABLE && encounter_log_data.parse_status == ParseStatus::PARSED)
-							global::wingman_uploader->queue_upload(encounter_log);
+						const auto& encounter_log_data = std::get<1>(*row);
+
+						if (!encounter_log_data->dps_report_upload.url.empty())
+							ss << "- [" << encounter_log_data->view.name << " (" << encounter_log_data->view.duration << ")](" << encounter_log_data->dps_report_upload.url << ")\n";
+						else
+							ss << "- " << encounter_log_data->view.name << " (" << encounter_log_data->view.duration << ")\n";
 					}
-					if (encounter_log_data.wingman_upload.error_message.has_value())
-						ImGui::DelayedTooltipText(encounter_log_data.wingman_upload.error_message.value().c_str());
+
+					ImGui::SetClipboardText(ss.str().c_str());
 				}
 			}
 
-			select_all_toggle = all_selected;
+			ImGui::EndMenu();
 		}
-		ImGui::EndTable();
 
-		this->draw_context_menu();
+		ImGui::EndMenu();
 	}
-
-	if (hide_background)
-		ImGui::PopStyleColor(2);
-
-	ImGui::PopStyleVar();
-	ImGui::End();
 }
 
 void UI::draw_context_menu()
@@ -384,19 +861,21 @@ void UI::draw_context_menu()
 			};
 		};
 
+		// locals so the rows do not keep closed logs alive between frames
+		std::deque<EncounterLogRow> last_log_deq;
+		std::deque<EncounterLogRow> selected_logs;
+
 		for (int ctx = 0; ctx < LogSelection::_COUNT; ctx++)
 		{
-			std::deque<std::tuple<std::shared_ptr<EncounterLog>, EncounterLogData>>* logs = nullptr;
+			const std::deque<EncounterLogRow>* logs = nullptr;
 			std::string menu_label;
 
 			switch (ctx)
 			{
 			case LogSelection::LAST:
-				if (!this->encounter_logs.empty())
+				if (!this->encounter_logs->rows.empty())
 				{
-					static std::deque<std::tuple<std::shared_ptr<EncounterLog>, EncounterLogData>> last_log_deq;
-					last_log_deq.clear();
-					last_log_deq.push_back(this->encounter_logs.front());
+					last_log_deq.push_back(this->encounter_logs->rows.front());
 					logs = &last_log_deq;
 				}
 				menu_label = "Last log";
@@ -404,13 +883,11 @@ void UI::draw_context_menu()
 
 			case LogSelection::SELECTED:
 			{
-				static std::deque<std::tuple<std::shared_ptr<EncounterLog>, EncounterLogData>> selected_logs;
-				selected_logs.clear();
-				for (auto& [encounter_log, encounter_log_data] : this->encounter_logs)
+				for (auto& [encounter_log, encounter_log_data] : this->encounter_logs->rows)
 				{
-					if (encounter_log_data.view.selected)
+					if (encounter_log_data->view.selected)
 					{
-						selected_logs.push_back(std::make_tuple(encounter_log, encounter_log_data));
+						selected_logs.emplace_back(encounter_log, encounter_log_data);
 					}
 				}
 				logs = &selected_logs;
@@ -419,8 +896,8 @@ void UI::draw_context_menu()
 			}
 
 			case LogSelection::ALL:
-				logs = &this->encounter_logs;
-				menu_label = "All logs";
+				logs = &this->get_visible_logs();
+				menu_label = this->filter.empty() ? "All logs" : "Filtered logs";
 				break;
 
 			default:
@@ -436,152 +913,7 @@ void UI::draw_context_menu()
 			{
 				if (logs && !logs->empty())
 				{
-					struct LogAction
-					{
-						enum Type
-						{
-							PARSE,
-							OPEN_REPORTS,
-							UPLOAD_TO_DPS_REPORT,
-							COPY_DPS_REPORT_URLS,
-							UPLOAD_TO_WINGMAN,
-							_COUNT
-						};
-					};
-
-					std::array<std::deque<std::tuple<std::shared_ptr<EncounterLog>, EncounterLogData>>, LogAction::_COUNT> action_logs;
-
-					for (auto& [encounter_log, encounter_log_data] : *logs)
-					{
-						if (encounter_log_data.parse_status == ParseStatus::PARSED)
-						{
-							// Open Reports
-							action_logs[LogAction::OPEN_REPORTS].emplace_back(encounter_log, encounter_log_data);
-
-							// Upload to Wingman
-							if (encounter_log_data.wingman_upload.status == WingmanUploadStatus::AVAILABLE ||
-								encounter_log_data.wingman_upload.status == WingmanUploadStatus::FAILED)
-							{
-								action_logs[LogAction::UPLOAD_TO_WINGMAN].emplace_back(encounter_log, encounter_log_data);
-							}
-						}
-						else if (encounter_log_data.parse_status == ParseStatus::UNPARSED)
-						{
-							// Parse
-							action_logs[LogAction::PARSE].emplace_back(encounter_log, encounter_log_data);
-						}
-
-						// Upload to dps.report
-						if (encounter_log_data.dps_report_upload.status == DpsReportUploadStatus::AVAILABLE ||
-							encounter_log_data.dps_report_upload.status == DpsReportUploadStatus::FAILED)
-						{
-							action_logs[LogAction::UPLOAD_TO_DPS_REPORT].emplace_back(encounter_log, encounter_log_data);
-						}
-
-						// Copy dps.report URLs
-						if (encounter_log_data.dps_report_upload.status == DpsReportUploadStatus::UPLOADED &&
-							!encounter_log_data.dps_report_upload.url.empty())
-						{
-							action_logs[LogAction::COPY_DPS_REPORT_URLS].emplace_back(encounter_log, encounter_log_data);
-						}
-					}
-
-					bool options_available = false;
-
-					// Parse
-					if (!action_logs[LogAction::PARSE].empty())
-					{
-						options_available = true;
-						if (ImGui::MenuItem(("Parse (" + std::to_string(action_logs[LogAction::PARSE].size()) + ")").c_str()))
-						{
-							for (auto& [encounter_log, _] : action_logs[LogAction::PARSE])
-							{
-								global::elite_insights->queue_encounter_log(encounter_log);
-							}
-						}
-					}
-
-					// Open Reports
-					if (!action_logs[LogAction::OPEN_REPORTS].empty())
-					{
-						options_available = true;
-						if (ImGui::MenuItem(("Open reports (" + std::to_string(action_logs[LogAction::OPEN_REPORTS].size()) + ")").c_str()))
-						{
-							for (auto& [_, encounter_log_data] : action_logs[LogAction::OPEN_REPORTS])
-							{
-								ShellExecuteW(nullptr, L"open", encounter_log_data.report_data.html_file_path.c_str(), nullptr, nullptr, SW_SHOWNORMAL);
-							}
-						}
-					}
-
-					// Upload to dps.report
-					if (!action_logs[LogAction::UPLOAD_TO_DPS_REPORT].empty())
-					{
-						options_available = true;
-						if (ImGui::MenuItem(("Upload to dps.report (" + std::to_string(action_logs[LogAction::UPLOAD_TO_DPS_REPORT].size()) + ")").c_str()))
-						{
-							for (auto& [encounter_log, _] : action_logs[LogAction::UPLOAD_TO_DPS_REPORT])
-							{
-								global::dps_report_uploader->queue_upload(encounter_log);
-							}
-						}
-					}
-
-					// Copy dps.report URLs
-					if (!action_logs[LogAction::COPY_DPS_REPORT_URLS].empty())
-					{
-						options_available = true;
-						if (ImGui::BeginMenu(("Copy dps.report URLs (" + std::to_string(action_logs[LogAction::COPY_DPS_REPORT_URLS].size()) + ")").c_str()))
-						{
-							if (ImGui::MenuItem("As raw list"))
-							{
-								std::string urls;
-								for (auto& [_, encounter_log_data] : action_logs[LogAction::COPY_DPS_REPORT_URLS])
-								{
-									urls += encounter_log_data.dps_report_upload.url + "\n";
-								}
-								if (!urls.empty())
-								{
-									ImGui::SetClipboardText(urls.c_str());
-								}
-							}
-
-							if (ImGui::MenuItem("As markdown links"))
-							{
-								std::stringstream ss;
-								for (auto& [_, encounter_log_data] : action_logs[LogAction::COPY_DPS_REPORT_URLS])
-								{
-									if (encounter_log_data.parse_status == ParseStatus::PARSED)
-										ss << "[" << encounter_log_data.view.name << " (" << encounter_log_data.view.duration
-										<< (!encounter_log_data.encounter_data.success ? " | " + (encounter_log_data.encounter_data.valid_boss ? std::format("{:.2f}%", 100.f - encounter_log_data.encounter_data.health_percent_burned) + " left" : "failure") : "")
-										<< ")](" << encounter_log_data.dps_report_upload.url << ")"
-										<< "\n";
-									else
-										ss << "[" << encounter_log_data.view.name << "](" << encounter_log_data.dps_report_upload.url << ")\n";
-								}
-								ImGui::SetClipboardText(ss.str().c_str());
-							}
-							ImGui::EndMenu();
-						}
-					}
-
-					// Upload to Wingman
-					if (!action_logs[LogAction::UPLOAD_TO_WINGMAN].empty())
-					{
-						options_available = true;
-						if (ImGui::MenuItem(("Upload to Wingman (" + std::to_string(action_logs[LogAction::UPLOAD_TO_WINGMAN].size()) + ")").c_str()))
-						{
-							for (auto& [encounter_log, _] : action_logs[LogAction::UPLOAD_TO_WINGMAN])
-							{
-								global::wingman_uploader->queue_upload(encounter_log);
-							}
-						}
-					}
-
-					if (!options_available)
-					{
-						ImGui::TextDisabled("No options available");
-					}
+					this->draw_log_actions(*logs);
 				}
 				else
 				{
@@ -595,6 +927,9 @@ void UI::draw_context_menu()
 				ImGui::EndMenu();
 			}
 		}
+
+		this->draw_session_menu();
+
 		ImGui::Separator();
 
 		ImGui::TextDisabled("Log uploader options");
@@ -624,6 +959,43 @@ void UI::draw_context_menu()
 			ImGui::EndMenu();
 		}
 
+		if (ImGui::BeginMenu("Bandwidth"))
+		{
+			this->draw_bandwidth_settings();
+			ImGui::EndMenu();
+		}
+
+		if (ImGui::BeginMenu("Log directories"))
+		{
+			this->draw_directory_settings();
+			ImGui::EndMenu();
+		}
+
+		ImGui::Separator();
+
+		if (ImGui::MenuItem("Dump upload statistics"))
+			global::http_metrics->dump();
+		ImGui::DelayedTooltipText("Writes the connect, time to first byte and total latency histograms of every upload endpoint to the log.");
+
+		if (ImGui::MenuItem("Dump detection statistics"))
+			global::directory_monitor->dump_metrics();
+		ImGui::DelayedTooltipText("Writes how many new logs were detected and registered, how many were found in more than one directory, the deepest backlog of detected logs and how long they waited and took to process to the log.");
+
+		if (ImGui::MenuItem("Record pipeline trace", nullptr, &this->settings.diagnostics.trace_pipeline))
+		{
+			SAVE_SETTING(diagnostics.trace_pipeline);
+			global::logger->set_trace_enabled(this->settings.diagnostics.trace_pipeline);
+		}
+		ImGui::DelayedTooltipText("Records when logs are detected, parsed and uploaded to trace.bin next to log.txt. Decode it with the trace_decoder tool.");
+
+		if (ImGui::MenuItem("Dump logger statistics"))
+			global::logger->dump_metrics();
+		ImGui::DelayedTooltipText("Writes how many messages were logged, how often the log file was flushed and rotated and how many messages were dropped or coalesced to the log.");
+
+		if (ImGui::MenuItem("Dump memory usage"))
+			global::log_manager->dump_memory_usage();
+		ImGui::DelayedTooltipText("Writes the memory held by the encounter log records to the log.");
+
 		ImGui::EndPopup();
 	}
 
@@ -662,6 +1034,11 @@ void UI::draw_display_settings()
 	UI_ELEMENT(ImGui::Checkbox, "Hide report", display.hide_elite_insights);
 	UI_ELEMENT(ImGui::Checkbox, "Hide dps.report", display.hide_dps_report);
 	UI_ELEMENT(ImGui::Checkbox, "Hide Wingman", display.hide_wingman);
+	if (ImGui::SliderInt("Logs kept in memory", &this->settings.display.working_set_size, 50, 10000, "%d", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic))
+	{
+		SAVE_SETTING(display.working_set_size);
+	}
+	ImGui::DelayedTooltipText("Older logs without pending work are moved to an on-disk catalog for the rest of the session and loaded back when scrolling to the end of the table.");
 }
 
 void UI::draw_dps_report_settings()
@@ -758,4 +1135,94 @@ void UI::draw_parser_settings()
 		SAVE_SETTING(elite_insights.update_channel);
 	}
 	ImGui::DelayedTooltipText("Specifies the target Elite Insights version. Sometimes Wingman does not support the latest version right away.");
-}
\ No newline at end of file
+
+	if (ImGui::SliderInt("Report disk budget", &this->settings.elite_insights.report_disk_budget, 128, 65536, "%d MiB", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic))
+	{
+		SAVE_SETTING(elite_insights.report_disk_budget);
+		global::report_store->set_budget_changed();
+	}
+	ImGui::DelayedTooltipText(("Disk space used for Elite Insights reports. The least recently opened reports are removed beyond it and parsed again when needed.\n\nCurrently used: " + std::to_string(global::report_store->get_disk_usage() / (1024 * 1024)) + " MiB, shared between reports: " + std::to_string(global::report_store->get_deduplicated_size() / (1024 * 1024)) + " MiB").c_str());
+
+	if (ImGui::SliderInt("Compress reports after", &this->settings.elite_insights.compress_reports_after, 0, 1440, this->settings.elite_insights.compress_reports_after ? "%d min" : "never", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic))
+	{
+		SAVE_SETTING(elite_insights.compress_reports_after);
+		global::report_store->set_budget_changed();
+	}
+	ImGui::DelayedTooltipText("Reports that have not been opened or uploaded for this long are gzipped. They are restored automatically when needed.");
+}
+
+void UI::draw_bandwidth_settings()
+{
+	ImGui::ID id("Bandwidth Settings");
+
+	ImGui::TextDisabled("Bandwidth settings");
+	ImGui::Spacing();
+	UI_ELEMENT(ImGui::Checkbox, "Limit upload bandwidth", bandwidth.limit_uploads);
+	ImGui::DelayedTooltipText("Throttles all dps.report and Wingman uploads to reduce in-game latency spikes.");
+
+	if (ImGui::SliderInt("In combat limit", &this->settings.bandwidth.in_combat_limit, 0, 102400, this->settings.bandwidth.in_combat_limit ? "%d KiB/s" : "unlimited", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic))
+	{
+		SAVE_SETTING(bandwidth.in_combat_limit);
+	}
+	ImGui::DelayedTooltipText("Upload limit while the character is in combat. 0 disables the limit.");
+
+	if (ImGui::SliderInt("Out of combat limit", &this->settings.bandwidth.out_of_combat_limit, 0, 102400, this->settings.bandwidth.out_of_combat_limit ? "%d KiB/s" : "unlimited", ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic))
+	{
+		SAVE_SETTING(bandwidth.out_of_combat_limit);
+	}
+	ImGui::DelayedTooltipText("Upload limit while the character is out of combat. 0 disables the limit.");
+	UI_ELEMENT(ImGui::Checkbox, "Compress .evtc uploads", bandwidth.compress_evtc);
+	ImGui::DelayedTooltipText("Packs uncompressed .evtc logs into .zevtc before uploading when the compression time is estimated to pay off.");
+
+	ImGui::Spacing();
+
+	const auto rate_limit = global::bandwidth_limiter->get_rate_limit();
+
+	ImGui::TextDisabled("Upload throughput: %.1f KiB/s (%s, %s)", global::bandwidth_limiter->get_throughput() / 1024., global::bandwidth_limiter->is_in_combat() ? "in combat" : "out of combat", rate_limit ? std::format("limit {} KiB/s", rate_limit / 1024).c_str() : "unlimited");
+}
+
+void UI::draw_directory_settings()
+{
+	ImGui::ID id("Directory Settings");
+
+	ImGui::TextDisabled("Log directories");
+	ImGui::Spacing();
+
+	const auto primary_directory = global::directory_monitor->get_root_directory(0).u8string();
+	ImGui::TextDisabled("%s", primary_directory.empty() ? "arcdps log directory" : reinterpret_cast<const char*>(primary_directory.c_str()));
+	ImGui::DelayedTooltipText("The arcdps log directory is always monitored.");
+
+	auto& directories = this->settings.monitor.additional_directories;
+
+	for (size_t i = 0; i < directories.size(); i++)
+	{
+		ImGui::ID directory_id(std::to_string(i));
+
+		ImGui::TextUnformatted(directories[i].c_str());
+		ImGui::SameLine();
+
+		if (ImGui::SmallButton("Remove"))
+		{
+			directories.erase(directories.begin() + i);
+			SAVE_SETTING(monitor.additional_directories);
+			break;
+		}
+	}
+
+	ImGui::InputTextWithHint("##new_directory", "Directory", this->new_directory, sizeof(this->new_directory));
+	ImGui::SameLine();
+
+	// not checked on disk here, an unreachable share would stall the game, the monitor reports missing directories when it starts
+	if (ImGui::Button("Add"))
+	{
+		const std::string directory = this->new_directory;
+
+		if (!directory.empty() && std::find(directories.begin(), directories.end(), directory) == directories.end())
+		{
+			directories.push_back(directory);
+			SAVE_SETTING(monitor.additional_directories);
+			this->new_directory[0] = '\0';
+		}
+	}
+	ImGui::DelayedTooltipText("Logs of a second client or an archive share are picked up like arcdps logs. Directories inside another monitored directory are skipped, missing ones are reported in the log. Changes apply after a restart.");
+}
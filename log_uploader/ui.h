@@ -3,12 +3,15 @@
 #include "module.h"
 #include "settings.h"
 #include "encounter_log.h"
+#include "log_index.h"
+#include "log_manager.h"
 
 #include <memory>
 #include <string>
 #include <tuple>
 #include <atomic>
 #include <deque>
+#include <vector>
 
 class UI : public Module
 {
@@ -17,6 +20,7 @@ public:
 	~UI() {}
 
 	void initialize();
+	void release() override;
 	void draw();
 	void draw_arc_window_options();
 	void draw_arc_mod_options();
@@ -27,20 +31,43 @@ private:
 	std::atomic<bool> open = false;
 	std::atomic<bool> force_open = false; // in combat override
 
-	std::deque<std::tuple<std::shared_ptr<EncounterLog>, EncounterLogData>> encounter_logs;
+	std::shared_ptr<const EncounterLogSnapshot> encounter_logs;
+
+	char filter_text[256] = {};
+	LogFilter filter;
+	bool filter_dirty = false;
+	uint64_t filtered_version = 0;
+	std::deque<EncounterLogRow> filtered_logs;
+
+	char new_directory[260] = {};
+	std::vector<uint32_t> cold_matches;
 
 	UploaderSettings settings;
 
 	void refresh_settings_cache();
 	void refresh_encounter_logs();
+	void refresh_filtered_logs();
+
+	auto get_visible_logs() const -> const std::deque<EncounterLogRow>&
+	{
+		return this->filter.empty() ? this->encounter_logs->rows : this->filtered_logs;
+	}
 	
 	void draw_main_window();
+	void draw_log_table();
+	void draw_statistics();
 	void draw_context_menu();
+	void draw_log_actions(const std::deque<EncounterLogRow>& logs);
+	void draw_session_menu();
+	void draw_filter_bar();
+
 
 	void draw_display_settings();
 	void draw_dps_report_settings();
 	void draw_wingman_settings();
 	void draw_parser_settings();
+	void draw_bandwidth_settings();
+	void draw_directory_settings();
 
 	enum LogTableColumns : int
 	{
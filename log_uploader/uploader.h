@@ -1,12 +1,23 @@
 #pragma once
 
+#include "bandwidth_limiter.h"
+#include "change_bus.h"
+#include "http_metrics.h"
 #include "module.h"
 #include "encounter_log.h"
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <queue>
 #include <memory>
+#include <string>
 #include <thread>
 #include <mutex>
+#include <utility>
+#include <vector>
+
+#include <cpr/cpr.h>
 
 class Uploader : public Module
 {
@@ -17,6 +28,9 @@ public:
 
 	virtual void queue_upload(std::shared_ptr<EncounterLog> encounter_log) = 0;
 
+	// queues the logs as a single job, the queue is locked and the upload thread woken once
+	virtual void queue_uploads(const std::vector<std::shared_ptr<EncounterLog>>& encounter_logs) = 0;
+
 	auto clear_upload_queue()
 	{
 		std::lock_guard lock(this->upload_queue_mutex);
@@ -55,4 +69,103 @@ protected:
 	std::thread upload_thread;
 
 	virtual void run() = 0;
+
+	// performs the request on its own session so the transfer timings can be recorded for the endpoint
+	template <typename... Options>
+	static auto post(const std::string& endpoint, Options&&... options) -> cpr::Response
+	{
+		cpr::Session session;
+		(session.SetOption(std::forward<Options>(options)), ...);
+
+		auto response = session.Post();
+		global::http_metrics->record(endpoint, session, response);
+
+		return response;
+	}
+
+	template <typename... Options>
+	static auto get(const std::string& endpoint, Options&&... options) -> cpr::Response
+	{
+		cpr::Session session;
+		(session.SetOption(std::forward<Options>(options)), ...);
+
+		auto response = session.Get();
+		global::http_metrics->record(endpoint, session, response);
+
+		return response;
+	}
+
+	// a throttled upload can take far longer than the request timeout, the timeout only limits the time without any transfer, e.g. the server processing the log
+	static auto create_upload_timeouts(int request_timeout) -> std::pair<cpr::ConnectTimeout, cpr::LowSpeed>
+	{
+		constexpr auto connect_timeout = std::chrono::seconds(30);
+
+		const auto stall_timeout = (std::max)(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::milliseconds(request_timeout)), std::chrono::seconds(1));
+
+		return { cpr::ConnectTimeout{ connect_timeout }, cpr::LowSpeed{ 1, stall_timeout } };
+	}
+
+	// throttles the request body through the global bandwidth limiter and publishes the transfer progress to the log view, aborts the transfer on shutdown
+	auto create_progress_callback(std::shared_ptr<EncounterLog> encounter_log, TransferProgress EncounterLogView::* view_progress) -> cpr::ProgressCallback
+	{
+		using clock = std::chrono::steady_clock;
+
+		{
+			std::lock_guard lock(encounter_log->mutex);
+			encounter_log->view.*view_progress = TransferProgress();
+		}
+
+		global::change_bus->post(encounter_log, LogChange::TRANSFER_PROGRESS);
+
+		return cpr::ProgressCallback([this, encounter_log, view_progress, uploaded = uint64_t(0), progress = TransferProgress(), last_update = clock::time_point(), window_start = clock::now(), window_bytes = uint64_t(0)](auto, auto, auto upload_total, auto upload_now, intptr_t) mutable -> bool
+			{
+				const auto sent = static_cast<uint64_t>(upload_now);
+
+				if (sent > uploaded)
+				{
+					global::bandwidth_limiter->consume(sent - uploaded);
+					uploaded = sent;
+
+					for (auto delay = global::bandwidth_limiter->get_delay(); delay.count() > 0; delay = global::bandwidth_limiter->get_delay())
+					{
+						if (!this->is_initialized())
+							return false;
+
+						std::this_thread::sleep_for((std::min)(delay, std::chrono::milliseconds(100)));
+					}
+				}
+
+				const auto now = clock::now();
+
+				// the ui only needs a few updates per second, avoid contending the log lock on every curl callback
+				if (now - last_update >= std::chrono::milliseconds(100) || (upload_total > 0 && sent >= static_cast<uint64_t>(upload_total) && progress.bytes_sent < sent))
+				{
+					const auto window = std::chrono::duration<double>(now - window_start).count();
+
+					if (window >= .5)
+					{
+						const auto window_rate = static_cast<double>(sent - window_bytes) / window;
+
+						progress.rate = progress.rate > 0. ? progress.rate * .7 + window_rate * .3 : window_rate;
+						window_start = now;
+						window_bytes = sent;
+					}
+
+					progress.bytes_sent = sent;
+					progress.bytes_total = static_cast<uint64_t>((std::max)(upload_total, decltype(upload_total)(0)));
+					progress.eta = progress.rate > 0. && progress.bytes_total > sent ? std::chrono::seconds(static_cast<int64_t>(static_cast<double>(progress.bytes_total - sent) / progress.rate)) : std::chrono::seconds(0);
+
+					last_update = now;
+
+					{
+						std::lock_guard lock(encounter_log->mutex);
+						encounter_log->view.*view_progress = progress;
+					}
+
+					global::change_bus->post(encounter_log, LogChange::TRANSFER_PROGRESS);
+				}
+
+				return this->is_initialized();
+			});
+	}
 };
\ No newline at end of file
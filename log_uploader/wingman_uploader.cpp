@@ -1,6 +1,12 @@
+#include "change_bus.h"
+#include "evtc_compressor.h"
 #include "logger.h"
+#include "multipart_stream.h"
+#include "elite_insights.h"
+#include "report_store.h"
 #include "wingman_uploader.h"
 
+#include <limits>
 #include <string>
 
 #include <cpr/cpr.h>
@@ -8,9 +14,10 @@
 
 namespace global { std::unique_ptr<WingmanUploader> wingman_uploader = std::make_unique<WingmanUploader>(); }
 
-#define LOG(message, log_level) global::logger->write(message, log_level, LogSource::WingmanUploader)
+#define LOG(message, log_level) do { if (Logger::is_enabled(log_level)) global::logger->write(message, log_level, LogSource::WingmanUploader); } while (0)
+#define LOG_FORMAT(log_level, ...) global::logger->write_format(log_level, LogSource::WingmanUploader, __VA_ARGS__)
 
-void WingmanUploader::queue_upload(std::shared_ptr<EncounterLog> encounter_log)
+void WingmanUploader::queue_uploads(const std::vector<std::shared_ptr<EncounterLog>>& encounter_logs)
 {
 	if (!this->is_initialized())
 	{
@@ -18,24 +25,41 @@ void WingmanUploader::queue_upload(std::shared_ptr<EncounterLog> encounter_log)
 		return;
 	}
 
-	std::unique_lock log_lock(encounter_log->mutex);
+	std::vector<std::shared_ptr<EncounterLog>> queued_logs;
 
-	if (encounter_log->wingman_upload.status != WingmanUploadStatus::AVAILABLE && encounter_log->wingman_upload.status != WingmanUploadStatus::FAILED)
+	for (const auto& encounter_log : encounter_logs)
 	{
-		LOG("Log is not available for upload", LogLevel::Warning);
-		return;
-	}
+		std::unique_lock log_lock(encounter_log->mutex);
+
+		if (encounter_log->wingman_upload.status != WingmanUploadStatus::AVAILABLE && encounter_log->wingman_upload.status != WingmanUploadStatus::FAILED)
+		{
+			LOG("Log is not available for upload", LogLevel::Warning);
+			continue;
+		}
 
-	encounter_log->wingman_upload.status = WingmanUploadStatus::QUEUED;
+		encounter_log->wingman_upload.status = WingmanUploadStatus::QUEUED;
 
-	LOG("Queued encounter log for upload: " + encounter_log->id, LogLevel::Info);
+		LOG_FORMAT(LogLevel::Info, "Queued encounter log for upload: {}", encounter_log->id);
 
-	log_lock.unlock();
+		log_lock.unlock();
+
+		global::change_bus->post(encounter_log, LogChange::WINGMAN_UPLOAD);
+
+		global::logger->trace(TraceEvent::UPLOAD_QUEUED, LogSource::WingmanUploader, hash_trace_id(encounter_log->id));
+
+		queued_logs.push_back(encounter_log);
+	}
+
+	if (queued_logs.empty())
+		return;
 
 	{
-		std::unique_lock upload_queue_lock(this->upload_queue_mutex);
-		this->upload_queue.push(encounter_log);
-		this->upload_cv.notify_one();
+		std::unique_lock check_queue_lock(this->check_queue_mutex);
+
+		for (auto& encounter_log : queued_logs)
+			this->check_queue.push(std::move(encounter_log));
+
+		this->check_cv.notify_one();
 	}
 }
 
@@ -76,29 +100,6 @@ void WingmanUploader::run()
 		if (!this->is_initialized())
 			break;
 
-		if (!this->check_server_availability())
-		{
-			LOG("Wingman servers unavailable. Uploading paused for 60 seconds ...", LogLevel::Warning);
-
-			auto delay = std::chrono::seconds(60);
-			auto step = std::chrono::seconds(1);
-
-			while (delay > std::chrono::seconds(0))
-			{
-				if (!this->is_initialized())
-					break;
-
-				std::this_thread::sleep_for(step);
-				delay -= step;
-
-				LOG("Delaying uploads for " + std::to_string(std::chrono::duration_cast<std::chrono::seconds>(delay).count()) + " seconds ...", LogLevel::Debug);
-			}
-
-			this->upload_cv.notify_one();
-
-			continue;
-		}
-
 		std::unique_lock upload_queue_lock(this->upload_queue_mutex);
 
 		if (this->upload_queue.empty())
@@ -113,144 +114,432 @@ void WingmanUploader::run()
 
 		if (log->wingman_upload.status != WingmanUploadStatus::QUEUED || log->parse_status != ParseStatus::PARSED)
 		{
-			LOG("Log has invalid status: " + log->id, LogLevel::Debug);
+			LOG_FORMAT(LogLevel::Debug, "Log has invalid status: {}", log->id);
 			continue;
 		}
 
 		log->wingman_upload.status = WingmanUploadStatus::UPLOADING;
 
-		LOG("Uploading encounter log: " + log->id, LogLevel::Info);
+		LOG_FORMAT(LogLevel::Info, "Uploading encounter log: {}", log->id);
 
 		auto log_data = log->get_data_locked();
 
 		log_lock.unlock();
 
+		global::change_bus->post(log, LogChange::WINGMAN_UPLOAD);
+
 		auto& upload = log_data.wingman_upload;
+		upload.error_message.reset();
 
 		const auto& evtc_file = log_data.evtc_data.evtc_file_path;
-		const auto& html_file = log_data.report_data.html_file_path;
-		const auto& json_file = log_data.report_data.json_file_path;
+		const auto html_file = log_data.report_data.get_html_file_path();
+		const auto json_file = log_data.report_data.get_json_file_path();
 
-		if (!std::filesystem::exists(evtc_file) || !std::filesystem::exists(html_file) || !std::filesystem::exists(json_file))
+		// keeps the reports from being compressed or removed while they are streamed
+		const auto report_lease = global::report_store->acquire_for_upload(log_data.report_data);
+
+		if (!report_lease)
 		{
-			upload.error_message = "Evtc, html or json file does not exist";
-			upload.status = WingmanUploadStatus::FAILED;
+			upload.error_message = "Elite Insights reports were removed to stay within the disk budget";
+			this->set_upload_result(log, upload);
+			global::elite_insights->queue_reparse(log);
+			continue;
 		}
-		else
+
+		// only logs that passed /checkUpload are compressed, duplicates never pay for it
+		const auto upload_file = global::evtc_compressor->prepare_upload(log);
+
+		MultipartStream multipart_upload_processed;
+
+		/*
+		/uploadProcessed
+		Uploads an EliteInsights-processed log (composed of .zevtc, .json, .html), checks for duplicates and adds it to the gw2wingman database if appropriate. Returns the processed json if successful, "False" otherwise.
+		POST 'file': The original .zevtc log file.
+		POST 'jsonfile': The EliteInsights .json output file.
+		POST 'htmlfile': The EliteInsights .html output file.
+		POST 'account': The account name of the uploader account. Optional, but recommended for desk-rejecting duplicate logs.
+		*/
+
+		cpr::Response response_upload_processed;
+		std::optional<std::string> stream_error;
+
+		std::error_code error;
+		const auto log_id_hash = hash_trace_id(log_data.id);
+		const auto upload_start_time = std::chrono::steady_clock::now();
+
+		global::logger->trace(TraceEvent::UPLOAD_STARTED, LogSource::WingmanUploader, log_id_hash, static_cast<int64_t>(std::filesystem::file_size(upload_file.file_path, error)));
+
+		try
 		{
-			auto filesize = std::filesystem::file_size(evtc_file);
-			auto ftime = std::filesystem::last_write_time(evtc_file);
-			auto cftime = std::chrono::system_clock::to_time_t(std::chrono::clock_cast<std::chrono::system_clock>(ftime));
-
-			/*
-			/checkUpload
-			Checks if there is a conflict in the database regarding a specified log. Returns "Error" if no upload is possible right now, "False" if 'file' or 'filesize' is not specified or the log already exists in the database, "True" if upload is possible.
-			It is highly recommended to run this before /uploadProcessed to quickly reject duplicates without the need of uploading or processing.
-			POST 'file': The name of the .zevtc file to be checked.
-			POST 'timestamp': The timestamp of the creation of this .zevtc file (Unix epoch timestamps in seconds).
-			POST 'filesize': The size in bytes of this .zevtc file.
-			POST 'account': The account name of the uploader account. Recommended for quicker detection of duplicates.
-			*/
-			cpr::Multipart multipart_check_upload =
-			{
-				{ "file", evtc_file.filename().string() },
-				{ "timestamp", std::to_string(cftime) },
-				{ "filesize", std::to_string(filesize) },
-				{ "account", log_data.encounter_data.account_name }
-			};
+			multipart_upload_processed.add_file("file", upload_file.file_path, upload_file.file_name);
+
+			// compressed reports are reassembled while they are sent
+			if (const auto json_source = report_lease.get_json_source(); json_source)
+				multipart_upload_processed.add_file("jsonfile", json_source, json_file.filename().string());
+			else
+				multipart_upload_processed.add_file("jsonfile", json_file, json_file.filename().string());
 
-			auto response_check_upload = cpr::Post(cpr::Url("https://gw2wingman.nevermindcreations.de/checkUpload"), multipart_check_upload, cpr::Timeout{ GET_SETTING(wingman.request_timeout) });
+			if (const auto html_source = report_lease.get_html_source(); html_source)
+				multipart_upload_processed.add_file("htmlfile", html_source, html_file.filename().string());
+			else
+				multipart_upload_processed.add_file("htmlfile", html_file, html_file.filename().string());
 
-			if (response_check_upload.status_code == 200)
+			multipart_upload_processed.add_field("account", log_data.encounter_data.account_name.str());
+
+			const auto [connect_timeout, stall_timeout] = create_upload_timeouts(GET_SETTING(wingman.request_timeout));
+
+			response_upload_processed = this->post("wingman/uploadProcessed", cpr::Url("https://gw2wingman.nevermindcreations.de/uploadProcessed"), multipart_upload_processed.create_header(), multipart_upload_processed.create_read_callback(), connect_timeout, stall_timeout, this->create_progress_callback(log, &EncounterLogView::wingman_progress));
+		}
+		catch (const std::exception& e)
+		{
+			stream_error = e.what();
+		}
+
+		if (stream_error.has_value())
+			upload.error_message = "Failed to read log files: " + stream_error.value();
+		else if (response_upload_processed.status_code == 200)
+		{
+			if (response_upload_processed.text == "True")
 			{
-				if (response_check_upload.text == "True")
-				{
-					cpr::Multipart multipart_upload_processed{
-						{ "file", cpr::File(evtc_file.string(), evtc_file.filename().string())},
-						{ "jsonfile", cpr::File(json_file.string(), json_file.filename().string()) },
-						{ "htmlfile", cpr::File(html_file.string(), html_file.filename().string()) },
-						{ "account", log_data.encounter_data.account_name }
-					};
-
-					/*
-					/uploadProcessed
-					Uploads an EliteInsights-processed log (composed of .zevtc, .json, .html), checks for duplicates and adds it to the gw2wingman database if appropriate. Returns the processed json if successful, "False" otherwise.
-					POST 'file': The original .zevtc log file.
-					POST 'jsonfile': The EliteInsights .json output file.
-					POST 'htmlfile': The EliteInsights .html output file.
-					POST 'account': The account name of the uploader account. Optional, but recommended for desk-rejecting duplicate logs.
-					*/
-
-					auto response_upload_processed = cpr::Post(cpr::Url("https://gw2wingman.nevermindcreations.de/uploadProcessed"), multipart_upload_processed, cpr::Timeout{ GET_SETTING(wingman.request_timeout) });
-
-					if (response_upload_processed.status_code == 200)
-					{
-						if (response_upload_processed.text == "True")
-							upload.status = WingmanUploadStatus::UPLOADED;
-						else
-						{
-							if (response_upload_processed.text.empty())
-								upload.error_message = "Wingman returned an error on /uploadProcessed: " + response_upload_processed.text;
-							else
-								upload.error_message = "Wingman returned an error on /uploadProcessed";
-						}
-					}
-					else
-					{
-						upload.error_message = "Wingman returned an http error on /uploadProcessed (" + std::to_string(response_upload_processed.status_code) + ")";
-					}
-				}
-				else if (response_check_upload.text == "Error")
-				{
-					upload.error_message = "Wingman returned an error on /checkUpload";
-				}
-				else if (response_check_upload.text == "False")
-				{
-					upload.status = WingmanUploadStatus::SKIPPED;
-					upload.error_message = "Log already exists in the wingman database";
+				upload.status = WingmanUploadStatus::UPLOADED;
 
-					log_lock.lock();
-					log->wingman_upload = upload;
-					continue;
-				}
-				else
+				try
 				{
-					if (response_check_upload.text.empty())
-						upload.error_message = "Wingman returned no data on /checkUpload";
-					else
-						upload.error_message = "Wingman returned an error on /checkUpload: " + response_check_upload.text;
+					const auto key = this->get_check_upload_key(evtc_file);
+
+					std::lock_guard check_cache_lock(this->check_cache_mutex);
+					this->check_cache[key] = false;
 				}
+				catch (const std::filesystem::filesystem_error&) {}
 			}
 			else
 			{
-				upload.error_message = "Wingman returned an http error on /checkUpload (" + std::to_string(response_check_upload.status_code) + ")";
+				if (response_upload_processed.text.empty())
+					upload.error_message = "Wingman returned an error on /uploadProcessed: " + response_upload_processed.text;
+				else
+					upload.error_message = "Wingman returned an error on /uploadProcessed";
 			}
 		}
+		else
+		{
+			upload.error_message = "Wingman returned an http error on /uploadProcessed (" + std::to_string(response_upload_processed.status_code) + ")";
+		}
+
+		global::logger->trace(TraceEvent::UPLOAD_FINISHED, LogSource::WingmanUploader, log_id_hash, response_upload_processed.status_code, upload.status == WingmanUploadStatus::UPLOADED, std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - upload_start_time).count());
+
+		this->set_upload_result(log, upload);
+	}
+
+	LOG("Uploader shutdown", LogLevel::Info);
+}
 
-		log_lock.lock();
+void WingmanUploader::run_check()
+{
+	LOG("Upload check thread started", LogLevel::Info);
+
+	// only joined on shutdown, the results arrive through completed_checks
+	std::deque<cpr::AsyncWrapper<void>> pending_checks;
 
-		if (upload.error_message.has_value())
-			upload.status = WingmanUploadStatus::FAILED;
+	while (this->is_initialized())
+	{
+		std::unique_lock check_queue_lock(this->check_queue_mutex);
 
-		log->wingman_upload = upload;
+		this->check_cv.wait(check_queue_lock, [this] { return !this->is_initialized() || !this->check_queue.empty() || !this->completed_checks.empty(); });
+
+		if (!this->is_initialized())
+			break;
 
-		if (upload.status == WingmanUploadStatus::SKIPPED)
+		std::queue<std::shared_ptr<EncounterLog>> queued_logs;
+		std::swap(queued_logs, this->check_queue);
+
+		std::deque<CompletedCheck> completed_checks;
+		std::swap(completed_checks, this->completed_checks);
+
+		check_queue_lock.unlock();
+
+		for (auto& completed_check : completed_checks)
+			this->process_check(completed_check);
+
+		std::erase_if(pending_checks, [](cpr::AsyncWrapper<void>& pending_check) { return pending_check.wait_for(std::chrono::seconds(0)) == std::future_status::ready; });
+
+		if (!queued_logs.empty() && !this->check_server_availability())
 		{
-			LOG("Encounter log skipped: " + log->id, LogLevel::Info);
+			LOG("Wingman servers unavailable. Uploading paused for 60 seconds ...", LogLevel::Warning);
+
+			check_queue_lock.lock();
+
+			while (!queued_logs.empty()) // keep the original order
+			{
+				this->check_queue.push(queued_logs.front());
+				queued_logs.pop();
+			}
+
+			check_queue_lock.unlock();
+
+			auto delay = std::chrono::seconds(60);
+			auto step = std::chrono::seconds(1);
+
+			while (delay > std::chrono::seconds(0))
+			{
+				if (!this->is_initialized())
+					break;
+
+				std::this_thread::sleep_for(step);
+				delay -= step;
+
+				LOG_FORMAT(LogLevel::Debug, "Delaying uploads for {} seconds ...", std::chrono::duration_cast<std::chrono::seconds>(delay).count());
+			}
+
 			continue;
 		}
-		else if (upload.status == WingmanUploadStatus::FAILED)
+
+		// all checks are in flight before the first response is awaited
+		while (!queued_logs.empty())
 		{
-			LOG("Encounter log upload failed: " + log->id + " - " + upload.error_message.value(), LogLevel::Error);
-			continue;
+			this->send_check(queued_logs.front(), pending_checks);
+			queued_logs.pop();
+		}
+	}
+
+	// the requests abort once they see the uploader released, the results are discarded
+	for (auto& pending_check : pending_checks)
+		pending_check.wait();
+
+	std::lock_guard check_queue_lock(this->check_queue_mutex);
+	this->completed_checks.clear();
+
+	LOG("Upload check thread shutdown", LogLevel::Info);
+}
+
+void WingmanUploader::send_check(std::shared_ptr<EncounterLog> encounter_log, std::deque<cpr::AsyncWrapper<void>>& pending_checks)
+{
+	std::unique_lock log_lock(encounter_log->mutex);
+
+	if (encounter_log->wingman_upload.status != WingmanUploadStatus::QUEUED || encounter_log->parse_status != ParseStatus::PARSED)
+	{
+		LOG_FORMAT(LogLevel::Debug, "Log has invalid status: {}", encounter_log->id);
+		return;
+	}
+
+	auto log_data = encounter_log->get_data_locked();
+
+	log_lock.unlock();
+
+	auto upload = log_data.wingman_upload;
+	upload.error_message.reset();
+
+	const auto& evtc_file = log_data.evtc_data.evtc_file_path;
+
+	// a valid lease means the reports are available, plain or compressed, they are only restored or streamed by the upload itself
+	const auto report_lease = global::report_store->acquire_for_upload(log_data.report_data);
+
+	if (!report_lease)
+	{
+		upload.error_message = "Elite Insights reports were removed to stay within the disk budget";
+		this->set_upload_result(encounter_log, upload);
+		global::elite_insights->queue_reparse(encounter_log);
+		return;
+	}
+
+	if (!std::filesystem::exists(evtc_file))
+	{
+		upload.error_message = "Evtc file does not exist";
+		this->set_upload_result(encounter_log, upload);
+		return;
+	}
+
+	LOG_FORMAT(LogLevel::Debug, "Checking encounter log: {}", encounter_log->id);
+
+	// the check thread keeps dispatching the other checks while this one is in flight
+	pending_checks.push_back(cpr::async([this, encounter_log, account_name = log_data.encounter_data.account_name.str()]
+		{
+			auto result = this->check_upload(encounter_log, account_name);
+
+			{
+				std::lock_guard check_queue_lock(this->check_queue_mutex);
+				this->completed_checks.push_back({ encounter_log, std::move(result) });
+			}
+
+			this->check_cv.notify_one();
+		}));
+}
+
+auto WingmanUploader::check_upload(std::shared_ptr<EncounterLog> encounter_log, const std::string& account_name) -> CheckResult
+{
+	CheckResult result;
+
+	if (!this->is_initialized())
+	{
+		result.error_message = "Uploader shut down";
+		return result;
+	}
+
+	const auto evtc_file = encounter_log->get_data().evtc_data.evtc_file_path;
+
+	try
+	{
+		result.key = this->get_check_upload_key(evtc_file);
+	}
+	catch (const std::filesystem::filesystem_error& e)
+	{
+		result.error_message = "Failed to read log file: " + std::string(e.what());
+		return result;
+	}
+
+	{
+		std::lock_guard check_cache_lock(this->check_cache_mutex);
+
+		if (auto it = this->check_cache.find(result.key); it != this->check_cache.end())
+		{
+			result.cached_uploadable = it->second;
+			return result;
 		}
-		else if (upload.status == WingmanUploadStatus::UPLOADED)
+	}
+
+	/*
+	/checkUpload
+	Checks if there is a conflict in the database regarding a specified log. Returns "Error" if no upload is possible right now, "False" if 'file' or 'filesize' is not specified or the log already exists in the database, "True" if upload is possible.
+	It is highly recommended to run this before /uploadProcessed to quickly reject duplicates without the need of uploading or processing.
+	POST 'file': The name of the .zevtc file to be checked.
+	POST 'timestamp': The timestamp of the creation of this .zevtc file (Unix epoch timestamps in seconds).
+	POST 'filesize': The size in bytes of this .zevtc file.
+	POST 'account': The account name of the uploader account. Recommended for quicker detection of duplicates.
+	*/
+	cpr::Multipart multipart_check_upload =
+	{
+		{ "file", result.key.file_name },
+		{ "timestamp", std::to_string(result.key.timestamp) },
+		{ "filesize", std::to_string(result.key.file_size) },
+		{ "account", account_name }
+	};
+
+	// aborts the request on shutdown instead of waiting for the timeout
+	result.response = post("wingman/checkUpload", cpr::Url("https://gw2wingman.nevermindcreations.de/checkUpload"), multipart_check_upload, cpr::Timeout{ GET_SETTING(wingman.request_timeout) }, cpr::ProgressCallback([this](auto, auto, auto, auto, intptr_t) { return this->is_initialized(); }));
+
+	return result;
+}
+
+void WingmanUploader::process_check(CompletedCheck& completed_check)
+{
+	const auto& result = completed_check.result;
+
+	WingmanUpload upload;
+	upload.status = WingmanUploadStatus::FAILED;
+
+	if (result.error_message.has_value())
+	{
+		upload.error_message = result.error_message;
+		this->set_upload_result(completed_check.encounter_log, upload);
+		return;
+	}
+
+	if (result.cached_uploadable.has_value())
+	{
+		if (result.cached_uploadable.value())
+			this->queue_processed_upload(completed_check.encounter_log);
+		else
 		{
-			LOG("Encounter log uploaded: " + log->id, LogLevel::Info);
+			upload.status = WingmanUploadStatus::SKIPPED;
+			upload.error_message = "Log already exists in the wingman database";
+			this->set_upload_result(completed_check.encounter_log, upload);
 		}
+
+		return;
 	}
 
-	LOG("Uploader shutdown", LogLevel::Info);
+	const auto& response_check_upload = result.response;
+
+	if (response_check_upload.status_code == 200)
+	{
+		if (response_check_upload.text == "True" || response_check_upload.text == "False")
+		{
+			const auto uploadable = response_check_upload.text == "True";
+
+			{
+				std::lock_guard check_cache_lock(this->check_cache_mutex);
+				this->check_cache[result.key] = uploadable;
+			}
+
+			if (uploadable)
+			{
+				this->queue_processed_upload(completed_check.encounter_log);
+				return;
+			}
+
+			upload.status = WingmanUploadStatus::SKIPPED;
+			upload.error_message = "Log already exists in the wingman database";
+		}
+		else if (response_check_upload.text == "Error")
+		{
+			upload.error_message = "Wingman returned an error on /checkUpload";
+		}
+		else
+		{
+			if (response_check_upload.text.empty())
+				upload.error_message = "Wingman returned no data on /checkUpload";
+			else
+				upload.error_message = "Wingman returned an error on /checkUpload: " + response_check_upload.text;
+		}
+	}
+	else
+	{
+		upload.error_message = "Wingman returned an http error on /checkUpload (" + std::to_string(response_check_upload.status_code) + ")";
+	}
+
+	this->set_upload_result(completed_check.encounter_log, upload);
+}
+
+void WingmanUploader::queue_processed_upload(std::shared_ptr<EncounterLog> encounter_log)
+{
+	std::unique_lock upload_queue_lock(this->upload_queue_mutex);
+	this->upload_queue.push(encounter_log);
+	this->upload_cv.notify_one();
+}
+
+void WingmanUploader::set_upload_result(std::shared_ptr<EncounterLog> encounter_log, WingmanUpload upload)
+{
+	std::unique_lock log_lock(encounter_log->mutex);
+
+	if (upload.error_message.has_value() && upload.status != WingmanUploadStatus::SKIPPED)
+		upload.status = WingmanUploadStatus::FAILED;
+
+	encounter_log->wingman_upload = upload;
+
+	if (upload.status == WingmanUploadStatus::SKIPPED)
+		LOG("Encounter log skipped: " + encounter_log->id, LogLevel::Info);
+	else if (upload.status == WingmanUploadStatus::FAILED)
+		LOG("Encounter log upload failed: " + encounter_log->id + " - " + upload.error_message.value_or("Unknown error"), LogLevel::Error);
+	else if (upload.status == WingmanUploadStatus::UPLOADED)
+		LOG_FORMAT(LogLevel::Info, "Encounter log uploaded: {}", encounter_log->id);
+
+	log_lock.unlock();
+
+	global::change_bus->post(encounter_log, LogChange::WINGMAN_UPLOAD);
+}
+
+void WingmanUploader::forget_check(const std::filesystem::path& evtc_file_path)
+{
+	const auto file_name = evtc_file_path.filename().string();
+
+	std::lock_guard check_cache_lock(this->check_cache_mutex);
+
+	// keys are ordered by name first, the entries of the file are found without reading its size or time again
+	auto first = this->check_cache.lower_bound(CheckUploadKey{ file_name, 0, (std::numeric_limits<int64_t>::min)() });
+	auto last = first;
+
+	while (last != this->check_cache.end() && last->first.file_name == file_name)
+		++last;
+
+	this->check_cache.erase(first, last);
+}
+
+auto WingmanUploader::get_check_upload_key(const std::filesystem::path& evtc_file_path) -> CheckUploadKey
+{
+	auto ftime = std::filesystem::last_write_time(evtc_file_path);
+	auto cftime = std::chrono::system_clock::to_time_t(std::chrono::clock_cast<std::chrono::system_clock>(ftime));
+
+	// the original log identifies it, the same log compressed again locally would differ in size
+	return CheckUploadKey{ evtc_file_path.filename().string(), static_cast<uint64_t>(std::filesystem::file_size(evtc_file_path)), static_cast<int64_t>(cftime) };
 }
 
 bool WingmanUploader::check_server_availability()
@@ -270,7 +559,7 @@ bool WingmanUploader::check_server_availability()
 		Returns "True" if a connection to the wingman database can be established, "False" otherwise.
 		*/
 
-		auto response = cpr::Get(cpr::Url("https://gw2wingman.nevermindcreations.de/testConnection"), cpr::Timeout{ GET_SETTING(wingman.request_timeout) });
+		auto response = this->get("wingman/testConnection", cpr::Url("https://gw2wingman.nevermindcreations.de/testConnection"), cpr::Timeout{ GET_SETTING(wingman.request_timeout) });
 
 		return servers_available = (response.status_code == 200 && response.text == "True");
 	}
@@ -278,4 +567,5 @@ bool WingmanUploader::check_server_availability()
 	return servers_available;
 }
 
-#undef LOG
\ No newline at end of file
+#undef LOG
+#undef LOG_FORMAT
\ No newline at end of file
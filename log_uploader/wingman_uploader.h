@@ -4,7 +4,12 @@
 #include "uploader.h"	
 #include "settings.h"
 
+#include <compare>
+#include <deque>
+#include <map>
 #include <memory>
+#include <optional>
+#include <string>
 
 class WingmanUploader : public Uploader
 {
@@ -22,14 +27,81 @@ public:
 		this->initialized.store(true);
 
 		this->upload_thread = std::thread(&WingmanUploader::run, this);
+		this->check_thread = std::thread(&WingmanUploader::run_check, this);
 	};
 
-	void queue_upload(std::shared_ptr<EncounterLog> encounter_log) override;
+	auto release() -> void override
+	{
+		Uploader::release();
+
+		{
+			std::lock_guard check_queue_lock(this->check_queue_mutex);
+			std::queue<std::shared_ptr<EncounterLog>> empty;
+			std::swap(this->check_queue, empty);
+		}
+
+		this->check_cv.notify_all();
+
+		if (this->check_thread.joinable())
+			this->check_thread.join();
+	}
+
+	void queue_upload(std::shared_ptr<EncounterLog> encounter_log) override { this->queue_uploads({ std::move(encounter_log) }); }
+	void queue_uploads(const std::vector<std::shared_ptr<EncounterLog>>& encounter_logs) override;
 	void process_auto_upload(std::shared_ptr<EncounterLog> encounter_log);
 
+	// drops the cached /checkUpload results of a log, called when it is evicted from the working set
+	void forget_check(const std::filesystem::path& evtc_file_path);
+
 protected:
 	void run() override;
 private:
+	// /checkUpload identifies a log by its name, size and creation time
+	struct CheckUploadKey
+	{
+		std::string file_name;
+		uint64_t file_size = 0;
+		int64_t timestamp = 0;
+
+		auto operator<=>(const CheckUploadKey&) const = default;
+	};
+
+	struct CheckResult
+	{
+		CheckUploadKey key;
+		std::optional<bool> cached_uploadable; // set when the log was checked before, no request was sent
+		std::optional<std::string> error_message; // the check could not be sent
+		cpr::Response response;
+	};
+
+	struct CompletedCheck
+	{
+		std::shared_ptr<EncounterLog> encounter_log;
+		CheckResult result;
+	};
+
+	// logs wait for their duplicate check here before they are handed to the upload stage
+	std::mutex check_queue_mutex;
+	std::condition_variable check_cv;
+	std::queue<std::shared_ptr<EncounterLog>> check_queue;
+	std::deque<CompletedCheck> completed_checks; // filled by the requests as they finish, wakes the check thread
+
+	std::thread check_thread;
+
+	// true if the log can be uploaded, false if wingman already knows it
+	std::mutex check_cache_mutex;
+	std::map<CheckUploadKey, bool> check_cache;
+
+	void run_check();
+	void send_check(std::shared_ptr<EncounterLog> encounter_log, std::deque<cpr::AsyncWrapper<void>>& pending_checks);
+	auto check_upload(std::shared_ptr<EncounterLog> encounter_log, const std::string& account_name) -> CheckResult;
+	void process_check(CompletedCheck& completed_check);
+
+	void queue_processed_upload(std::shared_ptr<EncounterLog> encounter_log);
+	void set_upload_result(std::shared_ptr<EncounterLog> encounter_log, WingmanUpload upload);
+
+	auto get_check_upload_key(const std::filesystem::path& evtc_file_path) -> CheckUploadKey;
+
 	bool check_server_availability();
 };
 
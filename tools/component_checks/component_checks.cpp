@@ -0,0 +1,318 @@
+// checks the self-contained building blocks of the addon against reference results, the P² quantile estimate and the bounded ring
+// builds with any C++20 compiler and nlohmann/json on the include path, e.g.
+// g++ -std=c++20 -O2 -pthread -I <nlohmann json include directory> -o component_checks component_checks.cpp ../../log_uploader/streaming_quantile.cpp
+//
+// usage: component_checks [--values <count>] [--seed <number>]
+//
+// every check prints one line, the exit code is 1 when any of them failed
+
+#include "../../log_uploader/bounded_ring.h"
+#include "../../log_uploader/streaming_quantile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	class Options
+	{
+	public:
+		size_t values = 200000; // per quantile stream and per ring producer
+		size_t seed = 1;
+	};
+
+	size_t failures = 0;
+
+	void check(bool passed, const char* description)
+	{
+		std::printf("%-6s %s\n", passed ? "ok" : "FAILED", description);
+
+		if (!passed)
+			failures++;
+	}
+
+	// the interpolated quantile of all values, how the estimate is defined while it is still exact
+	auto get_exact_quantile(std::vector<double> values, double quantile) -> double
+	{
+		std::sort(values.begin(), values.end());
+
+		const auto rank = quantile * static_cast<double>(values.size() - 1);
+		const auto lower = static_cast<size_t>(std::floor(rank));
+		const auto upper = static_cast<size_t>(std::ceil(rank));
+
+		return values[lower] + (rank - static_cast<double>(lower)) * (values[upper] - values[lower]);
+	}
+
+	auto estimate(const std::vector<double>& values, double quantile) -> double
+	{
+		StreamingQuantile streaming_quantile(quantile);
+
+		for (const auto value : values)
+			streaming_quantile.add(value);
+
+		return streaming_quantile.get();
+	}
+
+	// the estimate is off by at most the given share of the distance between the 1st and 99th percentile of the values
+	auto is_close(const std::vector<double>& values, double quantile, double tolerance) -> bool
+	{
+		const auto spread = get_exact_quantile(values, .99) - get_exact_quantile(values, .01);
+		const auto error = std::abs(estimate(values, quantile) - get_exact_quantile(values, quantile));
+
+		return error <= tolerance * spread;
+	}
+
+	void check_streaming_quantile(const Options& options)
+	{
+		std::mt19937_64 generator(options.seed);
+
+		{
+			const std::vector<double> values = { 7., 3., 5. };
+			check(estimate(values, .5) == 5., "quantile: exact median of fewer than five values");
+
+			const std::vector<double> more_values = { 4., 1., 3., 2. };
+			check(estimate(more_values, .9) == get_exact_quantile(more_values, .9), "quantile: exact interpolated p90 of fewer than five values");
+		}
+
+		check(StreamingQuantile().get() == 0. && StreamingQuantile().get_count() == 0, "quantile: empty estimate is 0");
+
+		{
+			const std::vector<double> values(options.values, 42.);
+			check(estimate(values, .5) == 42., "quantile: constant stream");
+		}
+
+		std::vector<double> uniform(options.values);
+		std::uniform_real_distribution<double> uniform_distribution(0., 600000.);
+
+		for (auto& value : uniform)
+			value = uniform_distribution(generator);
+
+		check(is_close(uniform, .5, .01), "quantile: median of uniform values within 1%");
+		check(is_close(uniform, .9, .01), "quantile: p90 of uniform values within 1%");
+
+		// skewed like encounter durations, most kills are close together with a long tail of slow ones
+		std::vector<double> durations(options.values);
+		std::lognormal_distribution<double> duration_distribution(12., .4);
+
+		for (auto& value : durations)
+			value = duration_distribution(generator);
+
+		check(is_close(durations, .5, .01), "quantile: median of log-normal durations within 1%");
+		check(is_close(durations, .9, .02), "quantile: p90 of log-normal durations within 2%");
+
+		// sorted input is the worst case of the estimate, exact on a linear ramp but lagging behind on a skewed one
+		{
+			std::vector<double> ramp(options.values);
+
+			for (size_t i = 0; i < ramp.size(); i++)
+				ramp[i] = static_cast<double>(i);
+
+			const auto exact = get_exact_quantile(ramp, .5);
+			const auto ascending = estimate(ramp, .5);
+
+			std::reverse(ramp.begin(), ramp.end());
+			const auto descending = estimate(ramp, .5);
+
+			check(std::abs(ascending - exact) <= 1. && std::abs(descending - exact) <= 1., "quantile: median of an ascending and descending ramp within 1");
+		}
+
+		auto sorted = durations;
+		std::sort(sorted.begin(), sorted.end());
+
+		check(is_close(sorted, .5, .05), "quantile: median of ascending log-normal durations within 5%");
+
+		std::reverse(sorted.begin(), sorted.end());
+		check(is_close(sorted, .5, .05), "quantile: median of descending log-normal durations within 5%");
+
+		// statistics.json stores the markers, a restored estimate continues where it stopped
+		{
+			const auto half = durations.size() / 2;
+
+			StreamingQuantile continuous;
+			StreamingQuantile saved;
+
+			for (size_t i = 0; i < half; i++)
+			{
+				continuous.add(durations[i]);
+				saved.add(durations[i]);
+			}
+
+			auto restored = nlohmann::json(saved).get<StreamingQuantile>();
+
+			for (size_t i = half; i < durations.size(); i++)
+			{
+				continuous.add(durations[i]);
+				restored.add(durations[i]);
+			}
+
+			check(restored.get() == continuous.get() && restored.get_count() == continuous.get_count(), "quantile: json round trip continues the estimate");
+		}
+	}
+
+	void check_bounded_ring(const Options& options)
+	{
+		check(BoundedRing<int>(0).capacity() == 1 && BoundedRing<int>(5).capacity() == 8 && BoundedRing<int>(64).capacity() == 64, "ring: capacity rounded up to a power of two");
+
+		{
+			BoundedRing<int> ring(8);
+
+			bool pushed = true;
+			for (int i = 0; i < 8; i++)
+				pushed = ring.try_push([i](int& value) { value = i; }) && pushed;
+
+			const auto full = !ring.try_push([](int& value) { value = -1; });
+
+			bool ordered = true;
+			for (int i = 0; i < 8; i++)
+				ordered = ring.try_pop([&ordered, i](int& value) { ordered = ordered && value == i; }) && ordered;
+
+			const auto empty = ring.empty() && !ring.try_pop([](int&) {});
+
+			check(pushed && full && ordered && empty, "ring: fills up, rejects when full, pops in order and is empty again");
+		}
+
+		// positions wrap around the slots many times, every slot is written over the value taken from it before
+		{
+			BoundedRing<std::string> ring(4);
+
+			bool ordered = true;
+			bool reused = true;
+
+			for (size_t i = 0; i < 1000; i++)
+			{
+				ring.try_push([&reused, i](std::string& value)
+					{
+						reused = reused && (i < 4 || value == "value " + std::to_string(i - 4));
+						value = "value " + std::to_string(i);
+					});
+
+				if (i % 2 == 1)
+				{
+					for (auto j = i - 1; j <= i; j++)
+						ring.try_pop([&ordered, j](std::string& value) { ordered = ordered && value == "value " + std::to_string(j); });
+				}
+			}
+
+			check(ordered && ring.empty(), "ring: order kept across wrap arounds");
+			check(reused, "ring: taken values stay in their slot for the next fill");
+		}
+
+		// every value is taken exactly once and the values of one producer arrive in order at every consumer
+		{
+			constexpr size_t producer_count = 4;
+			constexpr size_t consumer_count = 2;
+
+			BoundedRing<uint64_t> ring(256);
+
+			std::vector<std::vector<uint8_t>> taken(producer_count, std::vector<uint8_t>(options.values));
+			std::atomic<size_t> taken_count = 0;
+			std::atomic<bool> ordered = true;
+
+			std::vector<std::thread> threads;
+
+			for (size_t producer = 0; producer < producer_count; producer++)
+			{
+				threads.emplace_back([&ring, &options, producer]
+					{
+						for (uint64_t i = 0; i < options.values; i++)
+						{
+							while (!ring.try_push([producer, i](uint64_t& value) { value = producer << 48 | i; }))
+								std::this_thread::yield();
+						}
+					});
+			}
+
+			for (size_t consumer = 0; consumer < consumer_count; consumer++)
+			{
+				threads.emplace_back([&]
+					{
+						std::vector<int64_t> last(producer_count, -1);
+
+						while (taken_count.load() < producer_count * options.values)
+						{
+							uint64_t value = 0;
+
+							if (!ring.try_pop([&value](uint64_t& slot) { value = slot; }))
+							{
+								std::this_thread::yield();
+								continue;
+							}
+
+							const auto producer = static_cast<size_t>(value >> 48);
+							const auto index = static_cast<int64_t>(value & 0xffffffffffff);
+
+							if (producer >= producer_count || index <= last[producer])
+								ordered = false;
+							else
+							{
+								last[producer] = index;
+								taken[producer][static_cast<size_t>(index)]++;
+							}
+
+							taken_count++;
+						}
+					});
+			}
+
+			for (auto& thread : threads)
+				thread.join();
+
+			const auto exactly_once = std::all_of(taken.begin(), taken.end(), [](const std::vector<uint8_t>& counts) { return std::all_of(counts.begin(), counts.end(), [](uint8_t count) { return count == 1; }); });
+
+			check(exactly_once && ring.empty(), "ring: 4 producers and 2 consumers take every value exactly once");
+			check(ordered.load(), "ring: values of one producer arrive in order");
+		}
+	}
+
+	auto parse_count(const char* value, size_t& count) -> bool
+	{
+		char* end = nullptr;
+		const auto parsed = std::strtoull(value, &end, 10);
+
+		if (end == value || *end != '\0' || parsed == 0)
+			return false;
+
+		count = static_cast<size_t>(parsed);
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const auto has_value = i + 1 < argc;
+
+		if (std::strcmp(argv[i], "--values") == 0 && has_value && parse_count(argv[i + 1], options.values) && options.values >= 10000)
+			i++;
+		else if (std::strcmp(argv[i], "--seed") == 0 && has_value && parse_count(argv[i + 1], options.seed))
+			i++;
+		else
+		{
+			std::fprintf(stderr, "usage: %s [--values <count, at least 10000>] [--seed <number>]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	check_streaming_quantile(options);
+	check_bounded_ring(options);
+
+	if (failures > 0)
+	{
+		std::fprintf(stderr, "%zu checks failed\n", failures);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,500 @@
+// drops thousands of synthetic logs into a watched directory and measures how the detection pipeline keeps up
+// linux only, drives the inotify backend of the file watcher, e.g.
+// g++ -std=c++20 -O2 -pthread -o detection_benchmark detection_benchmark.cpp ../../log_uploader/file_watcher_inotify.cpp
+//
+// usage: detection_benchmark [--files <count>] [--writers <count>] [--directories <count>] [--workers <count>] [--buffer <KiB>] [--size <bytes>] [--path <directory>]
+//
+// the writers mimic arcdps: every log is written to a temporary file in its encounter directory and renamed into place, encounter
+// directories are created while the benchmark runs. the monitor thread and the workers mirror DirectoryMonitor::run, enqueue, reconcile
+// and run_worker: renamed or closed logs are queued, a dropped change buffer triggers a scan of the root, workers wait until the file is
+// released, read its header and register it once
+
+#include "../../log_uploader/file_watcher.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+	using clock = std::chrono::steady_clock;
+
+	constexpr auto idle_timeout = std::chrono::seconds(10); // files still missing after this long without progress are reported as missed
+
+	class Options
+	{
+	public:
+		size_t files = 5000;
+		size_t writers = 4;
+		size_t directories = 20;
+		size_t workers = 2; // DirectoryMonitor::worker_count
+		size_t buffer = 64; // KiB, the default monitor.change_buffer_size
+		size_t size = 64 * 1024;
+		std::filesystem::path path;
+	};
+
+	class Candidate
+	{
+	public:
+		std::filesystem::path file_path;
+		clock::time_point detected_time{};
+		FileEventType event_type = FileEventType::RENAMED_TO;
+	};
+
+	class Samples
+	{
+	public:
+		std::vector<double> milliseconds;
+
+		void add(clock::duration duration) { this->milliseconds.push_back(std::chrono::duration<double, std::milli>(duration).count()); }
+
+		void print(const char* name)
+		{
+			auto& values = this->milliseconds;
+			std::sort(values.begin(), values.end());
+
+			const auto percentile = [&values](double p) { return values.empty() ? 0. : values[static_cast<size_t>(p * static_cast<double>(values.size() - 1))]; };
+
+			std::printf("%-12s %8zu %10.2f %10.2f %10.2f\n", name, values.size(), percentile(.5), percentile(.99), values.empty() ? 0. : values.back());
+		}
+	};
+
+	class Pipeline
+	{
+	public:
+		Pipeline(const Options& options, std::filesystem::path root) : options(options), root(std::move(root)), drop_times(options.files) {}
+
+		auto start() -> bool
+		{
+			this->watcher = FileWatcher::create();
+
+			if (!this->watcher->open(this->options.buffer * 1024) || !this->watcher->add_root(this->root))
+			{
+				std::fprintf(stderr, "%s\n", this->watcher->get_error().c_str());
+				return false;
+			}
+
+			this->monitor_thread = std::thread(&Pipeline::run, this);
+
+			for (size_t i = 0; i < this->options.workers; i++)
+				this->workers.emplace_back(&Pipeline::run_worker, this);
+
+			return true;
+		}
+
+		void stop()
+		{
+			{
+				std::lock_guard lock(this->candidate_mutex);
+				this->stopped = true;
+			}
+
+			this->candidate_cv.notify_all();
+			this->watcher->interrupt();
+
+			this->monitor_thread.join();
+
+			for (auto& worker : this->workers)
+				worker.join();
+		}
+
+		// writes the log like arcdps and records when it became visible under its final name
+		void drop(size_t index)
+		{
+			const auto directory = this->root / ("Encounter " + std::to_string(index % this->options.directories));
+			const auto name = "20260101-" + std::to_string(100000 + index);
+
+			std::error_code error;
+			std::filesystem::create_directories(directory, error);
+
+			std::vector<char> content(this->options.size, 'x');
+			std::memcpy(content.data(), "EVTC20260101", 12);
+			content[12] = 1; // revision
+			content[13] = static_cast<char>(0x1a); // trigger id 6938, a stand-in for a known boss
+			content[14] = static_cast<char>(0x1b);
+
+			const auto temporary_path = directory / (name + ".tmp");
+
+			{
+				std::ofstream file(temporary_path, std::ios::binary);
+				file.write(content.data(), static_cast<std::streamsize>(content.size()));
+			}
+
+			this->drop_times[index].store(clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+
+			std::filesystem::rename(temporary_path, directory / (name + ".zevtc"), error);
+
+			if (error)
+				std::fprintf(stderr, "failed to rename %s: %s\n", temporary_path.c_str(), error.message().c_str());
+		}
+
+		// blocks until every log was handled or nothing progressed for the idle timeout
+		void wait_until_done()
+		{
+			std::unique_lock lock(this->candidate_mutex);
+
+			auto handled = this->registered + this->failed;
+
+			while (handled < this->options.files)
+			{
+				if (!this->candidate_cv.wait_for(lock, idle_timeout, [this, handled] { return this->registered + this->failed != handled; }))
+					break;
+
+				handled = this->registered + this->failed;
+			}
+		}
+
+		void print(double drop_seconds, double total_seconds)
+		{
+			std::lock_guard lock(this->candidate_mutex);
+
+			std::printf("%zu logs dropped by %zu writers into %zu directories in %.2fs (%.0f logs/s), %zu workers, %zu KiB change buffer\n\n", this->options.files, this->options.writers,
+				this->options.directories, drop_seconds, static_cast<double>(this->options.files) / drop_seconds, this->options.workers, this->options.buffer);
+
+			std::printf("registered %llu, failed %llu, missed %llu, duplicates %llu\n", static_cast<unsigned long long>(this->registered), static_cast<unsigned long long>(this->failed),
+				static_cast<unsigned long long>(this->get_missed()), static_cast<unsigned long long>(this->duplicates));
+			std::printf("dropped change buffers %llu, logs recovered by the scan %llu, max queue depth %zu\n", static_cast<unsigned long long>(this->dropped),
+				static_cast<unsigned long long>(this->recovered), this->max_queue_depth);
+			std::printf("last log registered %.2fs after the first drop\n\n", total_seconds);
+
+			std::printf("%-12s %8s %10s %10s %10s\n", "stage", "count", "p50 ms", "p99 ms", "max ms");
+			this->queue_wait.print("queue wait");
+			this->readiness.print("readiness");
+			this->end_to_end.print("end to end");
+		}
+
+		auto get_missed() const -> uint64_t { return this->options.files - (std::min)(static_cast<uint64_t>(this->options.files), this->registered + this->failed); }
+
+		auto get_last_registered_time() const -> clock::time_point { return this->last_registered_time; }
+
+	private:
+		const Options& options;
+		std::filesystem::path root;
+
+		std::unique_ptr<FileWatcher> watcher;
+		std::thread monitor_thread;
+		std::vector<std::thread> workers;
+
+		std::vector<std::atomic<clock::rep>> drop_times; // by log index, set right before the rename
+
+		// only used by the monitor thread
+		std::unordered_set<std::string> known_files;
+
+		std::mutex candidate_mutex;
+		std::condition_variable candidate_cv;
+		std::deque<Candidate> candidates;
+		bool stopped = false;
+
+		// guarded by candidate_mutex
+		std::unordered_set<std::string> registered_logs;
+		uint64_t registered = 0;
+		uint64_t failed = 0;
+		uint64_t duplicates = 0;
+		uint64_t dropped = 0;
+		uint64_t recovered = 0;
+		size_t max_queue_depth = 0;
+		clock::time_point last_registered_time{};
+
+		Samples queue_wait; // detection until a worker picked the file up
+		Samples readiness; // detection until the file was released
+		Samples end_to_end; // rename until the log was registered
+
+		void run()
+		{
+			std::vector<FileEvent> events;
+
+			while (true)
+			{
+				events.clear();
+
+				if (!this->watcher->wait(events))
+					break;
+
+				const auto detected_time = clock::now();
+
+				std::vector<Candidate> new_candidates;
+				auto events_dropped = false;
+
+				for (const auto& event : events)
+				{
+					if (event.type == FileEventType::EVENTS_DROPPED)
+					{
+						events_dropped = true;
+						continue;
+					}
+
+					if (event.type == FileEventType::ROOT_LOST)
+					{
+						std::fprintf(stderr, "the benchmark directory can no longer be watched\n");
+						continue;
+					}
+
+					if (event.type != FileEventType::RENAMED_TO && event.type != FileEventType::CLOSED_AFTER_WRITE)
+						continue;
+
+					const auto extension = event.path.extension();
+
+					if (extension == ".evtc" || extension == ".zevtc")
+						new_candidates.push_back({ this->root / event.path, detected_time, event.type });
+				}
+
+				this->enqueue(std::move(new_candidates), false);
+
+				if (events_dropped)
+				{
+					{
+						std::lock_guard lock(this->candidate_mutex);
+						this->dropped++;
+					}
+
+					this->reconcile();
+				}
+			}
+		}
+
+		void enqueue(std::vector<Candidate> new_candidates, bool recovered_by_scan)
+		{
+			std::erase_if(new_candidates, [this](const Candidate& candidate) { return !this->known_files.insert(candidate.file_path.native()).second; });
+
+			if (new_candidates.empty())
+				return;
+
+			std::lock_guard lock(this->candidate_mutex);
+
+			for (auto& candidate : new_candidates)
+				this->candidates.push_back(std::move(candidate));
+
+			this->max_queue_depth = (std::max)(this->max_queue_depth, this->candidates.size());
+
+			if (recovered_by_scan)
+				this->recovered += new_candidates.size();
+
+			this->candidate_cv.notify_all();
+		}
+
+		// the benchmark directory only holds its own logs, the whole tree is scanned instead of the files after the watermark
+		void reconcile()
+		{
+			const auto detected_time = clock::now();
+
+			std::vector<Candidate> missed_candidates;
+			std::error_code error;
+
+			for (auto it = std::filesystem::recursive_directory_iterator(this->root, error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+			{
+				if (it->is_regular_file(error) && it->path().extension() == ".zevtc")
+					missed_candidates.push_back({ it->path(), detected_time, FileEventType::RENAMED_TO });
+
+				error.clear();
+			}
+
+			this->enqueue(std::move(missed_candidates), true);
+		}
+
+		void run_worker()
+		{
+			std::unique_lock lock(this->candidate_mutex);
+
+			while (true)
+			{
+				this->candidate_cv.wait(lock, [this] { return this->stopped || !this->candidates.empty(); });
+
+				if (this->stopped)
+					break;
+
+				auto candidate = std::move(this->candidates.front());
+				this->candidates.pop_front();
+
+				this->queue_wait.add(clock::now() - candidate.detected_time);
+
+				lock.unlock();
+
+				const auto released = candidate.event_type == FileEventType::CLOSED_AFTER_WRITE || this->wait_until_released(candidate.file_path);
+				const auto released_time = clock::now();
+				const auto valid = released && this->read_header(candidate.file_path);
+
+				std::error_code error;
+				const auto log_key = candidate.file_path.filename().string() + std::to_string(std::filesystem::file_size(candidate.file_path, error));
+
+				lock.lock();
+
+				if (!valid)
+				{
+					this->failed++;
+				}
+				else if (!this->registered_logs.insert(log_key).second)
+				{
+					this->duplicates++;
+					continue;
+				}
+				else
+				{
+					this->readiness.add(released_time - candidate.detected_time);
+
+					const auto registered_time = clock::now();
+					const auto index = static_cast<size_t>(std::strtoull(candidate.file_path.stem().string().substr(9).c_str(), nullptr, 10) - 100000);
+
+					if (index < this->drop_times.size())
+						this->end_to_end.add(registered_time - clock::time_point(clock::duration(this->drop_times[index].load(std::memory_order_relaxed))));
+
+					this->registered++;
+					this->last_registered_time = registered_time;
+				}
+
+				this->candidate_cv.notify_all();
+			}
+		}
+
+		// DirectoryMonitor::wait_until_released with the same backoff
+		auto wait_until_released(const std::filesystem::path& file_path) -> bool
+		{
+			constexpr auto initial_backoff = std::chrono::milliseconds(5);
+			constexpr auto max_backoff = std::chrono::milliseconds(500);
+			constexpr auto timeout = std::chrono::seconds(10);
+
+			const auto deadline = clock::now() + timeout;
+
+			auto backoff = std::chrono::milliseconds(initial_backoff);
+
+			std::error_code error;
+			auto last_size = std::filesystem::file_size(file_path, error);
+
+			while (!FileWatcher::is_released(file_path))
+			{
+				if (clock::now() + backoff > deadline)
+					return false;
+
+				std::this_thread::sleep_for(backoff);
+
+				const auto size = std::filesystem::file_size(file_path, error);
+
+				backoff = size != last_size ? initial_backoff : (std::min)(backoff * 2, max_backoff);
+				last_size = size;
+			}
+
+			return true;
+		}
+
+		// the part of EVTCParser::parse that every log pays for
+		auto read_header(const std::filesystem::path& file_path) -> bool
+		{
+			std::ifstream file(file_path, std::ios::binary);
+
+			char header[16] = {};
+
+			return file.read(header, sizeof(header)) && std::memcmp(header, "EVTC", 4) == 0;
+		}
+	};
+
+	auto parse_count(const char* value, size_t& count) -> bool
+	{
+		char* end = nullptr;
+		const auto parsed = std::strtoull(value, &end, 10);
+
+		if (end == value || *end != '\0' || parsed == 0)
+			return false;
+
+		count = static_cast<size_t>(parsed);
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const auto has_value = i + 1 < argc;
+
+		if (std::strcmp(argv[i], "--files") == 0 && has_value && parse_count(argv[i + 1], options.files))
+			i++;
+		else if (std::strcmp(argv[i], "--writers") == 0 && has_value && parse_count(argv[i + 1], options.writers))
+			i++;
+		else if (std::strcmp(argv[i], "--directories") == 0 && has_value && parse_count(argv[i + 1], options.directories))
+			i++;
+		else if (std::strcmp(argv[i], "--workers") == 0 && has_value && parse_count(argv[i + 1], options.workers))
+			i++;
+		else if (std::strcmp(argv[i], "--buffer") == 0 && has_value && parse_count(argv[i + 1], options.buffer))
+			i++;
+		else if (std::strcmp(argv[i], "--size") == 0 && has_value && parse_count(argv[i + 1], options.size) && options.size >= 16)
+			i++;
+		else if (std::strcmp(argv[i], "--path") == 0 && has_value)
+			options.path = argv[++i];
+		else
+		{
+			std::fprintf(stderr, "usage: %s [--files <count>] [--writers <count>] [--directories <count>] [--workers <count>] [--buffer <KiB>] [--size <bytes>] [--path <directory>]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	// the logs are written below a fresh directory that is removed again afterwards
+	const auto root = (options.path.empty() ? std::filesystem::temp_directory_path() : options.path) / ("detection_benchmark_" + std::to_string(getpid()));
+
+	std::error_code error;
+
+	if (!std::filesystem::create_directories(root, error))
+	{
+		std::fprintf(stderr, "failed to create %s: %s\n", root.c_str(), error.message().c_str());
+		return 1;
+	}
+
+	Pipeline pipeline(options, root);
+
+	if (!pipeline.start())
+	{
+		std::filesystem::remove_all(root, error);
+		return 1;
+	}
+
+	const auto start_time = clock::now();
+
+	std::atomic<size_t> next_index = 0;
+	std::vector<std::thread> writers;
+
+	for (size_t writer = 0; writer < options.writers; writer++)
+	{
+		writers.emplace_back([&pipeline, &next_index, &options]
+			{
+				for (auto index = next_index++; index < options.files; index = next_index++)
+					pipeline.drop(index);
+			});
+	}
+
+	for (auto& writer : writers)
+		writer.join();
+
+	const auto drop_seconds = std::chrono::duration<double>(clock::now() - start_time).count();
+
+	pipeline.wait_until_done();
+	pipeline.stop();
+
+	const auto total_seconds = std::chrono::duration<double>(pipeline.get_last_registered_time() - start_time).count();
+
+	pipeline.print(drop_seconds, (std::max)(total_seconds, 0.));
+
+	std::filesystem::remove_all(root, error);
+
+	// every dropped log has to be found, either by its event or by the scan after an overflow
+	if (pipeline.get_missed() > 0)
+	{
+		std::fprintf(stderr, "logs were missed\n");
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,347 @@
+// measures the cost of queueing log messages under contention, the lock-free ring used by the logger against a mutex guarded queue
+// builds with any C++20 compiler, e.g. g++ -std=c++20 -O2 -pthread -o log_queue_benchmark log_queue_benchmark.cpp
+//
+// usage: log_queue_benchmark [--producers <count>] [--messages <count per producer>] [--capacity <slots>]
+//
+// the producers and the writer mirror Logger::push and Logger::write_thread: messages are filled in place, the oldest one is
+// dropped when the ring is full, the writer drains batches and is only woken while it waits
+
+#include "../../log_uploader/bounded_ring.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	using clock = std::chrono::steady_clock;
+
+	class Message
+	{
+	public:
+		int level = 0;
+		int source = 0;
+		std::string message;
+	};
+
+	constexpr size_t max_batch_size = 256;
+
+	// a typical message of a bulk action, long enough to leave the small string buffer
+	constexpr std::string_view message_text = "Queued encounter log for upload: Boss/20260101-120000.zevtc";
+
+	class Options
+	{
+	public:
+		size_t producers = 8;
+		size_t messages = 200000; // per producer
+		size_t capacity = 4096;
+	};
+
+	class Result
+	{
+	public:
+		double seconds = 0.;
+		uint64_t written = 0;
+		uint64_t dropped = 0;
+		std::vector<uint32_t> push_ns; // of every push, merged from all producers
+	};
+
+	// the logger's queue, the writer sleeps on the signal and producers only take the mutex while it waits
+	class RingQueue
+	{
+	public:
+		explicit RingQueue(size_t capacity) : ring(capacity) {}
+
+		void push(int producer, uint64_t sequence)
+		{
+			const auto fill = [&](Message& message)
+				{
+					message.level = 0;
+					message.source = producer;
+					message.message.assign(message_text);
+					message.message += std::to_string(sequence);
+				};
+
+			while (!this->ring.try_push(fill))
+			{
+				if (this->ring.try_pop([](Message&) {}))
+					this->dropped.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			if (this->writer_waiting.load(std::memory_order_relaxed))
+			{
+				{
+					std::lock_guard lock(this->write_mutex);
+					this->write_signal++;
+				}
+
+				this->write_cv.notify_one();
+			}
+		}
+
+		// returns the number of messages taken, 0 once stopped and empty
+		auto drain(std::vector<Message>& batch) -> size_t
+		{
+			while (true)
+			{
+				size_t batch_size = 0;
+
+				while (batch_size < batch.size() && this->ring.try_pop([&](Message& message) { std::swap(batch[batch_size].message, message.message); }))
+					batch_size++;
+
+				if (batch_size > 0 || this->stopped.load())
+					return batch_size;
+
+				std::unique_lock lock(this->write_mutex);
+
+				const auto signal = this->write_signal;
+
+				this->writer_waiting.store(true, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+
+				if (this->ring.empty() && !this->stopped.load())
+					this->write_cv.wait(lock, [this, signal] { return this->write_signal != signal; });
+
+				this->writer_waiting.store(false, std::memory_order_relaxed);
+			}
+		}
+
+		void stop()
+		{
+			this->stopped.store(true);
+
+			{
+				std::lock_guard lock(this->write_mutex);
+				this->write_signal++;
+			}
+
+			this->write_cv.notify_all();
+		}
+
+		std::atomic<uint64_t> dropped = 0;
+
+	private:
+		BoundedRing<Message> ring;
+
+		std::atomic<bool> writer_waiting = false;
+		std::mutex write_mutex;
+		std::condition_variable write_cv;
+		uint32_t write_signal = 0;
+
+		std::atomic<bool> stopped = false;
+	};
+
+	// the queue the logger used before the ring, every message is allocated and every push notifies the writer
+	class MutexQueue
+	{
+	public:
+		explicit MutexQueue(size_t) {}
+
+		void push(int producer, uint64_t sequence)
+		{
+			Message message;
+			message.level = 0;
+			message.source = producer;
+			message.message.assign(message_text);
+			message.message += std::to_string(sequence);
+
+			{
+				std::lock_guard lock(this->mutex);
+				this->queue.push(std::move(message));
+			}
+
+			this->cv.notify_one();
+		}
+
+		auto drain(std::vector<Message>& batch) -> size_t
+		{
+			std::unique_lock lock(this->mutex);
+
+			this->cv.wait(lock, [this] { return this->stopped || !this->queue.empty(); });
+
+			size_t batch_size = 0;
+
+			while (batch_size < batch.size() && !this->queue.empty())
+			{
+				batch[batch_size++] = std::move(this->queue.front());
+				this->queue.pop();
+			}
+
+			return batch_size;
+		}
+
+		void stop()
+		{
+			{
+				std::lock_guard lock(this->mutex);
+				this->stopped = true;
+			}
+
+			this->cv.notify_all();
+		}
+
+		std::atomic<uint64_t> dropped = 0; // unbounded, nothing is dropped
+
+	private:
+		std::mutex mutex;
+		std::condition_variable cv;
+		std::queue<Message> queue;
+		bool stopped = false;
+	};
+
+	template <typename Queue>
+	auto run(const Options& options) -> Result
+	{
+		Queue queue(options.capacity);
+
+		Result result;
+		std::vector<std::vector<uint32_t>> push_ns(options.producers);
+
+		std::atomic<size_t> ready = 0;
+		std::atomic<bool> start = false;
+
+		std::thread writer([&queue, &result]
+			{
+				std::vector<Message> batch(max_batch_size);
+				size_t length = 0;
+
+				// reads the messages like write_message would, so the writer does comparable work in both modes
+				while (const auto batch_size = queue.drain(batch))
+				{
+					for (size_t i = 0; i < batch_size; i++)
+						length += batch[i].message.size();
+
+					result.written += batch_size;
+				}
+
+				if (length == 0)
+					std::fprintf(stderr, "no messages written\n");
+			});
+
+		std::vector<std::thread> producers;
+
+		for (size_t producer = 0; producer < options.producers; producer++)
+		{
+			producers.emplace_back([&, producer]
+				{
+					auto& samples = push_ns[producer];
+					samples.reserve(options.messages);
+
+					ready++;
+
+					while (!start.load())
+						std::this_thread::yield();
+
+					for (uint64_t i = 0; i < options.messages; i++)
+					{
+						const auto push_start = clock::now();
+						queue.push(static_cast<int>(producer), i);
+						samples.push_back(static_cast<uint32_t>((std::min)(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - push_start).count(), int64_t(UINT32_MAX))));
+					}
+				});
+		}
+
+		while (ready.load() < options.producers)
+			std::this_thread::yield();
+
+		const auto start_time = clock::now();
+		start.store(true);
+
+		for (auto& producer : producers)
+			producer.join();
+
+		queue.stop();
+		writer.join();
+
+		result.seconds = std::chrono::duration<double>(clock::now() - start_time).count();
+		result.dropped = queue.dropped.load();
+
+		for (auto& samples : push_ns)
+			result.push_ns.insert(result.push_ns.end(), samples.begin(), samples.end());
+
+		return result;
+	}
+
+	void print(const char* name, const Options& options, Result& result)
+	{
+		auto& samples = result.push_ns;
+		std::sort(samples.begin(), samples.end());
+
+		const auto percentile = [&samples](double p) -> uint32_t { return samples.empty() ? 0 : samples[static_cast<size_t>(p * static_cast<double>(samples.size() - 1))]; };
+
+		double total_ns = 0.;
+		for (const auto sample : samples)
+			total_ns += sample;
+
+		const auto pushed = options.producers * options.messages;
+
+		std::printf("%-6s %10zu %10llu %10llu %12.2f %10.1f %8u %8u %10u\n", name, pushed, static_cast<unsigned long long>(result.written), static_cast<unsigned long long>(result.dropped),
+			static_cast<double>(pushed) / result.seconds / 1e6, samples.empty() ? 0. : total_ns / static_cast<double>(samples.size()), percentile(.5), percentile(.99), samples.empty() ? 0 : samples.back());
+	}
+
+	auto parse_count(const char* value, size_t& count) -> bool
+	{
+		char* end = nullptr;
+		const auto parsed = std::strtoull(value, &end, 10);
+
+		if (end == value || *end != '\0' || parsed == 0)
+			return false;
+
+		count = static_cast<size_t>(parsed);
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const auto has_value = i + 1 < argc;
+
+		if (std::strcmp(argv[i], "--producers") == 0 && has_value && parse_count(argv[i + 1], options.producers))
+			i++;
+		else if (std::strcmp(argv[i], "--messages") == 0 && has_value && parse_count(argv[i + 1], options.messages))
+			i++;
+		else if (std::strcmp(argv[i], "--capacity") == 0 && has_value && parse_count(argv[i + 1], options.capacity))
+			i++;
+		else
+		{
+			std::fprintf(stderr, "usage: %s [--producers <count>] [--messages <count per producer>] [--capacity <slots>]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	std::printf("%zu producers, %zu messages each, ring capacity %zu, %u hardware threads\n", options.producers, options.messages, options.capacity, std::thread::hardware_concurrency());
+	std::printf("push times include one steady_clock read\n\n");
+	std::printf("%-6s %10s %10s %10s %12s %10s %8s %8s %10s\n", "queue", "pushed", "written", "dropped", "Mmsg/s", "mean ns", "p50 ns", "p99 ns", "max ns");
+
+	auto ring_result = run<RingQueue>(options);
+	print("ring", options, ring_result);
+
+	auto mutex_result = run<MutexQueue>(options);
+	print("mutex", options, mutex_result);
+
+	// every message is either written or counted as dropped
+	if (ring_result.written + ring_result.dropped != options.producers * options.messages || mutex_result.written != options.producers * options.messages)
+	{
+		std::fprintf(stderr, "message count mismatch\n");
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,374 @@
+// reports the heap memory of encounter log records, the current compact layout against the layout before names were interned
+// builds with any C++20 compiler, e.g.
+// g++ -std=c++20 -O2 -o record_memory_report record_memory_report.cpp ../../log_uploader/string_interner.cpp
+//
+// usage: record_memory_report [--logs <count>] [--encounters <count>] [--uploaded <percent>]
+//
+// every log gets the values a parsed log of a long session holds: its evtc path, encounter and account name, report files, view strings
+// and, for the uploaded ones, a dps.report link. every record is allocated with make_shared like a published row, the bytes are counted
+// by replacing operator new and delete, so they are the requested sizes without the allocator's own overhead.
+// the legacy layout mirrors EncounterLogData before the names were interned: std::string names and view strings, full report paths.
+// paths are counted with the char paths of this platform, windows stores them as UTF-16 and needs twice the bytes for every path
+
+#include "../../log_uploader/encounter_log.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace
+{
+	std::atomic<int64_t> live_bytes = 0;
+	std::atomic<int64_t> live_allocations = 0;
+
+	// keeps the returned memory aligned like malloc
+	constexpr size_t header_size = alignof(std::max_align_t);
+
+	auto allocate(size_t size) -> void*
+	{
+		auto* block = static_cast<unsigned char*>(std::malloc(size + header_size));
+
+		if (block == nullptr)
+			throw std::bad_alloc();
+
+		std::memcpy(block, &size, sizeof(size));
+
+		live_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+		live_allocations.fetch_add(1, std::memory_order_relaxed);
+
+		return block + header_size;
+	}
+
+	void deallocate(void* pointer)
+	{
+		if (pointer == nullptr)
+			return;
+
+		auto* block = static_cast<unsigned char*>(pointer) - header_size;
+
+		size_t size = 0;
+		std::memcpy(&size, block, sizeof(size));
+
+		live_bytes.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+		live_allocations.fetch_sub(1, std::memory_order_relaxed);
+
+		std::free(block);
+	}
+}
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void operator delete(void* pointer) noexcept { deallocate(pointer); }
+void operator delete[](void* pointer) noexcept { deallocate(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { deallocate(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { deallocate(pointer); }
+
+namespace
+{
+	namespace legacy
+	{
+		class EVTCData
+		{
+		public:
+			std::filesystem::path evtc_file_path;
+			std::filesystem::path compressed_file_path;
+			std::chrono::system_clock::time_point time;
+			TriggerID trigger_id = TriggerID::Invalid;
+		};
+
+		class EncounterData
+		{
+		public:
+			std::string encounter_name = "";
+			std::string account_name = "";
+			int duration_ms = 0;
+			bool success = false;
+			bool valid_boss = false;
+			float health_percent_burned = 0.f;
+			EncounterDifficulty difficulty = EncounterDifficulty::NORMAL_MODE;
+			std::chrono::system_clock::time_point start_time{};
+			std::chrono::system_clock::time_point end_time{};
+		};
+
+		class ReportData
+		{
+		public:
+			std::filesystem::path html_file_path;
+			std::filesystem::path json_file_path;
+			std::optional<std::string> error_message;
+		};
+
+		class EncounterLogView
+		{
+		public:
+			bool selected = false;
+			std::string name = "";
+			std::string time = "";
+			std::string result = "";
+			std::string duration = "";
+			TransferProgress dps_report_progress;
+			TransferProgress wingman_progress;
+		};
+
+		class EncounterLogData
+		{
+		public:
+			EncounterLogID id = "";
+			EVTCData evtc_data = EVTCData();
+			ParseStatus parse_status = ParseStatus::UNPARSED;
+			EncounterData encounter_data = EncounterData();
+			ReportData report_data = ReportData();
+			EncounterLogView view = EncounterLogView();
+			DpsReportUpload dps_report_upload = DpsReportUpload();
+			WingmanUpload wingman_upload = WingmanUpload();
+		};
+	}
+
+	constexpr const char* log_directory = "C:\\Users\\Player\\Documents\\Guild Wars 2\\addons\\arcdps\\arcdps.cbtlogs";
+	constexpr const char* report_directory = "C:\\Users\\Player\\Documents\\Guild Wars 2\\addons\\arcdps\\log_uploader\\reports";
+	constexpr const char* account_name = "Player.1234";
+
+	// display names and the report suffix elite insights uses for them
+	constexpr std::pair<const char*, const char*> encounters[] = {
+		{ "Vale Guardian", "vg" }, { "Gorseval the Multifarious", "gors" }, { "Sabetha the Saboteur", "sab" }, { "Slothasor", "sloth" },
+		{ "Bandit Trio", "trio" }, { "Matthias Gabrel", "matt" }, { "Siege the Stronghold", "escort" }, { "Keep Construct", "kc" },
+		{ "Twisted Castle", "tc" }, { "Xera", "xera" }, { "Cairn the Indomitable", "cairn" }, { "Mursaat Overseer", "mo" },
+		{ "Samarog", "sam" }, { "Deimos", "dei" }, { "Soulless Horror", "sh" }, { "River of Souls", "river" },
+		{ "Statue of Ice", "bk" }, { "Statue of Darkness", "eyes" }, { "Dhuum", "dhuum" }, { "Conjured Amalgamate", "ca" },
+		{ "Twin Largos", "twinlargos" }, { "Qadim", "qadim" }, { "Cardinal Adina", "adina" }, { "Cardinal Sabir", "sabir" },
+		{ "Qadim the Peerless", "qpeer" }
+	};
+
+	constexpr size_t encounter_count = sizeof(encounters) / sizeof(encounters[0]);
+
+	class Options
+	{
+	public:
+		size_t logs = 5000;
+		size_t encounters = encounter_count;
+		size_t uploaded = 80; // percent of logs with a dps.report link
+	};
+
+	auto format(const char* pattern, ...) -> std::string
+	{
+		char buffer[256];
+
+		va_list arguments;
+		va_start(arguments, pattern);
+		std::vsnprintf(buffer, sizeof(buffer), pattern, arguments);
+		va_end(arguments);
+
+		return buffer;
+	}
+
+	// the values of one log, shared by both layouts so only the layout differs
+	class Values
+	{
+	public:
+		std::string id;
+		std::string evtc_file_path;
+		std::string encounter_name;
+		std::string report_key;
+		std::string result;
+		std::string duration;
+		std::string time;
+		std::string dps_report_id;
+		std::string dps_report_url;
+		std::string user_token;
+		int duration_ms = 0;
+		bool success = false;
+		bool uploaded = false;
+	};
+
+	auto create_values(const Options& options, size_t index) -> Values
+	{
+		const auto& [encounter_name, suffix] = encounters[index % options.encounters];
+
+		const auto hour = 18 + index / 3600 % 6;
+		const auto minute = index / 60 % 60;
+		const auto second = index % 60;
+		const auto file_stem = format("20260101-%02zu%02zu%02zu", hour, minute, second);
+
+		Values values;
+		values.id = format("%s\\%s.zevtc", encounter_name, file_stem.c_str());
+		values.evtc_file_path = format("%s\\%s", log_directory, values.id.c_str());
+		values.encounter_name = encounter_name;
+		values.success = index % 10 < 7;
+		values.report_key = format("%s_%s_%s", file_stem.c_str(), suffix, values.success ? "kill" : "fail");
+		values.result = values.success ? "Success" : format("%.2f%%", 5. + static_cast<double>(index % 90));
+		values.duration_ms = static_cast<int>(60000 + index * 7919 % 480000);
+		values.duration = format("%dm %ds %dms", values.duration_ms / 60000, values.duration_ms / 1000 % 60, values.duration_ms % 1000);
+		values.time = format("%02zu:%02zu", hour, minute);
+		values.uploaded = index % 100 < options.uploaded;
+
+		if (values.uploaded)
+		{
+			values.dps_report_id = format("%04zx-%s_%s", index * 2654435761u % 65536, file_stem.c_str(), suffix);
+			values.dps_report_url = "https://dps.report/" + values.dps_report_id;
+			values.user_token = format("%016llx%016llx", static_cast<unsigned long long>(index * 0x9e3779b97f4a7c15u), static_cast<unsigned long long>(index * 0xc2b2ae3d27d4eb4fu));
+		}
+
+		return values;
+	}
+
+	auto create_legacy_record(const Values& values) -> std::shared_ptr<const legacy::EncounterLogData>
+	{
+		auto data = std::make_shared<legacy::EncounterLogData>();
+
+		data->id = values.id;
+		data->evtc_data.evtc_file_path = values.evtc_file_path;
+		data->parse_status = ParseStatus::PARSED;
+		data->encounter_data.encounter_name = values.encounter_name;
+		data->encounter_data.account_name = account_name;
+		data->encounter_data.duration_ms = values.duration_ms;
+		data->encounter_data.success = values.success;
+		data->encounter_data.valid_boss = true;
+		data->report_data.html_file_path = std::filesystem::path(report_directory + ("\\" + values.report_key) + ".html");
+		data->report_data.json_file_path = std::filesystem::path(report_directory + ("\\" + values.report_key) + ".json");
+		data->view.name = values.encounter_name;
+		data->view.time = values.time;
+		data->view.result = values.result;
+		data->view.duration = values.duration;
+
+		if (values.uploaded)
+		{
+			data->dps_report_upload.status = DpsReportUploadStatus::UPLOADED;
+			data->dps_report_upload.id = values.dps_report_id;
+			data->dps_report_upload.url = values.dps_report_url;
+			data->dps_report_upload.user_token = values.user_token;
+		}
+
+		return data;
+	}
+
+	auto create_record(const Values& values) -> std::shared_ptr<const EncounterLogData>
+	{
+		auto data = std::make_shared<EncounterLogData>();
+
+		data->id = values.id;
+		data->evtc_data.evtc_file_path = values.evtc_file_path;
+		data->evtc_data.account_name = account_name;
+		data->parse_status = ParseStatus::PARSED;
+		data->encounter_data.encounter_name = values.encounter_name;
+		data->encounter_data.account_name = data->evtc_data.account_name;
+		data->encounter_data.duration_ms = values.duration_ms;
+		data->encounter_data.success = values.success;
+		data->encounter_data.valid_boss = true;
+		data->report_data.report_key = values.report_key;
+		data->view.name = data->encounter_data.encounter_name;
+		data->view.time = values.time;
+		data->view.result = values.result;
+		data->view.duration = values.duration;
+
+		if (values.uploaded)
+		{
+			data->dps_report_upload.status = DpsReportUploadStatus::UPLOADED;
+			data->dps_report_upload.id = values.dps_report_id;
+			data->dps_report_upload.url = values.dps_report_url;
+			data->dps_report_upload.user_token = values.user_token;
+		}
+
+		return data;
+	}
+
+	class Measurement
+	{
+	public:
+		int64_t bytes = 0;
+		int64_t allocations = 0;
+	};
+
+	// heap held by the records once they are built, the row vector itself is reserved up front and not counted
+	template <typename Record, typename Create>
+	auto measure(const std::vector<Values>& values, Create&& create) -> Measurement
+	{
+		std::vector<Record> records;
+		records.reserve(values.size());
+
+		const auto bytes = live_bytes.load();
+		const auto allocations = live_allocations.load();
+
+		for (const auto& value : values)
+			records.push_back(create(value));
+
+		return { live_bytes.load() - bytes, live_allocations.load() - allocations };
+	}
+
+	void print(const char* name, size_t record_size, const Measurement& measurement, size_t logs)
+	{
+		std::printf("%-8s %12zu %14lld %14lld %14.1f %14.1f\n", name, record_size, static_cast<long long>(measurement.bytes), static_cast<long long>(measurement.allocations),
+			static_cast<double>(measurement.bytes) / static_cast<double>(logs), static_cast<double>(measurement.allocations) / static_cast<double>(logs));
+	}
+
+	auto parse_count(const char* value, size_t& count) -> bool
+	{
+		char* end = nullptr;
+		const auto parsed = std::strtoull(value, &end, 10);
+
+		if (end == value || *end != '\0' || parsed == 0)
+			return false;
+
+		count = static_cast<size_t>(parsed);
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const auto has_value = i + 1 < argc;
+
+		if (std::strcmp(argv[i], "--logs") == 0 && has_value && parse_count(argv[i + 1], options.logs))
+			i++;
+		else if (std::strcmp(argv[i], "--encounters") == 0 && has_value && parse_count(argv[i + 1], options.encounters) && options.encounters <= encounter_count)
+			i++;
+		else if (std::strcmp(argv[i], "--uploaded") == 0 && has_value && (std::strcmp(argv[i + 1], "0") == 0 ? (options.uploaded = 0, true) : parse_count(argv[i + 1], options.uploaded)) && options.uploaded <= 100)
+			i++;
+		else
+		{
+			std::fprintf(stderr, "usage: %s [--logs <count>] [--encounters <count, at most %zu>] [--uploaded <percent>]\n", argv[0], encounter_count);
+			return 1;
+		}
+	}
+
+	std::vector<Values> values;
+	values.reserve(options.logs);
+
+	for (size_t i = 0; i < options.logs; i++)
+		values.push_back(create_values(options, i));
+
+	// the legacy layout runs first, the interner is still empty
+	const auto legacy_measurement = measure<std::shared_ptr<const legacy::EncounterLogData>>(values, create_legacy_record);
+	const auto measurement = measure<std::shared_ptr<const EncounterLogData>>(values, create_record);
+
+	std::printf("%zu logs of %zu encounters, %zu%% uploaded to dps.report\n", options.logs, options.encounters, options.uploaded);
+	std::printf("bytes are requested heap sizes including the record and its shared_ptr control block, the live log holds the same layout once more\n\n");
+	std::printf("%-8s %12s %14s %14s %14s %14s\n", "layout", "sizeof", "heap bytes", "allocations", "bytes/log", "allocs/log");
+
+	print("legacy", sizeof(legacy::EncounterLogData), legacy_measurement, options.logs);
+	print("current", sizeof(EncounterLogData), measurement, options.logs);
+
+	std::printf("\ninterner: %zu strings, %zu bytes by its own estimate, included in the current heap bytes\n", global::string_interner->get_count(), global::string_interner->get_memory_usage());
+
+	if (legacy_measurement.bytes <= 0 || measurement.bytes <= 0)
+	{
+		std::fprintf(stderr, "no allocations counted\n");
+		return 1;
+	}
+
+	std::printf("saved: %lld bytes, %.1f%%\n", static_cast<long long>(legacy_measurement.bytes - measurement.bytes),
+		100. * static_cast<double>(legacy_measurement.bytes - measurement.bytes) / static_cast<double>(legacy_measurement.bytes));
+
+	return 0;
+}
@@ -0,0 +1,134 @@
+// decodes the trace.bin written by the log uploader's "Record pipeline trace" option into text or csv
+// builds with any C++20 compiler, e.g. g++ -std=c++20 -O2 -o trace_decoder trace_decoder.cpp
+//
+// usage: trace_decoder [--csv] [--id <encounter log id>] trace.bin
+
+#include "../../log_uploader/trace_format.h"
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	auto format_time(const TraceFileHeader& header, int64_t time_ns) -> std::string
+	{
+		const auto system_time_ns = header.system_time_ns + (time_ns - header.steady_time_ns);
+		const auto seconds = static_cast<std::time_t>(system_time_ns / 1000000000);
+		const auto milliseconds = static_cast<int>((system_time_ns / 1000000) % 1000);
+
+		std::tm time = {};
+		gmtime_r(&seconds, &time);
+
+		char buffer[32];
+		const auto length = std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &time);
+		std::snprintf(buffer + length, sizeof(buffer) - length, ".%03d", milliseconds);
+
+		return buffer;
+	}
+
+	auto read_trace(const char* file_path, TraceFileHeader& header, std::vector<TraceRecord>& records) -> bool
+	{
+		std::ifstream file(file_path, std::ifstream::binary);
+
+		if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+		{
+			std::fprintf(stderr, "%s: not a trace file\n", file_path);
+			return false;
+		}
+
+		if (header.magic != trace_magic || header.version != trace_format_version || header.record_size != sizeof(TraceRecord))
+		{
+			std::fprintf(stderr, "%s: unsupported trace version %u\n", file_path, header.version);
+			return false;
+		}
+
+		TraceRecord record;
+
+		// a trace cut off while being written ends with a partial record, it is ignored
+		while (file.read(reinterpret_cast<char*>(&record), sizeof(record)))
+			records.push_back(record);
+
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	auto csv = false;
+	uint64_t filter_hash = 0;
+	const char* file_path = nullptr;
+
+	for (auto i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--csv") == 0)
+			csv = true;
+		else if (std::strcmp(argv[i], "--id") == 0 && i + 1 < argc)
+			filter_hash = hash_trace_id(std::string(argv[++i]));
+		else
+			file_path = argv[i];
+	}
+
+	if (!file_path)
+	{
+		std::fprintf(stderr, "usage: %s [--csv] [--id <encounter log id>] trace.bin\n", argv[0]);
+		return 2;
+	}
+
+	TraceFileHeader header;
+	std::vector<TraceRecord> records;
+
+	if (!read_trace(file_path, header, records))
+		return 1;
+
+	// detection events are keyed by the file path until the log is registered, they are shown under the log id
+	std::unordered_map<uint64_t, uint64_t> log_ids;
+
+	for (const auto& record : records)
+		if (static_cast<TraceEvent>(record.event) == TraceEvent::LOG_REGISTERED)
+			log_ids[static_cast<uint64_t>(record.payload[0])] = record.log_id_hash;
+
+	// the writer thread takes records in the order they were queued, threads can still overlap a little
+	std::unordered_map<uint64_t, int64_t> first_times;
+	const auto start_time = records.empty() ? 0 : records.front().time_ns;
+
+	if (csv)
+		std::printf("time_utc,elapsed_ms,log,log_elapsed_ms,thread,source,event,payload_0,payload_1,payload_2,payload_names\n");
+
+	for (const auto& record : records)
+	{
+		const auto event = static_cast<TraceEvent>(record.event);
+		const auto it = log_ids.find(record.log_id_hash);
+		const auto log = it != log_ids.end() ? it->second : record.log_id_hash;
+
+		if (filter_hash != 0 && log != filter_hash)
+			continue;
+
+		const auto first_time = log != 0 ? first_times.try_emplace(log, record.time_ns).first->second : record.time_ns;
+		const auto elapsed_ms = (record.time_ns - start_time) / 1e6;
+		const auto log_elapsed_ms = (record.time_ns - first_time) / 1e6;
+		const auto source = get_log_source_name(static_cast<LogSource>(record.source));
+		const auto names = get_trace_payload_names(event);
+
+		if (csv)
+		{
+			std::printf("%s,%.3f,%016llx,%.3f,%08x,%s,%s,%lld,%lld,%lld,%s;%s;%s\n", format_time(header, record.time_ns).c_str(), elapsed_ms, static_cast<unsigned long long>(log), log_elapsed_ms, record.thread_id, source, get_trace_event_name(event),
+				static_cast<long long>(record.payload[0]), static_cast<long long>(record.payload[1]), static_cast<long long>(record.payload[2]), names[0], names[1], names[2]);
+			continue;
+		}
+
+		std::printf("%s %+12.3fms [%s] %-16s log=%016llx +%.3fms thread=%08x", format_time(header, record.time_ns).c_str(), elapsed_ms, source, get_trace_event_name(event), static_cast<unsigned long long>(log), log_elapsed_ms, record.thread_id);
+
+		for (size_t i = 0; i < names.size(); i++)
+			if (names[i][0] != '\0')
+				std::printf(" %s=%lld", names[i], static_cast<long long>(record.payload[i]));
+
+		std::printf("\n");
+	}
+
+	return 0;
+}
@@ -0,0 +1,414 @@
+// measures the resident memory of sending a Wingman upload body, buffered in memory, read from the files and mapped like MultipartStream
+// linux only, reads RssAnon and RssFile from /proc/self/status, e.g. g++ -std=c++20 -O2 -o upload_memory_benchmark upload_memory_benchmark.cpp
+//
+// usage: upload_memory_benchmark [--size <MiB>] [--chunk <KiB>] [--path <directory>]
+//
+// the body mimics a Wingman upload, the evtc file takes a tenth of the size, the json report two fifths and the html report the rest.
+// every mode runs in its own child process and hands the body to a curl sized buffer piece by piece:
+//   buffered - the whole body is built in one string first, how a body passed to curl as a single buffer is held
+//   read     - every part is read from its file into the buffer, how curl sends cpr::File parts
+//   mapped   - every file is mapped for the lifetime of the body and copied into the buffer, how MultipartStream sends them
+// mapped pages are clean and backed by the file, they count as RssFile and the system drops them under pressure instead of paging them out
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	class Options
+	{
+	public:
+		size_t size = 50; // MiB
+		size_t chunk = 64; // KiB, the upload buffer curl reads into
+		std::filesystem::path path;
+	};
+
+	class Part
+	{
+	public:
+		const char* name = "";
+		std::filesystem::path file_path;
+		size_t size = 0;
+	};
+
+	class Usage
+	{
+	public:
+		int64_t anon_kib = 0;
+		int64_t file_kib = 0;
+	};
+
+	// written by the child into the pipe, peaks are relative to the start of the mode
+	class Result
+	{
+	public:
+		int64_t anon_peak_kib = 0;
+		int64_t file_peak_kib = 0;
+		uint64_t bytes_sent = 0;
+		uint64_t checksum = 0;
+		bool failed = false;
+	};
+
+	auto read_usage() -> Usage
+	{
+		Usage usage;
+
+		auto* status = std::fopen("/proc/self/status", "r");
+
+		if (status == nullptr)
+			return usage;
+
+		char line[256];
+
+		while (std::fgets(line, sizeof(line), status) != nullptr)
+		{
+			if (std::strncmp(line, "RssAnon:", 8) == 0)
+				usage.anon_kib = std::strtoll(line + 8, nullptr, 10);
+			else if (std::strncmp(line, "RssFile:", 8) == 0)
+				usage.file_kib = std::strtoll(line + 8, nullptr, 10);
+		}
+
+		std::fclose(status);
+		return usage;
+	}
+
+	// stands in for curl sending the buffer, every byte is read so no copy can be left out
+	class Sink
+	{
+	public:
+		Sink(Result& result, size_t chunk_size) : result(result), buffer(chunk_size), start(read_usage()) {}
+
+		auto get_buffer() -> char* { return this->buffer.data(); }
+		auto get_buffer_size() const -> size_t { return this->buffer.size(); }
+
+		void send(size_t size)
+		{
+			for (size_t i = 0; i < size; i++)
+				this->result.checksum = this->result.checksum * 31 + static_cast<uint8_t>(this->buffer[i]);
+
+			this->result.bytes_sent += size;
+			this->sample();
+		}
+
+		void sample()
+		{
+			const auto usage = read_usage();
+
+			this->result.anon_peak_kib = (std::max)(this->result.anon_peak_kib, usage.anon_kib - this->start.anon_kib);
+			this->result.file_peak_kib = (std::max)(this->result.file_peak_kib, usage.file_kib - this->start.file_kib);
+		}
+
+	private:
+		Result& result;
+		std::vector<char> buffer;
+		Usage start;
+	};
+
+	auto get_part_header(const Part& part) -> std::string
+	{
+		return std::string("--LogUploaderBoundary\r\nContent-Disposition: form-data; name=\"") + part.name + "\"; filename=\"" + part.file_path.filename().string() +
+			"\"\r\nContent-Type: application/octet-stream\r\n\r\n";
+	}
+
+	constexpr const char* part_trailer = "\r\n";
+	constexpr const char* body_trailer = "--LogUploaderBoundary--\r\n";
+
+	// copies a piece of memory into the sink buffer by buffer
+	void send_memory(Sink& sink, const char* data, size_t size)
+	{
+		for (size_t offset = 0; offset < size;)
+		{
+			const auto count = (std::min)(sink.get_buffer_size(), size - offset);
+			std::memcpy(sink.get_buffer(), data + offset, count);
+			sink.send(count);
+			offset += count;
+		}
+	}
+
+	auto run_buffered(const std::vector<Part>& parts, size_t chunk_size) -> Result
+	{
+		Result result;
+		Sink sink(result, chunk_size);
+
+		std::string body;
+
+		for (const auto& part : parts)
+		{
+			body += get_part_header(part);
+
+			const auto offset = body.size();
+			body.resize(offset + part.size);
+
+			auto* file = std::fopen(part.file_path.c_str(), "rb");
+
+			if (file == nullptr || std::fread(body.data() + offset, 1, part.size, file) != part.size)
+				result.failed = true;
+
+			if (file != nullptr)
+				std::fclose(file);
+
+			body += part_trailer;
+			sink.sample();
+		}
+
+		body += body_trailer;
+
+		send_memory(sink, body.data(), body.size());
+		return result;
+	}
+
+	auto run_read(const std::vector<Part>& parts, size_t chunk_size) -> Result
+	{
+		Result result;
+		Sink sink(result, chunk_size);
+
+		for (const auto& part : parts)
+		{
+			const auto header = get_part_header(part);
+			send_memory(sink, header.data(), header.size());
+
+			auto* file = std::fopen(part.file_path.c_str(), "rb");
+
+			if (file == nullptr)
+			{
+				result.failed = true;
+				return result;
+			}
+
+			while (const auto count = std::fread(sink.get_buffer(), 1, sink.get_buffer_size(), file))
+				sink.send(count);
+
+			std::fclose(file);
+
+			send_memory(sink, part_trailer, std::strlen(part_trailer));
+		}
+
+		send_memory(sink, body_trailer, std::strlen(body_trailer));
+		return result;
+	}
+
+	auto run_mapped(const std::vector<Part>& parts, size_t chunk_size) -> Result
+	{
+		Result result;
+		Sink sink(result, chunk_size);
+
+		// the stream maps every file when it is added and keeps the views until the upload is done
+		std::vector<const char*> views;
+
+		for (const auto& part : parts)
+		{
+			const auto descriptor = open(part.file_path.c_str(), O_RDONLY);
+			void* view = MAP_FAILED;
+
+			if (descriptor >= 0)
+			{
+				view = mmap(nullptr, part.size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+				close(descriptor);
+			}
+
+			if (view == MAP_FAILED)
+			{
+				result.failed = true;
+				break;
+			}
+
+			views.push_back(static_cast<const char*>(view));
+		}
+
+		if (!result.failed)
+		{
+			for (size_t i = 0; i < parts.size(); i++)
+			{
+				const auto header = get_part_header(parts[i]);
+				send_memory(sink, header.data(), header.size());
+				send_memory(sink, views[i], parts[i].size);
+				send_memory(sink, part_trailer, std::strlen(part_trailer));
+			}
+
+			send_memory(sink, body_trailer, std::strlen(body_trailer));
+		}
+
+		for (size_t i = 0; i < views.size(); i++)
+			munmap(const_cast<char*>(views[i]), parts[i].size);
+
+		return result;
+	}
+
+	// every mode starts from a fresh process so the peaks of one do not hide those of the next
+	template <typename Run>
+	auto run_in_child(Run&& run) -> Result
+	{
+		Result result;
+		result.failed = true;
+
+		int pipe_descriptors[2];
+
+		if (pipe(pipe_descriptors) != 0)
+			return result;
+
+		const auto pid = fork();
+
+		if (pid == 0)
+		{
+			close(pipe_descriptors[0]);
+
+			const auto child_result = run();
+			const auto written = write(pipe_descriptors[1], &child_result, sizeof(child_result));
+
+			_exit(written == sizeof(child_result) ? 0 : 1);
+		}
+
+		close(pipe_descriptors[1]);
+
+		if (pid > 0)
+		{
+			if (read(pipe_descriptors[0], &result, sizeof(result)) != sizeof(result))
+				result.failed = true;
+
+			int status = 0;
+			waitpid(pid, &status, 0);
+		}
+
+		close(pipe_descriptors[0]);
+		return result;
+	}
+
+	auto write_part(const std::filesystem::path& file_path, size_t size, std::mt19937_64& generator) -> bool
+	{
+		std::ofstream file(file_path, std::ios::binary);
+		std::vector<uint64_t> block(8192);
+
+		for (size_t written = 0; written < size;)
+		{
+			for (auto& value : block)
+				value = generator();
+
+			const auto count = (std::min)(block.size() * sizeof(uint64_t), size - written);
+			file.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(count));
+			written += count;
+		}
+
+		return static_cast<bool>(file);
+	}
+
+	void print(const char* name, const Result& result, uint64_t body_size)
+	{
+		std::printf("%-9s %12llu %14lld %14lld %14lld\n", name, static_cast<unsigned long long>(result.bytes_sent), static_cast<long long>(result.anon_peak_kib),
+			static_cast<long long>(result.file_peak_kib), static_cast<long long>(result.anon_peak_kib + result.file_peak_kib));
+
+		if (result.bytes_sent != body_size)
+			std::fprintf(stderr, "%s sent %llu of %llu bytes\n", name, static_cast<unsigned long long>(result.bytes_sent), static_cast<unsigned long long>(body_size));
+	}
+
+	auto parse_count(const char* value, size_t& count) -> bool
+	{
+		char* end = nullptr;
+		const auto parsed = std::strtoull(value, &end, 10);
+
+		if (end == value || *end != '\0' || parsed == 0)
+			return false;
+
+		count = static_cast<size_t>(parsed);
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const auto has_value = i + 1 < argc;
+
+		if (std::strcmp(argv[i], "--size") == 0 && has_value && parse_count(argv[i + 1], options.size))
+			i++;
+		else if (std::strcmp(argv[i], "--chunk") == 0 && has_value && parse_count(argv[i + 1], options.chunk))
+			i++;
+		else if (std::strcmp(argv[i], "--path") == 0 && has_value)
+			options.path = argv[++i];
+		else
+		{
+			std::fprintf(stderr, "usage: %s [--size <MiB>] [--chunk <KiB>] [--path <directory>]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	const auto root = (options.path.empty() ? std::filesystem::temp_directory_path() : options.path) / ("upload_memory_benchmark_" + std::to_string(getpid()));
+
+	std::error_code error;
+	std::filesystem::create_directories(root, error);
+
+	if (error)
+	{
+		std::fprintf(stderr, "failed to create %s: %s\n", root.c_str(), error.message().c_str());
+		return 1;
+	}
+
+	const auto total_size = options.size * 1024 * 1024;
+	const auto evtc_size = total_size / 10;
+	const auto json_size = total_size * 2 / 5;
+
+	const std::vector<Part> parts = {
+		{ "file", root / "20260101-120000.zevtc", evtc_size },
+		{ "jsonfile", root / "20260101-120000_boss_kill.json", json_size },
+		{ "htmlfile", root / "20260101-120000_boss_kill.html", total_size - evtc_size - json_size }
+	};
+
+	std::mt19937_64 generator(42);
+	uint64_t body_size = std::strlen(body_trailer);
+
+	for (const auto& part : parts)
+	{
+		if (!write_part(part.file_path, part.size, generator))
+		{
+			std::fprintf(stderr, "failed to write %s\n", part.file_path.c_str());
+			std::filesystem::remove_all(root, error);
+			return 1;
+		}
+
+		body_size += get_part_header(part).size() + part.size + std::strlen(part_trailer);
+	}
+
+	const auto chunk_size = options.chunk * 1024;
+
+	std::printf("%zu MiB body in 3 parts, %zu KiB upload buffer\n", options.size, options.chunk);
+	std::printf("peaks are relative to the start of each mode, the files stay in the page cache in every mode\n\n");
+	std::printf("%-9s %12s %14s %14s %14s\n", "mode", "bytes sent", "RssAnon KiB", "RssFile KiB", "total KiB");
+
+	const auto buffered_result = run_in_child([&] { return run_buffered(parts, chunk_size); });
+	print("buffered", buffered_result, body_size);
+
+	const auto read_result = run_in_child([&] { return run_read(parts, chunk_size); });
+	print("read", read_result, body_size);
+
+	const auto mapped_result = run_in_child([&] { return run_mapped(parts, chunk_size); });
+	print("mapped", mapped_result, body_size);
+
+	std::filesystem::remove_all(root, error);
+
+	// every mode sends the same body
+	const auto valid = [&](const Result& result) { return !result.failed && result.bytes_sent == body_size && result.checksum == buffered_result.checksum; };
+
+	if (!valid(buffered_result) || !valid(read_result) || !valid(mapped_result))
+	{
+		std::fprintf(stderr, "body mismatch\n");
+		return 1;
+	}
+
+	return 0;
+}